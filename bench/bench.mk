@@ -0,0 +1,62 @@
+# SPI cost benchmark, runs the public API against the emulator and fails when
+# a call goes over its budget.
+#
+#   make bench
+#   make bench BENCH_BUDGET=my_budget.txt BENCH_CPPFLAGS=-DNRF24_ENABLE_REG_CACHE
+
+BENCH_CC ?= $(CC)
+BENCH_CFLAGS ?= -std=gnu99 -O2 -Wall -Wextra
+BENCH_CPPFLAGS ?=
+BENCH_BUDGET ?= bench/spi_budget.txt
+BENCH_BUILD_DIR ?= bench/build
+
+BENCH_SRC = $(SRC_FILES) tests/emulator/nrf24_emu.c bench/spi_cost.c
+BENCH_BIN = $(BENCH_BUILD_DIR)/spi_cost
+
+.PHONY: bench bench_clean
+
+bench: $(BENCH_BIN)
+	$(BENCH_BIN) $(BENCH_BUDGET)
+
+$(BENCH_BIN): $(BENCH_SRC) $(wildcard inc/*.h) tests/emulator/nrf24_emu.h
+	@mkdir -p $(BENCH_BUILD_DIR)
+	$(BENCH_CC) $(BENCH_CFLAGS) $(BENCH_CPPFLAGS) -Iinc -Itests/emulator $(BENCH_SRC) -o $@
+
+bench_clean:
+	rm -rf $(BENCH_BUILD_DIR)
+
+# C function pointer path against the header only C++ template, time per
+# transmit and code size (text of two programs linked with --gc-sections,
+# each one running a single path).
+#
+#   make bench_radio
+
+BENCH_CXX ?= $(CXX)
+BENCH_CXXFLAGS ?= -std=c++11 -O2 -Wall -Wextra
+BENCH_SIZE ?= size
+BENCH_SECTIONS = -ffunction-sections -fdata-sections
+
+BENCH_RADIO_OBJ = $(patsubst %.c,$(BENCH_BUILD_DIR)/%.o,$(SRC_FILES))
+BENCH_RADIO_BIN = $(BENCH_BUILD_DIR)/radio_cost
+BENCH_RADIO_SIZE_BIN = $(BENCH_BUILD_DIR)/radio_size_c $(BENCH_BUILD_DIR)/radio_size_template
+
+.PHONY: bench_radio
+
+bench_radio: $(BENCH_RADIO_BIN) $(BENCH_RADIO_SIZE_BIN)
+	$(BENCH_RADIO_BIN)
+	$(BENCH_SIZE) $(BENCH_RADIO_SIZE_BIN)
+
+$(BENCH_BUILD_DIR)/src/%.o: src/%.c $(wildcard inc/*.h)
+	@mkdir -p $(dir $@)
+	$(BENCH_CC) $(BENCH_CFLAGS) $(BENCH_CPPFLAGS) $(BENCH_SECTIONS) -Iinc -c $< -o $@
+
+$(BENCH_RADIO_BIN): bench/radio_cost.cpp $(BENCH_RADIO_OBJ) $(wildcard inc/*.h) inc/NRF24.hpp
+	$(BENCH_CXX) $(BENCH_CXXFLAGS) $(BENCH_CPPFLAGS) -Iinc $< $(BENCH_RADIO_OBJ) -o $@
+
+$(BENCH_BUILD_DIR)/radio_size_c: bench/radio_cost.cpp $(BENCH_RADIO_OBJ) $(wildcard inc/*.h) inc/NRF24.hpp
+	$(BENCH_CXX) $(BENCH_CXXFLAGS) $(BENCH_CPPFLAGS) $(BENCH_SECTIONS) -DRADIO_COST_SIZE=1 -Iinc \
+		$< $(BENCH_RADIO_OBJ) -Wl,--gc-sections -o $@
+
+$(BENCH_BUILD_DIR)/radio_size_template: bench/radio_cost.cpp $(BENCH_RADIO_OBJ) $(wildcard inc/*.h) inc/NRF24.hpp
+	$(BENCH_CXX) $(BENCH_CXXFLAGS) $(BENCH_CPPFLAGS) $(BENCH_SECTIONS) -DRADIO_COST_SIZE=2 -Iinc \
+		$< $(BENCH_RADIO_OBJ) -Wl,--gc-sections -o $@
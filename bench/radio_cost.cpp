@@ -0,0 +1,157 @@
+/**
+* @file     radio_cost.cpp
+* @version  0.1
+*
+* @brief    Cost of NRF24_transmit against nrf24::Radio::transmit.
+*
+* Both paths drive the same trivial hardware (the SPI bytes are folded into
+* a volatile, the CE writes and delays are stored), so the time measured is
+* the time spent in the library. The time per call of each path is printed.
+*
+* Built with RADIO_COST_SIZE set to 1 (C) or 2 (template) the program only
+* runs one of the paths, the text size of the two binaries linked with
+* --gc-sections gives the code size of each path.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+extern "C" {
+#include "NRF24.h"
+}
+
+#include "NRF24.hpp"
+
+#ifndef RADIO_COST_SIZE
+#define RADIO_COST_SIZE	0
+#endif
+
+enum {
+	RADIO_COST_CALLS	= 1000000,
+	RADIO_COST_PAYLOAD_SIZE	= 8,
+};
+
+static volatile uint8_t spi_sink;
+static volatile uint32_t hw_sink;
+
+static void sink_spi_xfer(const uint8_t *in, uint8_t *out, const size_t xfer_size)
+{
+	for (size_t idx = 0; idx < xfer_size; idx++) {
+		spi_sink = (uint8_t) (spi_sink ^ in[idx]);
+		out[idx] = 0x0E;
+	}
+}
+
+static void sink_write_ce(nrf_gpio state)
+{
+	hw_sink = state;
+}
+
+static void sink_delay_ms(uint32_t ms)
+{
+	hw_sink = ms;
+}
+
+static void sink_delay_us(uint32_t us)
+{
+	hw_sink = us;
+}
+
+struct SinkSpi {
+	static void xfer(const uint8_t *in, uint8_t *out, size_t xfer_size)
+	{
+		sink_spi_xfer(in, out, xfer_size);
+	}
+};
+
+struct SinkCe {
+	static void write(nrf_gpio state)
+	{
+		sink_write_ce(state);
+	}
+};
+
+struct SinkDelay {
+	static void ms(uint32_t ms)
+	{
+		sink_delay_ms(ms);
+	}
+
+	static void us(uint32_t us)
+	{
+		sink_delay_us(us);
+	}
+};
+
+typedef nrf24::Radio<SinkSpi, SinkCe, nrf24::NoIrq, SinkDelay> SinkRadio;
+
+static uint8_t payload[RADIO_COST_PAYLOAD_SIZE];
+
+/* Not inlined so both paths are called the same way */
+#if 2 != RADIO_COST_SIZE
+static nrf_radio c_radio;
+
+__attribute__((noinline)) static void transmit_c(void)
+{
+	NRF24_transmit(&c_radio, payload, sizeof payload);
+}
+#endif
+
+#if 1 != RADIO_COST_SIZE
+__attribute__((noinline)) static void transmit_template(void)
+{
+	SinkRadio radio;
+
+	radio.transmit(payload, sizeof payload);
+}
+#endif
+
+#if 0 == RADIO_COST_SIZE
+static double ns_per_call(void (*transmit)(void))
+{
+	struct timespec start;
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (unsigned long idx = 0; idx < RADIO_COST_CALLS; idx++) {
+		transmit();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return ((double) (end.tv_sec - start.tv_sec) * 1e9 +
+		(double) (end.tv_nsec - start.tv_nsec)) / RADIO_COST_CALLS;
+}
+#endif
+
+int main(void)
+{
+#if 2 != RADIO_COST_SIZE
+	NRF24_init(&c_radio, sink_spi_xfer, sink_write_ce, NULL, sink_delay_ms, sink_delay_us);
+#endif
+
+#if 1 == RADIO_COST_SIZE
+	for (unsigned long idx = 0; idx < RADIO_COST_CALLS; idx++) {
+		transmit_c();
+	}
+#elif 2 == RADIO_COST_SIZE
+	for (unsigned long idx = 0; idx < RADIO_COST_CALLS; idx++) {
+		transmit_template();
+	}
+#else
+	/* Warm up */
+	ns_per_call(transmit_c);
+	ns_per_call(transmit_template);
+
+	const double c_ns = ns_per_call(transmit_c);
+	const double template_ns = ns_per_call(transmit_template);
+
+	printf("%-28s %10s\n", "transmit (8 bytes)", "ns/call");
+	printf("%-28s %10.1f\n", "NRF24_transmit", c_ns);
+	printf("%-28s %10.1f\n", "nrf24::Radio::transmit", template_ns);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,453 @@
+/**
+* @file     spi_cost.c
+* @version  0.1
+*
+* @brief    SPI cost of the public API.
+*
+* Every public function of NRF24.h, NRF24_config_apply and NRF24_scan_sweep
+* are run against the emulator (see tests/emulator), the SPI transactions,
+* bytes clocked, CE toggles and delay time requested by each call are
+* printed. When a budget file is given the program fails if any call exceeds
+* its budget.
+*
+* Budget file format, one function per line, '#' starts a comment:
+*
+* @code
+* # name                      transactions  bytes
+* NRF24_set_channel           3             4
+* @endcode
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "NRF24.h"
+#include "NRF24_INTERFACE.h"
+#include "NRF24_RING.h"
+#include "NRF24_CONFIG.h"
+#include "NRF24_SCAN.h"
+
+#include "nrf24_emu.h"
+
+typedef struct {
+	const char	*name;
+	/* Bring the radio to the state needed by run, not measured */
+	void		(*prepare)(void);
+	void		(*run)(void);
+} bench_case;
+
+typedef struct {
+	char		name[64];
+	unsigned long	transactions;
+	unsigned long	bytes;
+} bench_budget;
+
+enum {
+	BENCH_BUDGET_MAX	= 128,
+	BENCH_STREAM_COUNT	= 6,
+};
+
+static nrf_emu emu;
+static nrf_radio radio;
+
+static uint8_t payload[NRF_PAYLOAD_SIZE_MAX] = {
+	0xCA, 0xFE, 0xBE, 0xEF,
+};
+static uint8_t addr[NRF_PIPE_ADDR_WIDTH_5BYTES] = {
+	0xE7, 0xE7, 0xE7, 0xE7, 0xE7,
+};
+static nrf_packet packets[NRF_EMU_FIFO_DEPTH];
+static nrf_packet tx_slots[4];
+static nrf_ring tx_ring;
+static nrf_config config;
+static nrf_config next_config;
+static nrf_scan scan;
+
+static void handler(nrf_radio *r, uint8_t status, void *context)
+{
+	(void) r;
+	(void) status;
+	(void) context;
+}
+
+/* Preparations */
+
+static void prepare_none(void)
+{
+}
+
+static void prepare_ptx(void)
+{
+	const uint8_t config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP;
+	NRF24_write_reg(&radio, NRF_REG_CONFIG, &config, 1);
+}
+
+static void prepare_prx(void)
+{
+	const uint8_t config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER;
+	NRF24_write_reg(&radio, NRF_REG_CONFIG, &config, 1);
+	NRF24_set_payload_size(&radio, NRF_PLD_SIZE_PIPE0, 4);
+}
+
+static void prepare_rx_packet(void)
+{
+	prepare_prx();
+	nrf_emu_inject_rx(&emu, NRF_PIPE0, payload, 4);
+}
+
+static void prepare_rx_fifo_full(void)
+{
+	prepare_prx();
+	for (size_t idx = 0; idx < NRF_EMU_FIFO_DEPTH; idx++) {
+		nrf_emu_inject_rx(&emu, NRF_PIPE0, payload, 4);
+	}
+}
+
+static void prepare_tx_ring(void)
+{
+	prepare_ptx();
+	NRF24_ring_init(&tx_ring, tx_slots, NRF_ARRAY_SIZE(tx_slots));
+	NRF24_set_rings(&radio, NULL, &tx_ring);
+
+	nrf_packet packet = {NRF_PIPE0, 4, {0}};
+	NRF24_ring_push(&tx_ring, &packet);
+	NRF24_ring_push(&tx_ring, &packet);
+}
+
+static void prepare_time(void)
+{
+	NRF24_set_time_us_cb(&radio, nrf_emu_time_us);
+}
+
+static void prepare_status_kept(void)
+{
+	prepare_time();
+	NRF24_set_status_max_age(&radio, 1000);
+	NRF24_get_fifo_status(&radio);
+}
+
+static void prepare_prx_timed(void)
+{
+	prepare_prx();
+	prepare_time();
+}
+
+static void prepare_ptx_timed(void)
+{
+	prepare_ptx();
+	prepare_time();
+}
+
+static void prepare_config(void)
+{
+	NRF24_config_defaults(&config);
+	config.config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP;
+	config.rf_ch = 76;
+	config.rx_pw[NRF_PIPE0] = 4;
+
+	next_config = config;
+	next_config.rf_ch = 40;
+}
+
+/* Calls */
+
+#define BENCH_RUN(fn, ...)	static void run_##fn(void) { fn(&radio, ##__VA_ARGS__); }
+
+static void run_NRF24_init(void)
+{
+	NRF24_init(&radio, nrf_emu_spi_xfer, nrf_emu_write_ce, nrf_emu_read_irq,
+		nrf_emu_delay_ms, nrf_emu_delay_us);
+}
+
+BENCH_RUN(NRF24_set_spi_xfer_vec_cb, nrf_emu_spi_xfer_vec)
+BENCH_RUN(NRF24_set_spi_xfer_sg_cb, nrf_emu_spi_xfer_sg)
+BENCH_RUN(NRF24_set_time_us_cb, nrf_emu_time_us)
+BENCH_RUN(NRF24_set_status_max_age, 1000)
+BENCH_RUN(NRF24_set_power_state, NRF_STATE_RX)
+BENCH_RUN(NRF24_get_power_state)
+BENCH_RUN(NRF24_service, nrf_emu_time_us())
+BENCH_RUN(NRF24_service_deadline)
+BENCH_RUN(NRF24_sleep)
+BENCH_RUN(NRF24_wakeup)
+BENCH_RUN(NRF24_wakeup_begin)
+BENCH_RUN(NRF24_set_mode, NRF_MODE_RX)
+BENCH_RUN(NRF24_get_mode)
+BENCH_RUN(NRF24_set_power_down_mode)
+BENCH_RUN(NRF24_set_standby_i_mode)
+BENCH_RUN(NRF24_set_standby_ii_mode)
+BENCH_RUN(NRF24_set_rx_mode)
+BENCH_RUN(NRF24_set_tx_mode)
+BENCH_RUN(NRF24_enable_auto_ack, NRF_PIPE1)
+BENCH_RUN(NRF24_disable_auto_ack, NRF_PIPE1)
+BENCH_RUN(NRF24_set_channel, 76)
+BENCH_RUN(NRF24_change_channel, 76)
+BENCH_RUN(NRF24_get_channel)
+BENCH_RUN(NRF24_set_address_width, NRF_SETUP_AW_5BYTES)
+BENCH_RUN(NRF24_get_address_width)
+BENCH_RUN(NRF24_set_auto_retransmit, NRF_AUTO_RETRANSMIT_DELAY_500_US, NRF_AUTO_RETRANSMIT_CNT_15)
+BENCH_RUN(NRF24_get_auto_retransmit_delay)
+BENCH_RUN(NRF24_get_auto_retransmit_count)
+BENCH_RUN(NRF24_set_data_rate, NRF_RF_SETUP_RF_DR_250)
+BENCH_RUN(NRF24_get_data_rate)
+BENCH_RUN(NRF24_set_pa_level, NRF_RF_SETUP_RF_PWR_18)
+BENCH_RUN(NRF24_get_pa_level)
+BENCH_RUN(NRF24_set_tx_address, addr, sizeof addr)
+BENCH_RUN(NRF24_get_tx_address, addr, sizeof addr)
+BENCH_RUN(NRF24_set_payload_size, NRF_PLD_SIZE_PIPE0, 4)
+BENCH_RUN(NRF24_get_payload_size, NRF_PLD_SIZE_PIPE0)
+BENCH_RUN(NRF24_enable_dynamic_payload)
+BENCH_RUN(NRF24_disable_dynamic_payload)
+BENCH_RUN(NRF24_enable_dynamic_payload_on_pipe, NRF_PIPE1)
+BENCH_RUN(NRF24_disable_dynamic_payload_on_pipe, NRF_PIPE1)
+BENCH_RUN(NRF24_enable_dynamic_payload_length)
+BENCH_RUN(NRF24_disable_dynamic_payload_length)
+BENCH_RUN(NRF24_enable_payload_with_ack)
+BENCH_RUN(NRF24_disable_payload_with_ack)
+BENCH_RUN(NRF24_enable_payload_with_no_ack)
+BENCH_RUN(NRF24_disable_payload_with_no_ack)
+BENCH_RUN(NRF24_start_listening)
+BENCH_RUN(NRF24_start_listening_begin)
+BENCH_RUN(NRF24_stop_listening)
+BENCH_RUN(NRF24_transmit_pulse)
+BENCH_RUN(NRF24_transmit_pulse_begin)
+BENCH_RUN(NRF24_get_status)
+BENCH_RUN(NRF24_get_fifo_status)
+BENCH_RUN(NRF24_get_retransmissions_count)
+BENCH_RUN(NRF24_get_lost_packets_count)
+BENCH_RUN(NRF24_put_in_tx_fifo, payload, 4)
+BENCH_RUN(NRF24_transmit, payload, 4)
+BENCH_RUN(NRF24_transmit_begin, payload, 4)
+BENCH_RUN(NRF24_transmit_stream, payload, 4, BENCH_STREAM_COUNT, NULL)
+BENCH_RUN(NRF24_is_data_ready)
+BENCH_RUN(NRF24_get_rx_payload, payload, 4)
+BENCH_RUN(NRF24_receive_all, packets, NRF_ARRAY_SIZE(packets))
+BENCH_RUN(NRF24_tx_transmit_no_ack, payload, 4)
+BENCH_RUN(NRF24_rx_write_payload, NRF_PIPE0, payload, 4)
+BENCH_RUN(NRF24_get_data_pipe_with_payload)
+BENCH_RUN(NRF24_received_power_detector)
+BENCH_RUN(NRF24_is_tx_fifo_full)
+BENCH_RUN(NRF24_is_rx_fifo_empty)
+BENCH_RUN(NRF24_test_carrier)
+BENCH_RUN(NRF24_set_rx_pipe_address, NRF_ADDR_PIPE1, addr, sizeof addr)
+BENCH_RUN(NRF24_get_rx_pipe_address, NRF_ADDR_PIPE3, addr, sizeof addr)
+BENCH_RUN(NRF24_rx_pipe_enable, NRF_PIPE2, NRF_RX_PIPE_ENABLED)
+BENCH_RUN(NRF24_rx_pipe_is_enabled, NRF_PIPE2)
+BENCH_RUN(NRF24_set_irq_handler, NRF_RX_DR_IRQ, handler, NULL)
+BENCH_RUN(NRF24_set_rings, NULL, NULL)
+BENCH_RUN(NRF24_clear_all_irqs)
+BENCH_RUN(NRF24_clear_irq_flag, NRF_RX_DR_IRQ)
+BENCH_RUN(NRF24_get_irq_flag)
+BENCH_RUN(NRF24_poll_interrupt)
+BENCH_RUN(NRF24_get_status_clear_irq)
+BENCH_RUN(NRF24_flush_rx)
+BENCH_RUN(NRF24_flush_tx)
+BENCH_RUN(NRF24_reuse_last_transmitted_payload)
+
+static void run_NRF24_config_apply(void)
+{
+	NRF24_config_apply(&radio, &config, NULL);
+}
+
+static void run_NRF24_config_apply_diff(void)
+{
+	NRF24_config_apply(&radio, &next_config, &config);
+}
+
+static void run_NRF24_scan_sweep(void)
+{
+	NRF24_scan_sweep(&radio, &scan);
+}
+
+#define BENCH_CASE(fn, prepare)	{ #fn, prepare, run_##fn }
+
+static const bench_case cases[] = {
+	BENCH_CASE(NRF24_init, prepare_none),
+	BENCH_CASE(NRF24_set_spi_xfer_vec_cb, prepare_none),
+	BENCH_CASE(NRF24_set_spi_xfer_sg_cb, prepare_none),
+	BENCH_CASE(NRF24_set_time_us_cb, prepare_none),
+	BENCH_CASE(NRF24_set_status_max_age, prepare_time),
+	BENCH_CASE(NRF24_set_power_state, prepare_none),
+	BENCH_CASE(NRF24_get_power_state, prepare_none),
+	BENCH_CASE(NRF24_service, prepare_time),
+	BENCH_CASE(NRF24_service_deadline, prepare_time),
+	BENCH_CASE(NRF24_sleep, prepare_none),
+	BENCH_CASE(NRF24_wakeup, prepare_none),
+	BENCH_CASE(NRF24_wakeup_begin, prepare_time),
+	BENCH_CASE(NRF24_set_mode, prepare_none),
+	BENCH_CASE(NRF24_get_mode, prepare_none),
+	BENCH_CASE(NRF24_set_power_down_mode, prepare_none),
+	BENCH_CASE(NRF24_set_standby_i_mode, prepare_none),
+	BENCH_CASE(NRF24_set_standby_ii_mode, prepare_none),
+	BENCH_CASE(NRF24_set_rx_mode, prepare_none),
+	BENCH_CASE(NRF24_set_tx_mode, prepare_none),
+	BENCH_CASE(NRF24_enable_auto_ack, prepare_none),
+	BENCH_CASE(NRF24_disable_auto_ack, prepare_none),
+	BENCH_CASE(NRF24_set_channel, prepare_none),
+	BENCH_CASE(NRF24_change_channel, prepare_none),
+	BENCH_CASE(NRF24_get_channel, prepare_none),
+	BENCH_CASE(NRF24_set_address_width, prepare_none),
+	BENCH_CASE(NRF24_get_address_width, prepare_none),
+	BENCH_CASE(NRF24_set_auto_retransmit, prepare_none),
+	BENCH_CASE(NRF24_get_auto_retransmit_delay, prepare_none),
+	BENCH_CASE(NRF24_get_auto_retransmit_count, prepare_none),
+	BENCH_CASE(NRF24_set_data_rate, prepare_none),
+	BENCH_CASE(NRF24_get_data_rate, prepare_none),
+	BENCH_CASE(NRF24_set_pa_level, prepare_none),
+	BENCH_CASE(NRF24_get_pa_level, prepare_none),
+	BENCH_CASE(NRF24_set_tx_address, prepare_none),
+	BENCH_CASE(NRF24_get_tx_address, prepare_none),
+	BENCH_CASE(NRF24_set_payload_size, prepare_none),
+	BENCH_CASE(NRF24_get_payload_size, prepare_none),
+	BENCH_CASE(NRF24_enable_dynamic_payload, prepare_none),
+	BENCH_CASE(NRF24_disable_dynamic_payload, prepare_none),
+	BENCH_CASE(NRF24_enable_dynamic_payload_on_pipe, prepare_none),
+	BENCH_CASE(NRF24_disable_dynamic_payload_on_pipe, prepare_none),
+	BENCH_CASE(NRF24_enable_dynamic_payload_length, prepare_none),
+	BENCH_CASE(NRF24_disable_dynamic_payload_length, prepare_none),
+	BENCH_CASE(NRF24_enable_payload_with_ack, prepare_none),
+	BENCH_CASE(NRF24_disable_payload_with_ack, prepare_none),
+	BENCH_CASE(NRF24_enable_payload_with_no_ack, prepare_none),
+	BENCH_CASE(NRF24_disable_payload_with_no_ack, prepare_none),
+	BENCH_CASE(NRF24_start_listening, prepare_prx),
+	BENCH_CASE(NRF24_start_listening_begin, prepare_prx_timed),
+	BENCH_CASE(NRF24_stop_listening, prepare_prx),
+	BENCH_CASE(NRF24_transmit_pulse, prepare_ptx),
+	BENCH_CASE(NRF24_transmit_pulse_begin, prepare_ptx_timed),
+	BENCH_CASE(NRF24_get_status, prepare_none),
+	/* Answered from the STATUS of the last transaction (NRF24_ENABLE_STATUS_CACHE) */
+	{ "NRF24_get_status/kept", prepare_status_kept, run_NRF24_get_status },
+	BENCH_CASE(NRF24_get_fifo_status, prepare_none),
+	BENCH_CASE(NRF24_get_retransmissions_count, prepare_none),
+	BENCH_CASE(NRF24_get_lost_packets_count, prepare_none),
+	BENCH_CASE(NRF24_put_in_tx_fifo, prepare_ptx),
+	BENCH_CASE(NRF24_transmit, prepare_ptx),
+	BENCH_CASE(NRF24_transmit_begin, prepare_ptx_timed),
+	BENCH_CASE(NRF24_transmit_stream, prepare_ptx),
+	BENCH_CASE(NRF24_is_data_ready, prepare_rx_packet),
+	BENCH_CASE(NRF24_get_rx_payload, prepare_rx_packet),
+	BENCH_CASE(NRF24_receive_all, prepare_rx_fifo_full),
+	BENCH_CASE(NRF24_tx_transmit_no_ack, prepare_ptx),
+	BENCH_CASE(NRF24_rx_write_payload, prepare_prx),
+	BENCH_CASE(NRF24_get_data_pipe_with_payload, prepare_rx_packet),
+	BENCH_CASE(NRF24_received_power_detector, prepare_prx),
+	BENCH_CASE(NRF24_is_tx_fifo_full, prepare_none),
+	BENCH_CASE(NRF24_is_rx_fifo_empty, prepare_none),
+	BENCH_CASE(NRF24_test_carrier, prepare_prx),
+	BENCH_CASE(NRF24_set_rx_pipe_address, prepare_none),
+	BENCH_CASE(NRF24_get_rx_pipe_address, prepare_none),
+	BENCH_CASE(NRF24_rx_pipe_enable, prepare_none),
+	BENCH_CASE(NRF24_rx_pipe_is_enabled, prepare_none),
+	BENCH_CASE(NRF24_set_irq_handler, prepare_none),
+	BENCH_CASE(NRF24_set_rings, prepare_none),
+	BENCH_CASE(NRF24_clear_all_irqs, prepare_none),
+	BENCH_CASE(NRF24_clear_irq_flag, prepare_none),
+	BENCH_CASE(NRF24_get_irq_flag, prepare_none),
+	/* IRQ signal inactive, a received packet and packets in the TX ring */
+	{ "NRF24_poll_interrupt/idle", prepare_none, run_NRF24_poll_interrupt },
+	{ "NRF24_poll_interrupt/rx_dr", prepare_rx_packet, run_NRF24_poll_interrupt },
+	{ "NRF24_poll_interrupt/tx_ring", prepare_tx_ring, run_NRF24_poll_interrupt },
+	BENCH_CASE(NRF24_get_status_clear_irq, prepare_none),
+	BENCH_CASE(NRF24_flush_rx, prepare_none),
+	BENCH_CASE(NRF24_flush_tx, prepare_none),
+	BENCH_CASE(NRF24_reuse_last_transmitted_payload, prepare_none),
+	/* Whole register image and a channel change */
+	BENCH_CASE(NRF24_config_apply, prepare_config),
+	{ "NRF24_config_apply/diff", prepare_config, run_NRF24_config_apply_diff },
+	BENCH_CASE(NRF24_scan_sweep, prepare_prx),
+};
+
+/**
+ * @brief Load the budget file.
+ *
+ * @return Number of budgets loaded.
+ */
+static size_t load_budget(const char *path, bench_budget *budget, size_t max_budget)
+{
+	FILE *file = fopen(path, "r");
+	char line[128];
+	size_t count = 0;
+
+	if (NULL == file) {
+		fprintf(stderr, "Can't open the budget file %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	while ((count < max_budget) && (NULL != fgets(line, sizeof line, file))) {
+		bench_budget *entry = &budget[count];
+
+		if ('#' == line[0]) {
+			continue;
+		}
+
+		if (3 == sscanf(line, "%63s %lu %lu", entry->name, &entry->transactions,
+			&entry->bytes)) {
+			count++;
+		}
+	}
+
+	fclose(file);
+
+	return count;
+}
+
+static const bench_budget *find_budget(const bench_budget *budget, size_t count,
+	const char *name)
+{
+	for (size_t idx = 0; idx < count; idx++) {
+		if (0 == strcmp(budget[idx].name, name)) {
+			return &budget[idx];
+		}
+	}
+
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	static bench_budget budget[BENCH_BUDGET_MAX];
+	size_t budget_count = 0;
+	int over_budget = 0;
+
+	if (1 < argc) {
+		budget_count = load_budget(argv[1], budget, BENCH_BUDGET_MAX);
+	}
+
+	printf("%-40s %6s %6s %6s %10s %12s\n", "function", "xfers", "bytes", "ce",
+		"delay_us", "budget");
+
+	for (size_t idx = 0; idx < NRF_ARRAY_SIZE(cases); idx++) {
+		const bench_case *c = &cases[idx];
+
+		nrf_emu_init(&emu);
+		nrf_emu_select(&emu);
+		run_NRF24_init();
+
+		c->prepare();
+		nrf_emu_reset_counters(&emu);
+		c->run();
+
+		const nrf_emu_counters *counters = &emu.counters;
+		const bench_budget *entry = find_budget(budget, budget_count, c->name);
+		char verdict[32] = "-";
+
+		if (NULL != entry) {
+			const int over = (counters->spi_transactions > entry->transactions) ||
+				(counters->spi_bytes > entry->bytes);
+
+			snprintf(verdict, sizeof verdict, "%lu/%lu %s", entry->transactions,
+				entry->bytes, over ? "OVER" : "ok");
+			over_budget |= over;
+		}
+
+		printf("%-40s %6lu %6lu %6lu %10lu %12s\n", c->name, counters->spi_transactions,
+			counters->spi_bytes, counters->ce_toggles, counters->delay_us, verdict);
+	}
+
+	if (over_budget) {
+		fprintf(stderr, "SPI budget exceeded\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
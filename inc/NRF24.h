@@ -29,6 +29,13 @@ extern "C" {
 /* Get elements in array */
 #define NRF_ARRAY_SIZE(array)	((sizeof array)/(sizeof *array))
 
+/* Mirror the writable registers in the radio object, define NRF24_ENABLE_REG_CACHE
+ * to use it. Memory constrained builds can leave it out. */
+#if defined(NRF24_ENABLE_REG_CACHE)
+	/* Registers 0x00 (CONFIG) up to 0x1D (FEATURE) */
+	#define NRF_REG_CACHE_SIZE	(NRF_REG_FEATURE + 1)
+#endif
+
 /* Component version info */
 #define NRF24_VERSION_MAJOR  0
 #define NRF24_VERSION_MINOR  1
@@ -45,14 +52,150 @@ typedef nrf_gpio (*nrf_read_irq)(void);
 /* Delay ms */
 typedef void (*nrf_delay_ms)(uint32_t ms);
 
-/* Collection of user callbacks */
+/* Delay us */
+typedef void (*nrf_delay_us)(uint32_t us);
+
+/* Free running timestamp in us, wraps around */
+typedef uint32_t (*nrf_time_us)(void);
+
+/* One SPI transaction, the chip select is asserted during the whole segment */
+typedef struct {
+	const uint8_t	*in;
+	uint8_t		*out;
+	size_t		xfer_size;
+} nrf_spi_segment;
+
+/* Perform @p count SPI transactions back to back, i.e. with a DMA chain */
+typedef void (*nrf_spi_xfer_vec)(const nrf_spi_segment *segments, const size_t count);
+
+/* Send @p cmd and then @p xfer_size bytes within the same SPI transaction
+ * without copying the payload: the bytes sent are taken from @p in (dummy
+ * bytes if NULL) and the bytes received are stored in @p out (discarded if
+ * NULL), the STATUS register clocked out with @p cmd is stored in @p status */
+typedef void (*nrf_spi_xfer_sg)(const uint8_t cmd, uint8_t *status,
+	const uint8_t *in, uint8_t *out, const size_t xfer_size);
+
+/* Start a SPI transfer and return immediately, NRF24_async_xfer_complete
+ * must be called once the transfer is done, i.e. from the DMA ISR */
+typedef void (*nrf_spi_xfer_async)(const uint8_t *in, uint8_t *out, const size_t xfer_size);
+
+/* Packet read from the RX FIFO (or to be written in the TX FIFO, pipe is not
+ * used then) */
+typedef struct {
+	uint8_t	pipe;
+	uint8_t	payload_size;
+	uint8_t	payload[NRF_PAYLOAD_SIZE_MAX];
+} nrf_packet;
+
 typedef struct _nrf_radio nrf_radio;
 
+/* Single producer single consumer queue of packets, see NRF24_RING.h */
+typedef struct _nrf_ring nrf_ring;
+
+/* Bus trace, see NRF24_TRACE.h */
+typedef struct _nrf_trace nrf_trace;
+
+/* Called when an asynchronous operation is done, @p status is the STATUS
+ * register returned by the last SPI transfer of the operation */
+typedef void (*nrf_async_done)(nrf_radio *radio, uint8_t status, void *context);
+
+/* Called by NRF24_poll_interrupt for each interrupt flag set, @p status is
+ * the STATUS register read (i.e. to get the pipe of the received data) */
+typedef void (*nrf_irq_handler)(nrf_radio *radio, uint8_t status, void *context);
+
+/* One handler for each interrupt flag: MAX_RT, TX_DS and RX_DR */
+#define NRF_IRQ_HANDLERS	3
+
+/* Non-blocking operations, define NRF24_ENABLE_ASYNC to use them */
+#if defined(NRF24_ENABLE_ASYNC)
+typedef struct {
+	uint8_t			in[NRF_PAYLOAD_SIZE_MAX + 1];
+	uint8_t			out[NRF_PAYLOAD_SIZE_MAX + 1];
+	/* User buffer where the data read is stored */
+	uint8_t			*data;
+	size_t			data_size;
+	volatile uint8_t	op;
+	nrf_async_done		done_cb;
+	void			*context;
+} nrf_async;
+#endif
+
+/* Runtime counters, define NRF24_ENABLE_STATS to use them */
+#if defined(NRF24_ENABLE_STATS)
+typedef struct {
+	uint32_t	spi_transactions;
+	uint32_t	spi_bytes;
+	uint32_t	ce_edges;
+	/* Payloads written into the TX FIFO and read from the RX FIFO */
+	uint32_t	packets_sent;
+	uint32_t	packets_received;
+	/* Interrupt flags, counted when they are cleared */
+	uint32_t	tx_ds;
+	uint32_t	max_rt;
+	uint32_t	rx_dr;
+	/* Accumulated OBSERVE_TX values */
+	uint32_t	arc;
+	uint32_t	plos;
+} nrf_stats;
+#endif
+
+/* Collection of user callbacks */
 struct _nrf_radio {
 	nrf_write_ce 	write_ce_cb;
 	nrf_read_irq 	read_irq_cb;
 	nrf_delay_ms 	delay_ms_cb;
+	nrf_delay_us	delay_us_cb;
 	nrf_spi_xfer	spi_xfer_data_cb;
+	nrf_spi_xfer_vec	spi_xfer_vec_cb;
+	nrf_spi_xfer_sg		spi_xfer_sg_cb;
+	nrf_time_us	time_us_cb;
+	/* Indexed by the interrupt flag bit position minus NRF_STATUS_BIT_MAX_RT */
+	nrf_irq_handler	irq_handlers[NRF_IRQ_HANDLERS];
+	void		*irq_contexts[NRF_IRQ_HANDLERS];
+	/* Serviced by NRF24_poll_interrupt, can be NULL */
+	nrf_ring	*rx_ring;
+	nrf_ring	*tx_ring;
+#if defined(NRF24_ENABLE_ASYNC)
+	nrf_spi_xfer_async	spi_xfer_async_cb;
+	nrf_async		async;
+#endif
+#if defined(NRF24_ENABLE_STATS)
+	nrf_stats	stats;
+	/* Last CE level and PLOS count seen, to count edges and PLOS increments */
+	uint8_t		stats_ce;
+	uint8_t		stats_plos;
+#endif
+#if defined(NRF24_ENABLE_TRACE)
+	/* Records the bus traffic when not NULL */
+	nrf_trace	*trace;
+#endif
+#if defined(NRF24_ENABLE_REG_CACHE)
+	/* Write-through copy of the single byte registers, reg_cache_valid
+	 * have one bit per register */
+	uint8_t		reg_cache[NRF_REG_CACHE_SIZE];
+	uint32_t	reg_cache_valid;
+#endif
+	/* Power state machine: PWR_UP and PRIM_RX of CONFIG as last read or
+	 * written and the CE level (NRF_POWER_UNKNOWN until then), the
+	 * transitions still settling and when they started */
+	uint8_t		power_config;
+	uint8_t		power_ce;
+	uint8_t		power_pending;
+	uint32_t	power_up_time;
+	uint32_t	ce_high_time;
+	/* Split-phase operations: the steps left for NRF24_service and when
+	 * CE goes low to end the transmit pulse */
+	uint8_t		service_steps;
+	uint32_t	service_ce_low_time;
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+	/* Last STATUS seen on the bus, define NRF24_ENABLE_STATUS_CACHE to keep
+	 * it. Usable while status_valid is set and it's younger than
+	 * status_max_age_us (status_time is when it was seen) */
+	uint8_t		status;
+	uint8_t		status_valid;
+	uint32_t	status_time;
+	uint32_t	status_max_age_us;
+#endif
 };
 
 /**
@@ -63,10 +206,146 @@ struct _nrf_radio {
  * @param[in] 	write_ce_cb: . Required.
  * @param[in]	read_irq_cb: . Required only when using IRQ signal.
  * @param[in]	delay_ms_cb: . Required.
+ * @param[in]	delay_us_cb: . Optional, used for the sub-millisecond delays
+ * 				(CE pulse, PLL settling, power up), when not provided
+ * 				delay_ms_cb is used instead, rounding up to 1ms.
  */
 int NRF24_init(nrf_radio *radio,
 	nrf_spi_xfer spi_xfer_cb, nrf_write_ce write_ce_cb,
-	nrf_read_irq read_irq_cb, nrf_delay_ms delay_ms_cb);
+	nrf_read_irq read_irq_cb, nrf_delay_ms delay_ms_cb,
+	nrf_delay_us delay_us_cb);
+
+/**
+ * @brief Register the optional vectored SPI callback.
+ *
+ * When registered, batches of commands (see NRF24_BATCH.h) are handed to it
+ * in a single call, otherwise each command of the batch is sent using the
+ * spi_xfer callback.
+ *
+ * @param[in]	radio:
+ * @param[in]	spi_xfer_vec_cb: Vectored SPI callback, NULL to unregister it.
+ */
+void NRF24_set_spi_xfer_vec_cb(nrf_radio *radio, nrf_spi_xfer_vec spi_xfer_vec_cb);
+
+/**
+ * @brief Register the optional scatter/gather SPI callback.
+ *
+ * When registered, the payload commands (TX, RX and ACK payloads) send the
+ * command byte and the payload to it, so the payload is read from (or
+ * written into) the user buffer directly, otherwise the payload is copied
+ * into a temporary buffer and sent using the spi_xfer callback.
+ *
+ * @param[in]	radio:
+ * @param[in]	spi_xfer_sg_cb: Scatter/gather SPI callback, NULL to unregister it.
+ */
+void NRF24_set_spi_xfer_sg_cb(nrf_radio *radio, nrf_spi_xfer_sg spi_xfer_sg_cb);
+
+/**
+ * @brief Register the optional timestamp callback.
+ *
+ * Needed by the features scheduled in time, i.e. the channel hopping (see
+ * NRF24_HOP.h).
+ *
+ * @param[in]	radio:
+ * @param[in]	time_us_cb: Timestamp callback, NULL to unregister it.
+ */
+void NRF24_set_time_us_cb(nrf_radio *radio, nrf_time_us time_us_cb);
+
+/**
+ * @brief Set for how long the STATUS register seen on the bus answers the
+ * STATUS queries.
+ *
+ * Every SPI transaction clocks out the STATUS register. With the status
+ * cache enabled (NRF24_ENABLE_STATUS_CACHE) the last one is kept, and
+ * NRF24_get_status, NRF24_is_data_ready, NRF24_get_irq_flag,
+ * NRF24_get_data_pipe_with_payload and NRF24_is_tx_fifo_full use it instead
+ * of reading the radio while it's younger than @p max_age_us. The radio sets
+ * the interrupt flags on its own, so a flag set after the last transaction
+ * shows up once the copy is too old. Writing CE and the payload and flush
+ * commands drop the copy, they change what STATUS reports.
+ *
+ * Needs the timestamp callback (NRF24_set_time_us_cb). Does nothing when the
+ * status cache is disabled.
+ *
+ * @param[in]	radio:
+ * @param[in]	max_age_us: 0 (the default) to always read the radio.
+ */
+void NRF24_set_status_max_age(nrf_radio *radio, const uint32_t max_age_us);
+
+/**
+ * @brief Move the radio to @p state.
+ *
+ * The library keeps track of the PWR_UP and PRIM_RX bits and of the CE
+ * level, so only the steps the radio isn't at already are done: a write to
+ * CONFIG when PWR_UP or PRIM_RX change and the CE writes. CE goes low before
+ * PRIM_RX is changed. Then it waits for the datasheet timings: Tpd2stby
+ * (1.5ms) after a power up, Tstby2a (130us) after CE goes high to enter RX
+ * or TX, and Thce (10us) of CE high before it goes low on a transmitter.
+ * With the timestamp callback (NRF24_set_time_us_cb) it waits only for what's
+ * left of them, i.e. after a NRF24_wakeup done 1ms ago there are 0.5ms
+ * left. Without it each wait takes the whole time.
+ *
+ * NRF_STATE_STANDBY_II and NRF_STATE_TX are both a transmitter with CE high.
+ * The radio sends the TX FIFO and then stays in standby-II. Only
+ * NRF_STATE_TX waits for the PLL to settle.
+ *
+ * @param[in]	radio:
+ * @param[in]	state: Anything but NRF_STATE_UNKNOWN.
+ */
+void NRF24_set_power_state(nrf_radio *radio, const nrf_power_state state);
+
+/**
+ * @brief Get the state the radio is in (or moving to), from the PWR_UP and
+ * PRIM_RX bits and the CE level the library knows about, without talking to
+ * the radio.
+ *
+ * A transmitter with CE high is reported as NRF_STATE_STANDBY_II, whether or
+ * not it's sending a payload.
+ *
+ * @param[in]	radio:
+ * @return NRF_STATE_UNKNOWN until CONFIG was read or written and CE written.
+ */
+nrf_power_state NRF24_get_power_state(nrf_radio *radio);
+
+/**
+ * @brief Complete the steps of the split-phase operations (NRF24_wakeup_begin,
+ * NRF24_start_listening_begin, NRF24_transmit_pulse_begin and
+ * NRF24_transmit_begin) whose deadline has passed, never waiting.
+ *
+ * The split-phase operations do the bus work of their blocking counterpart
+ * and return the deadline of the first step left instead of calling the
+ * delay callbacks: the end of Tpd2stby before CE goes high, the end of the CE
+ * pulse and the end of Tstby2a. One task can drive many radios:
+ *
+ * @code
+ * uint32_t deadline = NRF24_transmit_begin(&radio, payload, sizeof payload);
+ * ...
+ * if ((int32_t) (now - deadline) >= 0) {
+ *     busy = NRF24_service(&radio, now);
+ *     deadline = NRF24_service_deadline(&radio);
+ * }
+ * @endcode
+ *
+ * The timestamp callback (NRF24_set_time_us_cb) is required, @p now comes
+ * from the same clock. Don't call the blocking power functions
+ * (NRF24_set_power_state, NRF24_transmit, ...) while steps are left.
+ *
+ * @param[in]	radio:
+ * @param[in]	now: Timestamp in us.
+ *
+ * @return 1 while steps are left (or the radio is still settling), 0 once
+ * 		the operations are done.
+ */
+int NRF24_service(nrf_radio *radio, const uint32_t now);
+
+/**
+ * @brief When NRF24_service has to be called next.
+ *
+ * @param[in]	radio:
+ *
+ * @return Deadline in us, the current timestamp when nothing is left.
+ */
+uint32_t NRF24_service_deadline(nrf_radio *radio);
 
 /**
  * @brief Sleep the radio.
@@ -81,10 +360,22 @@ void NRF24_sleep(nrf_radio *radio);
 /**
  * @brief Wake-up the radio.
  *
+ * Sets PWR_UP (unless it's known to be set) and waits for what's left of
+ * Tpd2stby, see NRF24_set_power_state.
+ *
  * @param radio
  */
 void NRF24_wakeup(nrf_radio *radio);
 
+/**
+ * @brief Split-phase NRF24_wakeup, sets PWR_UP without waiting, the radio is
+ * in standby-I at the deadline, see NRF24_service.
+ *
+ * @param radio
+ * @return Deadline in us.
+ */
+uint32_t NRF24_wakeup_begin(nrf_radio *radio);
+
 /**
  * @brief Configure the radio as Receiver or Transmitter.
  *
@@ -98,7 +389,8 @@ void NRF24_set_mode(nrf_radio *radio, const nrf_mode mode);
  * @brief Get radio mode.
  *
  * @param[in]	radio:
- * @return
+ * @return NRF_MODE_RX if the PRIM_RX bit is set, NRF_MODE_TX otherwise. The
+ * 		last value read or written is used when there's one.
  */
 nrf_mode NRF24_get_mode(nrf_radio *radio);
 
@@ -110,6 +402,7 @@ nrf_mode NRF24_get_mode(nrf_radio *radio);
  * enabling change of configuration and the uploading/downloading of data
  * registers.
  * Power down mode is entered by setting the PWR_UP bit (CONFIG register) to 0.
+ * Same as NRF24_set_power_state with NRF_STATE_POWER_DOWN.
  *
  * @param radio
  */
@@ -124,6 +417,7 @@ void NRF24_set_power_down_mode(nrf_radio *radio);
  * In this mode only part of the crystal oscillator is active. Change to
  * active modes only happens if CE is set high and when CE is set low,
  * the NRF24 returns to standby-I mode from both the TX and RX modes.
+ * Same as NRF24_set_power_state with NRF_STATE_STANDBY_I.
  *
  * @param radio
  */
@@ -137,6 +431,7 @@ void NRF24_set_standby_i_mode(nrf_radio *radio);
  * on a TX device with an empty TX FIFO.
  * If a new packet is uploaded to the TX FIFO, the PLL immediately starts and
  * the packet is transmitted after the normal PLL settling  delay (130us).
+ * Same as NRF24_set_power_state with NRF_STATE_STANDBY_II.
  *
  * @param radio
  */
@@ -188,6 +483,22 @@ void NRF24_disable_auto_ack(nrf_radio *radio, const nrf_pipe pipe);
  */
 void NRF24_set_channel(nrf_radio *radio, uint8_t channel);
 
+/**
+ * @brief Set the channel, flushing only the FIFOs that are not empty.
+ *
+ * NRF24_set_channel always flushes both FIFOs, here the RF_CH write and a
+ * FIFO_STATUS read are sent as one batch and the flush commands are only
+ * sent when needed, so a change with the FIFOs empty is a single submission
+ * of two transactions.
+ * The radio only tunes to RF_CH on a CE rising edge: with CE high (i.e. a
+ * listening receiver) CE goes low around the write and high again, and the
+ * PLL settling (130us) is waited, see NRF24_set_power_state.
+ *
+ * @param radio
+ * @param channel: Channel where the radio will work.
+ */
+void NRF24_change_channel(nrf_radio *radio, uint8_t channel);
+
 /**
  *
  * @param radio
@@ -216,6 +527,79 @@ void NRF24_set_address_width(nrf_radio *radio, const nrf_addr_width addr_width);
  */
 uint8_t NRF24_get_address_width(nrf_radio *radio);
 
+/**
+ * @brief Set the automatic retransmission delay and count.
+ *
+ * SETUP_RETR is written at once, without reading it first.
+ *
+ * @param radio
+ * @param delay: Wait between the end of a transmission and the next
+ * 				retransmission, NRF_AUTO_RETRANSMIT_DELAY_250_US up to
+ * 				NRF_AUTO_RETRANSMIT_DELAY_4000_US. It must be long enough to
+ * 				receive the ACK, see NRF24_min_retransmit_delay.
+ * @param count: Max number of retransmissions, NRF_AUTO_RETRANSMIT_CNT_0
+ * 				(disabled) up to NRF_AUTO_RETRANSMIT_CNT_15.
+ */
+void NRF24_set_auto_retransmit(nrf_radio *radio, const uint8_t delay, const uint8_t count);
+
+/**
+ * @param radio
+ * @return Automatic retransmission delay, NRF_AUTO_RETRANSMIT_DELAY_x.
+ */
+uint8_t NRF24_get_auto_retransmit_delay(nrf_radio *radio);
+
+/**
+ * @param radio
+ * @return Max number of retransmissions, NRF_AUTO_RETRANSMIT_CNT_x.
+ */
+uint8_t NRF24_get_auto_retransmit_count(nrf_radio *radio);
+
+/**
+ * @brief Shortest retransmission delay that lets the ACK be received.
+ *
+ * From the nRF24L01+ datasheet: at 2Mbps 250us are enough for ACK payloads
+ * up to 15 bytes, at 1Mbps up to 5 bytes, 500us are enough for any ACK
+ * payload. At 250kbps the delay is at least 500us and 250us more are needed
+ * for each 8 bytes of ACK payload (or part of them), i.e. 750us up to 8 bytes
+ * and 1500us for 32 bytes.
+ *
+ * @param data_rate: NRF_RF_SETUP_RF_DR_250, NRF_RF_SETUP_RF_DR_1000 or
+ * 				NRF_RF_SETUP_RF_DR_2000.
+ * @param ack_payload_size: Largest ACK payload, 0 if ACK payloads are not used.
+ * @return Delay, NRF_AUTO_RETRANSMIT_DELAY_x.
+ */
+uint8_t NRF24_min_retransmit_delay(const uint8_t data_rate, const uint8_t ack_payload_size);
+
+/**
+ * @brief Set the air data rate, both ends of the link must use the same.
+ *
+ * @param radio
+ * @param data_rate: NRF_RF_SETUP_RF_DR_250, NRF_RF_SETUP_RF_DR_1000 or
+ * 				NRF_RF_SETUP_RF_DR_2000.
+ */
+void NRF24_set_data_rate(nrf_radio *radio, const uint8_t data_rate);
+
+/**
+ * @param radio
+ * @return Air data rate, NRF_RF_SETUP_RF_DR_x.
+ */
+uint8_t NRF24_get_data_rate(nrf_radio *radio);
+
+/**
+ * @brief Set the output power in TX mode.
+ *
+ * @param radio
+ * @param level: NRF_RF_SETUP_RF_PWR_18 (-18dBm), NRF_RF_SETUP_RF_PWR_12,
+ * 				NRF_RF_SETUP_RF_PWR_6 or NRF_RF_SETUP_RF_PWR_0 (0dBm).
+ */
+void NRF24_set_pa_level(nrf_radio *radio, const uint8_t level);
+
+/**
+ * @param radio
+ * @return Output power, NRF_RF_SETUP_RF_PWR_x.
+ */
+uint8_t NRF24_get_pa_level(nrf_radio *radio);
+
 /**
  * @brief Set the TX Address of the radio.
  *
@@ -325,10 +709,23 @@ void NRF24_disable_payload_with_no_ack(nrf_radio *radio);
 /**
  * @brief The NRF24 radio will start listening.
  *
- * Set the CE pin to logic high to enable the radio from "listening".
+ * Set the CE pin to logic high to enable the radio from "listening" and
+ * wait for the PLL to settle (130us), and for Tpd2stby if the radio is still
+ * powering up. Only what's left of them is waited, see
+ * NRF24_set_power_state.
  */
 void NRF24_start_listening(nrf_radio *radio);
 
+/**
+ * @brief Split-phase NRF24_start_listening, CE goes high (from NRF24_service
+ * if the radio is still powering up), the radio is listening once
+ * NRF24_service returns 0.
+ *
+ * @param radio
+ * @return Deadline in us.
+ */
+uint32_t NRF24_start_listening_begin(nrf_radio *radio);
+
 /**
  * @brief The NRF24 radio will stop "listening".
  *
@@ -339,11 +736,22 @@ void NRF24_stop_listening(nrf_radio *radio);
 /**
  * @brief Transmit pulse on the CE pin.
  *
- * The CE pin of the NRF24 radio will have a pulse of 15us,
+ * The CE pin of the NRF24 radio will have a pulse of 15us (using the delay_us
+ * callback when available),
  * this pulse trigger a transmission of the content of the TX FIFO.
  */
 void NRF24_transmit_pulse(nrf_radio *radio);
 
+/**
+ * @brief Split-phase NRF24_transmit_pulse, CE goes high (from NRF24_service
+ * if the radio is still powering up) and NRF24_service drops it 15us
+ * later, see NRF24_service.
+ *
+ * @param radio
+ * @return Deadline in us.
+ */
+uint32_t NRF24_transmit_pulse_begin(nrf_radio *radio);
+
 /**
  * @brief Get the STATUS register of the NRF24.
  *
@@ -384,6 +792,51 @@ void NRF24_put_in_tx_fifo(nrf_radio *radio, const uint8_t *payload, size_t paylo
  */
 void NRF24_transmit(nrf_radio *radio, const uint8_t *payload, size_t payload_size);
 
+/**
+ * Split-phase NRF24_transmit, put data in TX FIFO and start the CE pulse,
+ * see NRF24_transmit_pulse_begin.
+ *
+ * @param[in]	payload: Data to be sent.
+ * @param[in]	payload_size: Bytes of data.
+ *
+ * @return Deadline in us.
+ */
+uint32_t NRF24_transmit_begin(nrf_radio *radio, const uint8_t *payload, size_t payload_size);
+
+/**
+ * @brief Transmit several payloads back to back.
+ *
+ * The TX FIFO is pre-filled with up to three payloads and CE is kept high
+ * (the radio goes to standby-II mode when the TX FIFO gets empty), the TX
+ * FIFO is refilled each time a payload is sent (TX_DS), so the radio
+ * doesn't idle between payloads.
+ * Returns when all the payloads were sent, when a payload reached the
+ * maximum number of retransmissions or when no payload was sent for
+ * NRF_TX_TIMEOUT_US (NRF_TX_TIMEOUT_POLLS STATUS polls without the timestamp
+ * callback), i.e. the radio is powered down or a receiver.
+ * The payloads not sent (the one that failed and the ones queued behind it)
+ * are left in the TX FIFO, in order and with MAX_RT cleared: call it again
+ * with the payloads from @p queued on (or a @p count of 0) to retry them and
+ * carry on, or NRF24_flush_tx to drop them. Payloads left in the TX FIFO
+ * by a previous call are sent first.
+ *
+ * @note The radio must be powered up and configured as transmitter.
+ *
+ * @param[in]	radio:
+ * @param[in]	payloads: @p count payloads of @p payload_size bytes each,
+ * 				one after the other.
+ * @param[in]	payload_size: Bytes of each payload.
+ * @param[in]	count: Number of payloads.
+ * @param[out]	queued: Number of payloads written into the TX FIFO, the
+ * 				next payload to queue when carrying on. Can be NULL.
+ *
+ * @return NRF_TX_DS_IRQ if all the payloads were sent, NRF_MAX_RT_IRQ if a
+ * 		payload reached the maximum number of retransmissions,
+ * 		NRF_NONE_IRQ on timeout.
+ */
+nrf_irq NRF24_transmit_stream(nrf_radio *radio, const uint8_t *payloads,
+	size_t payload_size, size_t count, size_t *queued);
+
 /**
  * @brief
  *
@@ -399,6 +852,25 @@ uint8_t NRF24_is_data_ready(nrf_radio *radio);
  */
 void NRF24_get_rx_payload(nrf_radio *radio, uint8_t *payload, const size_t payload_size);
 
+/**
+ * @brief Read every packet in the RX FIFO.
+ *
+ * The pipe of each packet is taken from the STATUS register returned by the
+ * SPI transactions, the payload width from R_RX_PL_WID for the pipes with
+ * dynamic payload length enabled and from RX_PW_Px otherwise. RX_DR is
+ * cleared once the RX FIFO is empty.
+ * Unlike NRF24_get_rx_payload CE is not toggled, so the radio keeps
+ * receiving while the RX FIFO is drained.
+ *
+ * @param[in]	radio:
+ * @param[out]	packets: Where the packets read are stored.
+ * @param[in]	max_packets: Number of elements of @p packets, the packets that
+ * 				don't fit are left in the RX FIFO.
+ *
+ * @return Number of packets read.
+ */
+size_t NRF24_receive_all(nrf_radio *radio, nrf_packet *packets, const size_t max_packets);
+
 /**
  *
  * @param radio
@@ -492,6 +964,34 @@ nrf_rx_pipe_enabled NRF24_rx_pipe_is_enabled(nrf_radio *radio, nrf_pipe pipe);
 
 /* IRQ Handling */
 
+/**
+ * @brief Register the handler of an interrupt flag.
+ *
+ * @param[in]	radio:
+ * @param[in]	irq: NRF_RX_DR_IRQ, NRF_TX_DS_IRQ or NRF_MAX_RT_IRQ.
+ * @param[in]	handler: Called by NRF24_poll_interrupt when @p irq is set,
+ * 				NULL to remove the handler.
+ * @param[in]	context: Passed to @p handler.
+ */
+void NRF24_set_irq_handler(nrf_radio *radio, const nrf_irq irq,
+	nrf_irq_handler handler, void *context);
+
+/**
+ * @brief Attach the packet rings serviced by NRF24_poll_interrupt.
+ *
+ * On RX_DR the RX FIFO is drained into @p rx_ring (RX_DR is kept set while
+ * the ring is full), and the packets queued in @p tx_ring are moved into the
+ * TX FIFO while it has room. The radio sends them as soon as they are in
+ * the TX FIFO when CE is kept high.
+ * On MAX_RT the failed payload stays in the TX FIFO, flush it or reuse it
+ * from the MAX_RT handler.
+ *
+ * @param[in]	radio:
+ * @param[in]	rx_ring: Can be NULL.
+ * @param[in]	tx_ring: Can be NULL.
+ */
+void NRF24_set_rings(nrf_radio *radio, nrf_ring *rx_ring, nrf_ring *tx_ring);
+
 /**
  * Clears all interrupt flags on the Status register.
  */
@@ -500,7 +1000,8 @@ void NRF24_clear_all_irqs(nrf_radio *radio);
 /**
  * @brief Clears the specific IRQ flag.
  *
- * Clear the flag by writing 1 to the interrupt flag bit.
+ * Clear the flag by writing 1 to the interrupt flag bit, the other flags
+ * are not affected.
  *
  * @param nrf_irq irq_flag: Interrupt flag to clear.
  */
@@ -514,10 +1015,15 @@ void NRF24_clear_irq_flag(nrf_radio *radio, const nrf_irq irq_flag);
 nrf_irq NRF24_get_irq_flag(nrf_radio *radio);
 
 /**
- * Wait for any interrupt flag.
+ * @brief Service the interrupt flags.
+ *
+ * When the IRQ signal callback was provided and the signal is inactive
+ * (high) this returns without talking to the radio. Otherwise the STATUS
+ * register is read once, the flags set are cleared with a single write and
+ * the registered handlers are called (RX_DR, then TX_DS, then MAX_RT).
  *
  * @param radio
- * @return received interrupt flag
+ * @return The interrupt flags that were set, NRF_NONE_IRQ if none.
  */
 nrf_irq NRF24_poll_interrupt(nrf_radio *radio);
 
@@ -0,0 +1,420 @@
+/**
+* @file     NRF24.hpp
+* @version  0.1
+*
+* @brief    Header only C++ radio, the hardware operations are bound at
+* compile time so they can be inlined.
+*
+* The C API calls the hardware through the function pointers of nrf_radio,
+* nrf24::Radio gets them as policy types with static member functions
+* instead, a call such as transmit is then straight-line code around the
+* SPI and GPIO operations. The register and command logic is the one of
+* NRF24.c, NRF24_COMMANDS.c and NRF24_INTERFACE.c, each method sends the
+* same SPI transactions as the C function of the same name (without the
+* register cache, the runtime counters nor the batched transfers).
+*
+* Policies:
+*
+* @code
+* struct Spi   { static void xfer(const uint8_t *in, uint8_t *out, size_t size); };
+* struct Ce    { static void write(nrf_gpio state); };
+* struct Irq   { static nrf_gpio read(void); };
+* struct Delay { static void ms(uint32_t ms); static void us(uint32_t us); };
+* @endcode
+*
+* The radio has no state, the same hardware can be driven through the C API
+* and the template (with NRF24_ENABLE_REG_CACHE call NRF24_reg_cache_invalidate
+* on the nrf_radio after writing registers through the template):
+*
+* @code
+* nrf24::Radio<BoardSpi, BoardCe, nrf24::NoIrq, BoardDelay> radio;
+*
+* radio.wakeup();
+* radio.transmit(payload, sizeof payload);
+* @endcode
+*/
+
+#ifndef NRF24_HPP
+#define NRF24_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+namespace nrf24 {
+
+/* For radios without the IRQ pin, the interrupt is always checked on STATUS */
+struct NoIrq {
+    static nrf_gpio read(void)
+    {
+        return GPIO_CLEAR;
+    }
+};
+
+template <class Spi, class Ce, class Irq, class Delay>
+class Radio {
+public:
+    /* Address registers are the largest ones */
+    enum {
+        REG_SIZE_MAX = NRF_PIPE_ADDR_WIDTH_5BYTES,
+    };
+
+    /* INTERFACE */
+
+    uint8_t read_reg(const nrf_register reg, uint8_t *data, const size_t data_size) const
+    {
+        NRF24_ASSERT(REG_SIZE_MAX >= data_size);
+
+        uint8_t data_in[REG_SIZE_MAX + 1];
+        uint8_t data_out[REG_SIZE_MAX + 1];
+
+        data_in[0] = static_cast<uint8_t>(NRF_CMD_R_REGISTER | static_cast<unsigned>(reg));
+
+        for (size_t idx = 0; idx < data_size; idx++) {
+            data_in[idx + 1] = NRF_CMD_NOP;
+        }
+
+        Spi::xfer(data_in, data_out, data_size + 1);
+
+        for (size_t idx = 0; idx < data_size; idx++) {
+            data[idx] = data_out[idx + 1];
+        }
+
+        return data_out[0];
+    }
+
+    uint8_t write_reg(const nrf_register reg, const uint8_t *data, const size_t data_size) const
+    {
+        NRF24_ASSERT(REG_SIZE_MAX >= data_size);
+
+        uint8_t data_in[REG_SIZE_MAX + 1];
+        uint8_t data_out[REG_SIZE_MAX + 1];
+
+        data_in[0] = static_cast<uint8_t>(NRF_CMD_W_REGISTER | static_cast<unsigned>(reg));
+
+        for (size_t idx = 0; idx < data_size; idx++) {
+            data_in[idx + 1] = data[idx];
+        }
+
+        Spi::xfer(data_in, data_out, data_size + 1);
+
+        return data_out[0];
+    }
+
+    uint8_t read_reg(const nrf_register reg) const
+    {
+        uint8_t value = 0;
+        read_reg(reg, &value, 1);
+        return value;
+    }
+
+    uint8_t write_reg(const nrf_register reg, const uint8_t value) const
+    {
+        return write_reg(reg, &value, 1);
+    }
+
+    /* Value must be shifted already, see NRF24_write_bits */
+    void write_bits(const nrf_register reg, const uint8_t mask, const uint8_t value) const
+    {
+        const uint8_t reg_value = read_reg(reg);
+
+        write_reg(reg, static_cast<uint8_t>((reg_value & ~mask) | value));
+    }
+
+    uint8_t read_bit(const nrf_register reg, const uint8_t bit_pos) const
+    {
+        NRF24_ASSERT(8 > bit_pos);
+
+        return (read_reg(reg) & (1U << bit_pos)) != 0;
+    }
+
+    void set_bit(const nrf_register reg, const uint8_t bit_pos) const
+    {
+        NRF24_ASSERT(8 > bit_pos);
+
+        write_bits(reg, static_cast<uint8_t>(1U << bit_pos), static_cast<uint8_t>(1U << bit_pos));
+    }
+
+    void clear_bit(const nrf_register reg, const uint8_t bit_pos) const
+    {
+        NRF24_ASSERT(8 > bit_pos);
+
+        write_bits(reg, static_cast<uint8_t>(1U << bit_pos), 0);
+    }
+
+    /* COMMANDS */
+
+    uint8_t cmd_nop(void) const
+    {
+        return send_cmd(NRF_CMD_NOP);
+    }
+
+    uint8_t cmd_flush_rx(void) const
+    {
+        return send_cmd(NRF_CMD_FLUSH_RX);
+    }
+
+    uint8_t cmd_flush_tx(void) const
+    {
+        return send_cmd(NRF_CMD_FLUSH_TX);
+    }
+
+    uint8_t cmd_reuse_tx_payload(void) const
+    {
+        return send_cmd(NRF_CMD_REUSE_TX_PL);
+    }
+
+    uint8_t cmd_read_rx_payload(uint8_t *payload, const size_t payload_size) const
+    {
+        return send_payload_cmd(NRF_CMD_R_RX_PAYLOAD, NULL, payload, payload_size);
+    }
+
+    uint8_t cmd_write_tx_payload(const uint8_t *payload, const size_t payload_size) const
+    {
+        return send_payload_cmd(NRF_CMD_W_TX_PAYLOAD, payload, NULL, payload_size);
+    }
+
+    uint8_t cmd_payload_without_ack(const uint8_t *payload, const size_t payload_size) const
+    {
+        return send_payload_cmd(NRF_CMD_W_TX_PAYLOAD_NO_ACK, payload, NULL, payload_size);
+    }
+
+    uint8_t cmd_payload_write_ack(const nrf_pipe pipe, const uint8_t *payload,
+        const size_t payload_size) const
+    {
+        return send_payload_cmd(static_cast<uint8_t>(NRF_CMD_W_ACK_PAYLOAD | static_cast<unsigned>(pipe)),
+            payload, NULL, payload_size);
+    }
+
+    uint8_t cmd_read_payload_width(uint8_t *payload_width) const
+    {
+        const uint8_t data_in[2] = {NRF_CMD_R_RX_PL_WID, NRF_CMD_NOP};
+        uint8_t data_out[2];
+
+        Spi::xfer(data_in, data_out, sizeof data_in);
+        *payload_width = data_out[1];
+
+        return data_out[0];
+    }
+
+    /* NRF24 */
+
+    void wakeup(void) const
+    {
+        set_bit(NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
+        Delay::us(NRF_POWER_UP_DELAY_US);
+    }
+
+    void set_power_down_mode(void) const
+    {
+        clear_bit(NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
+    }
+
+    void set_rx_mode(void) const
+    {
+        set_bit(NRF_REG_CONFIG, NRF_CONFIG_BIT_PRIM_RX);
+    }
+
+    void set_tx_mode(void) const
+    {
+        clear_bit(NRF_REG_CONFIG, NRF_CONFIG_BIT_PRIM_RX);
+    }
+
+    void set_channel(uint8_t channel) const
+    {
+        if (NRF_MAX_RF_CHANNEL < channel) {
+            channel = NRF_MAX_RF_CHANNEL;
+        }
+
+        write_reg(NRF_REG_RF_CH, channel);
+        cmd_flush_rx();
+        cmd_flush_tx();
+    }
+
+    uint8_t get_channel(void) const
+    {
+        return read_reg(NRF_REG_RF_CH);
+    }
+
+    void set_auto_retransmit(const uint8_t delay, const uint8_t count) const
+    {
+        NRF24_ASSERT(!(delay & ~NRF_SETUP_RETR_ARD_MASK));
+        NRF24_ASSERT(!(count & ~NRF_SETUP_RETR_ARC_MASK));
+
+        write_reg(NRF_REG_SETUP_RETR, static_cast<uint8_t>(delay | count));
+    }
+
+    void set_data_rate(const uint8_t data_rate) const
+    {
+        NRF24_ASSERT(!(data_rate & ~NRF_RF_SETUP_RF_DR_MASK));
+        NRF24_ASSERT(NRF_RF_SETUP_RF_DR_MASK != data_rate);
+
+        write_bits(NRF_REG_RF_SETUP, NRF_RF_SETUP_RF_DR_MASK, data_rate);
+    }
+
+    void set_pa_level(const uint8_t level) const
+    {
+        NRF24_ASSERT(!(level & ~NRF_RF_SETUP_RF_PWR_MASK));
+
+        write_bits(NRF_REG_RF_SETUP, NRF_RF_SETUP_RF_PWR_MASK, level);
+    }
+
+    /* The size is not checked against SETUP_AW, it would cost a read */
+    void set_tx_address(const uint8_t *addr, const size_t size) const
+    {
+        NRF24_ASSERT(addr);
+
+        write_reg(NRF_REG_TX_ADDR, addr, size);
+    }
+
+    void set_payload_size(const nrf_pld_size pipe, uint8_t size) const
+    {
+        if (NRF_PAYLOAD_SIZE_MAX < size) {
+            size = NRF_PAYLOAD_SIZE_MAX;
+        }
+
+        write_reg(static_cast<nrf_register>(pipe), size);
+    }
+
+    void start_listening(void) const
+    {
+        Ce::write(GPIO_SET);
+        Delay::us(NRF_PLL_SETTLE_DELAY_US);
+    }
+
+    void stop_listening(void) const
+    {
+        Ce::write(GPIO_CLEAR);
+    }
+
+    void transmit_pulse(void) const
+    {
+        Ce::write(GPIO_SET);
+        Delay::us(NRF_CE_PULSE_WIDTH_US);
+        Ce::write(GPIO_CLEAR);
+    }
+
+    uint8_t get_status(void) const
+    {
+        return cmd_nop();
+    }
+
+    uint8_t get_fifo_status(void) const
+    {
+        return read_reg(NRF_REG_FIFO_STATUS);
+    }
+
+    uint8_t get_retransmissions_count(void) const
+    {
+        return read_reg(NRF_REG_OBSERVE_TX) & NRF_OBSERVE_TX_ARC_CNT_MASK;
+    }
+
+    void put_in_tx_fifo(const uint8_t *payload, const size_t payload_size) const
+    {
+        NRF24_ASSERT(payload);
+        NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+        cmd_write_tx_payload(payload, payload_size);
+    }
+
+    void transmit(const uint8_t *payload, const size_t payload_size) const
+    {
+        put_in_tx_fifo(payload, payload_size);
+        transmit_pulse();
+    }
+
+    void tx_transmit_no_ack(const uint8_t *payload, const size_t payload_size) const
+    {
+        NRF24_ASSERT(payload);
+        NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+        cmd_payload_without_ack(payload, payload_size);
+        transmit_pulse();
+    }
+
+    uint8_t is_data_ready(void) const
+    {
+        return static_cast<uint8_t>(NRF_STATUS_RX_DR_MASK & get_status());
+    }
+
+    void get_rx_payload(uint8_t *payload, const size_t payload_size) const
+    {
+        NRF24_ASSERT(payload);
+
+        Ce::write(GPIO_CLEAR);
+        cmd_read_rx_payload(payload, payload_size);
+        Ce::write(GPIO_SET);
+    }
+
+    void clear_all_irqs(void) const
+    {
+        write_reg(NRF_REG_STATUS, NRF_ALL_IRQ_MASK);
+    }
+
+    void clear_irq_flag(const nrf_irq irq_flag) const
+    {
+        write_reg(NRF_REG_STATUS, static_cast<uint8_t>(static_cast<unsigned>(irq_flag) & NRF_ALL_IRQ_MASK));
+    }
+
+    nrf_irq get_irq_flag(void) const
+    {
+        return static_cast<nrf_irq>(NRF_ALL_IRQ_MASK & cmd_nop());
+    }
+
+    /* The IRQ signal is active low */
+    bool irq_asserted(void) const
+    {
+        return GPIO_CLEAR == Irq::read();
+    }
+
+    void flush_rx(void) const
+    {
+        cmd_flush_rx();
+    }
+
+    void flush_tx(void) const
+    {
+        cmd_flush_tx();
+    }
+
+private:
+    uint8_t send_cmd(const nrf_cmd cmd) const
+    {
+        const uint8_t data_in = static_cast<uint8_t>(cmd);
+        uint8_t status;
+
+        Spi::xfer(&data_in, &status, 1);
+        return status;
+    }
+
+    uint8_t send_payload_cmd(const uint8_t cmd, const uint8_t *payload_in,
+        uint8_t *payload_out, const size_t payload_size) const
+    {
+        NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+        uint8_t data_in[NRF_PAYLOAD_SIZE_MAX + 1];
+        uint8_t data_out[NRF_PAYLOAD_SIZE_MAX + 1];
+
+        data_in[0] = cmd;
+
+        for (size_t idx = 0; idx < payload_size; idx++) {
+            data_in[idx + 1] = (NULL != payload_in) ? payload_in[idx] : static_cast<uint8_t>(NRF_CMD_NOP);
+        }
+
+        Spi::xfer(data_in, data_out, payload_size + 1);
+
+        if (NULL != payload_out) {
+            for (size_t idx = 0; idx < payload_size; idx++) {
+                payload_out[idx] = data_out[idx + 1];
+            }
+        }
+
+        return data_out[0];
+    }
+};
+
+} /* namespace nrf24 */
+
+#endif /* NRF24_HPP */
@@ -0,0 +1,144 @@
+/**
+* @file     NRF24_ASYNC.h
+* @version  0.1
+*
+* @brief    Non-blocking operations, define NRF24_ENABLE_ASYNC to use them.
+*
+* The operations start a SPI transfer using the asynchronous SPI callback
+* (see NRF24_set_spi_xfer_async_cb) and return immediately. The user must call
+* NRF24_async_xfer_complete once the transfer is done (i.e. from the DMA ISR),
+* the library then finishes the operation and calls the user done callback.
+*
+* Only one operation can be in progress at a time on each radio, another
+* operation can be started from the done callback.
+*/
+
+#ifndef NRF24_ASYNC_H
+#define NRF24_ASYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+#if defined(NRF24_ENABLE_ASYNC)
+
+/**
+ * @brief Register the asynchronous SPI callback.
+ *
+ * @param[in]	radio:
+ * @param[in]	spi_xfer_async_cb: Asynchronous SPI callback.
+ */
+void NRF24_set_spi_xfer_async_cb(nrf_radio *radio, nrf_spi_xfer_async spi_xfer_async_cb);
+
+/**
+ * @brief Advance the operation in progress.
+ *
+ * Must be called when the transfer started by the asynchronous SPI callback
+ * is done, it can be called from an ISR.
+ *
+ * @param[in]	radio:
+ */
+void NRF24_async_xfer_complete(nrf_radio *radio);
+
+/**
+ * @return Non zero if an operation is in progress, zero otherwise.
+ */
+uint8_t NRF24_async_is_busy(nrf_radio *radio);
+
+/**
+ * @brief Read a register.
+ *
+ * @param[in]	radio:
+ * @param[in]	reg: Register to be read, see @ref nrf_register.
+ * @param[out]	data: Where the content of the register will be stored, must
+ * 				be valid until the operation is done.
+ * @param[in]	data_size: Size (in bytes) of the register and data.
+ * @param[in]	done_cb: Called when the operation is done, can be NULL.
+ * @param[in]	context: Passed to @p done_cb.
+ *
+ * @return 0 if the operation was started, 1 if there is an operation in
+ * progress already.
+ */
+int NRF24_async_read_reg(nrf_radio *radio, const nrf_register reg,
+	uint8_t *data, const size_t data_size, nrf_async_done done_cb, void *context);
+
+/**
+ * @brief Write a register.
+ *
+ * @param[in]	radio:
+ * @param[in]	reg: Register to be written, see @ref nrf_register.
+ * @param[in]	data: Data to be written to the register, it's copied so it
+ * 				can be released after this function returns.
+ * @param[in]	data_size: Size (in bytes) of the register and data.
+ * @param[in]	done_cb: Called when the operation is done, can be NULL.
+ * @param[in]	context: Passed to @p done_cb.
+ *
+ * @return 0 if the operation was started, 1 if there is an operation in
+ * progress already.
+ */
+int NRF24_async_write_reg(nrf_radio *radio, const nrf_register reg,
+	const uint8_t *data, const size_t data_size, nrf_async_done done_cb, void *context);
+
+/**
+ * @brief Put data into the TX FIFO without sending it.
+ *
+ * @param[in]	radio:
+ * @param[in]	payload: Data to be placed in the TX FIFO, it's copied so it
+ * 				can be released after this function returns.
+ * @param[in]	payload_size: Bytes of data.
+ * @param[in]	done_cb: Called when the operation is done, can be NULL.
+ * @param[in]	context: Passed to @p done_cb.
+ *
+ * @return 0 if the operation was started, 1 if there is an operation in
+ * progress already.
+ */
+int NRF24_async_put_in_tx_fifo(nrf_radio *radio, const uint8_t *payload,
+	const size_t payload_size, nrf_async_done done_cb, void *context);
+
+/**
+ * @brief Asynchronous version of NRF24_get_rx_payload.
+ *
+ * Set CE low, read the payload and set CE high again.
+ *
+ * @param[in]	radio:
+ * @param[out]	payload: Where the payload will be stored, must be valid until
+ * 				the operation is done.
+ * @param[in]	payload_size: Bytes of payload to be read.
+ * @param[in]	done_cb: Called when the operation is done, can be NULL.
+ * @param[in]	context: Passed to @p done_cb.
+ *
+ * @return 0 if the operation was started, 1 if there is an operation in
+ * progress already.
+ */
+int NRF24_async_get_rx_payload(nrf_radio *radio, uint8_t *payload,
+	const size_t payload_size, nrf_async_done done_cb, void *context);
+
+/**
+ * @brief Asynchronous version of NRF24_clear_irq_flag.
+ *
+ * Write @p irq_flag to the STATUS register, the other flags are not affected.
+ *
+ * @param[in]	radio:
+ * @param[in]	irq_flag: Interrupt flag to clear.
+ * @param[in]	done_cb: Called when the operation is done, can be NULL.
+ * @param[in]	context: Passed to @p done_cb.
+ *
+ * @return 0 if the operation was started, 1 if there is an operation in
+ * progress already.
+ */
+int NRF24_async_clear_irq_flag(nrf_radio *radio, const nrf_irq irq_flag,
+	nrf_async_done done_cb, void *context);
+
+#endif /* NRF24_ENABLE_ASYNC */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_ASYNC_H */
@@ -0,0 +1,157 @@
+/**
+* @file     NRF24_BATCH.h
+* @version  0.1
+*
+* @brief    Queue several commands and register accesses and send them to the
+* radio at once.
+*
+* Each queued command is still a SPI transaction on its own (the radio needs
+* the chip select to be toggled between commands), but the whole batch is
+* handed to the vectored SPI callback (see NRF24_set_spi_xfer_vec_cb) in a
+* single call, so it can be serviced by i.e. a single DMA chain.
+*
+* The batch doesn't own any memory, the user provides the buffers:
+*
+* @code
+* uint8_t in[8], out[8];
+* nrf_spi_segment segments[3];
+* nrf_batch batch;
+*
+* NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+* NRF24_batch_write_reg(&batch, NRF_REG_RF_CH, &channel, 1);
+* NRF24_batch_cmd(&batch, NRF_CMD_FLUSH_RX);
+* NRF24_batch_cmd(&batch, NRF_CMD_FLUSH_TX);
+* NRF24_batch_submit(&radio, &batch);
+* @endcode
+*/
+
+#ifndef NRF24_BATCH_H
+#define NRF24_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+typedef struct {
+	uint8_t		*in;
+	uint8_t		*out;
+	size_t		buffer_size;
+	size_t		used;
+	nrf_spi_segment	*segments;
+	size_t		max_segments;
+	size_t		count;
+} nrf_batch;
+
+/**
+ * @brief Initialize an empty batch.
+ *
+ * @param[in]	batch:
+ * @param[in]	in: Buffer for the bytes sent to the radio.
+ * @param[in]	out: Buffer for the bytes received from the radio.
+ * @param[in]	buffer_size: Size (in bytes) of @p in and @p out.
+ * @param[in]	segments: One segment per command.
+ * @param[in]	max_segments: Max number of commands on the batch.
+ */
+void NRF24_batch_init(nrf_batch *batch, uint8_t *in, uint8_t *out,
+	const size_t buffer_size, nrf_spi_segment *segments, const size_t max_segments);
+
+/**
+ * @brief Remove all the commands from the batch.
+ *
+ * @param[in]	batch:
+ */
+void NRF24_batch_reset(nrf_batch *batch);
+
+/**
+ * @brief Queue a command without data, i.e. NRF_CMD_FLUSH_TX.
+ *
+ * @param[in]	batch:
+ * @param[in]	cmd: Command, see @ref nrf_cmd.
+ *
+ * @return 0 on success, 1 if there's no room left on the batch.
+ */
+int NRF24_batch_cmd(nrf_batch *batch, const nrf_cmd cmd);
+
+/**
+ * @brief Queue a command followed by data, i.e. NRF_CMD_W_TX_PAYLOAD.
+ *
+ * @param[in]	batch:
+ * @param[in]	cmd: Command byte, for NRF_CMD_W_ACK_PAYLOAD the pipe must be
+ * 				ORed already.
+ * @param[in]	data: Data to be sent after the command, if NULL dummy bytes
+ * 				are sent, use it for reading commands.
+ * @param[in]	data_size: Bytes of data.
+ *
+ * @return 0 on success, 1 if there's no room left on the batch.
+ */
+int NRF24_batch_cmd_with_data(nrf_batch *batch, const uint8_t cmd,
+	const uint8_t *data, const size_t data_size);
+
+/**
+ * @brief Queue a register write.
+ *
+ * @param[in]	batch:
+ * @param[in]	reg: Register to be written, see @ref nrf_register.
+ * @param[in]	data: Data to be written to the register.
+ * @param[in]	data_size: Size (in bytes) of the register and data.
+ *
+ * @return 0 on success, 1 if there's no room left on the batch.
+ */
+int NRF24_batch_write_reg(nrf_batch *batch, const nrf_register reg,
+	const uint8_t *data, const size_t data_size);
+
+/**
+ * @brief Queue a register read.
+ *
+ * The content of the register is available with NRF24_batch_data after
+ * the batch is submitted.
+ *
+ * @param[in]	batch:
+ * @param[in]	reg: Register to be read, see @ref nrf_register.
+ * @param[in]	data_size: Size (in bytes) of the register.
+ *
+ * @return 0 on success, 1 if there's no room left on the batch.
+ */
+int NRF24_batch_read_reg(nrf_batch *batch, const nrf_register reg, const size_t data_size);
+
+/**
+ * @brief Send all the queued commands to the radio.
+ *
+ * The batch is kept, so it can be submitted again.
+ *
+ * @param[in]	radio:
+ * @param[in]	batch:
+ */
+void NRF24_batch_submit(nrf_radio *radio, nrf_batch *batch);
+
+/**
+ * @brief Get the STATUS register returned by a submitted command.
+ *
+ * @param[in]	batch:
+ * @param[in]	idx: Position of the command in the batch, starting at 0.
+ *
+ * @return STATUS register.
+ */
+uint8_t NRF24_batch_status(const nrf_batch *batch, const size_t idx);
+
+/**
+ * @brief Get the data returned by a submitted command (after the STATUS).
+ *
+ * @param[in]	batch:
+ * @param[in]	idx: Position of the command in the batch, starting at 0.
+ *
+ * @return Pointer to the data read, valid until the batch is reused.
+ */
+const uint8_t *NRF24_batch_data(const nrf_batch *batch, const size_t idx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_BATCH_H */
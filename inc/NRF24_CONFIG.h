@@ -0,0 +1,144 @@
+/**
+* @file     NRF24_CONFIG.h
+* @version  0.1
+*
+* @brief    Configure the radio from a register image.
+*
+* Instead of a chain of read-modify-write calls (NRF24_set_channel,
+* NRF24_enable_auto_ack, ...) the whole configuration is described in a
+* nrf_config and written with a single register write per register, the
+* registers are never read back. When the previously applied configuration
+* is given only the registers that changed are written:
+*
+* @code
+* nrf_config config;
+*
+* NRF24_config_defaults(&config);
+* config.config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER;
+* config.rf_ch = 76;
+* config.rx_pw[NRF_PIPE0] = 4;
+* NRF24_config_apply(&radio, &config, NULL);
+*
+* nrf_config next = config;
+* next.rf_ch = 40;
+* NRF24_config_apply(&radio, &next, &config);	// Only writes RF_CH
+* @endcode
+*/
+
+#ifndef NRF24_CONFIG_H
+#define NRF24_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_BATCH.h"
+#include "NRF24_DEFS.h"
+
+enum {
+	NRF_CONFIG_ADDR_SIZE_MAX	= 5,
+	NRF_CONFIG_PIPES		= 6,
+	/* Worst case of NRF24_config_queue, all the registers are written */
+	NRF_CONFIG_MAX_SEGMENTS		= 22,
+	NRF_CONFIG_MAX_XFER_BYTES	= 56,
+	/* Init sequence with all the registers, a size byte per write and the
+	 * terminating 0 */
+	NRF_CONFIG_SEQUENCE_MAX_SIZE	= NRF_CONFIG_MAX_XFER_BYTES + NRF_CONFIG_MAX_SEGMENTS + 1,
+};
+
+/* Value of each register, use the values in NRF24_DEFS.h to build them */
+typedef struct {
+	uint8_t	config;
+	uint8_t	en_aa;
+	uint8_t	en_rxaddr;
+	/* nrf_addr_width, also the number of address bytes written */
+	uint8_t	setup_aw;
+	uint8_t	setup_retr;
+	uint8_t	rf_ch;
+	uint8_t	rf_setup;
+	/* Addresses are LSByte first */
+	uint8_t	rx_addr_p0[NRF_CONFIG_ADDR_SIZE_MAX];
+	uint8_t	rx_addr_p1[NRF_CONFIG_ADDR_SIZE_MAX];
+	/* LSByte of the pipes 2 to 5 addresses, the other bytes are the ones
+	 * of pipe 1 */
+	uint8_t	rx_addr_p2_p5[4];
+	uint8_t	tx_addr[NRF_CONFIG_ADDR_SIZE_MAX];
+	/* Indexed by nrf_pipe */
+	uint8_t	rx_pw[NRF_CONFIG_PIPES];
+	uint8_t	dynpd;
+	uint8_t	feature;
+} nrf_config;
+
+/**
+ * @brief Fill @p config with the reset values of the radio registers.
+ *
+ * @param[out]	config:
+ */
+void NRF24_config_defaults(nrf_config *config);
+
+/**
+ * @brief Write @p config into the radio.
+ *
+ * CONFIG is written last, so the radio is powered up (when PWR_UP is set)
+ * once it's fully configured. The power up delay is done when the radio
+ * wasn't known to be powered up (see NRF24_set_power_state), for what's left
+ * of it.
+ *
+ * @param[in]	radio:
+ * @param[in]	config: Configuration to be applied.
+ * @param[in]	previous: Configuration applied before, only the registers
+ * 				that differ from it are written. NULL to write all of them.
+ *
+ * @return Number of registers written.
+ */
+size_t NRF24_config_apply(nrf_radio *radio, const nrf_config *config,
+	const nrf_config *previous);
+
+/**
+ * @brief Queue the register writes of NRF24_config_apply into @p batch.
+ *
+ * So the configuration can be sent with NRF24_batch_submit, i.e. in a single
+ * DMA chain. No power up delay is done.
+ *
+ * @param[in]	batch: Needs room for NRF_CONFIG_MAX_SEGMENTS commands and
+ * 				NRF_CONFIG_MAX_XFER_BYTES bytes in the worst case.
+ * @param[in]	config: Configuration to be applied.
+ * @param[in]	previous: Configuration applied before, can be NULL.
+ *
+ * @return 0 on success, 1 if there's no room left on the batch.
+ */
+int NRF24_config_queue(nrf_batch *batch, const nrf_config *config,
+	const nrf_config *previous);
+
+/**
+ * @brief Send an init sequence, i.e. one built at compile time with
+ * NRF24_CONFIG.hpp.
+ *
+ * The sequence is a list of register writes, each one is the size of the
+ * SPI transaction followed by its bytes (W_REGISTER command and data), a
+ * size of 0 ends it. Each write is sent as is from @p sequence, so it can be
+ * stored in flash. The power up delay is done when CONFIG powers the radio
+ * up, for what's left of it.
+ *
+ * @param[in]	radio:
+ * @param[in]	sequence: Up to NRF_CONFIG_SEQUENCE_MAX_SIZE bytes.
+ */
+void NRF24_config_replay(nrf_radio *radio, const uint8_t *sequence);
+
+/**
+ * @brief Read the configuration registers of the radio into @p config.
+ *
+ * @param[in]	radio:
+ * @param[out]	config:
+ */
+void NRF24_config_read(nrf_radio *radio, nrf_config *config);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_CONFIG_H */
@@ -0,0 +1,446 @@
+/**
+* @file     NRF24_CONFIG.hpp
+* @version  0.1
+*
+* @brief    Compile time configuration: a constexpr builder of the register
+* image (see NRF24_CONFIG.h) validated against the radio constraints, and
+* the init sequence generated from it (C++14).
+*
+* Each setter checks its arguments and the image is checked as a whole when
+* the sequence is generated (addresses matching the address width, dynamic
+* payloads needing auto ACK, ...). On an invalid setting a function of
+* nrf24::config_error is called, it isn't constexpr so when the sequence is
+* a constexpr variable the build fails with the name of the check (at
+* runtime it's an assert):
+*
+* @code
+* static constexpr uint8_t addr[] = {0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+*
+* static constexpr nrf24::ConfigSequence init = nrf24::config_sequence(
+*     nrf24::Config()
+*         .channel(76)
+*         .rx_address(NRF_PIPE0, addr)
+*         .tx_address(addr)
+*         .pipe(NRF_PIPE0, 4)
+*         .power_up());
+*
+* NRF24_config_replay(&radio, init.bytes);
+* @endcode
+*
+* The sequence writes every register, give the configuration the radio is
+* known to have as @p previous to only write the registers that differ,
+* i.e. nrf24::Config() after a power on reset.
+*/
+
+#ifndef NRF24_CONFIG_HPP
+#define NRF24_CONFIG_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "NRF24.h"
+#include "NRF24_CONFIG.h"
+#include "NRF24_DEFS.h"
+
+namespace nrf24 {
+
+/* Not constexpr on purpose, see the file description */
+namespace config_error {
+
+inline void channel_over_max_rf_channel(void) { NRF24_ASSERT(false); }
+inline void invalid_address_width(void) { NRF24_ASSERT(false); }
+inline void address_size_differs_from_address_width(void) { NRF24_ASSERT(false); }
+inline void pipe_out_of_range(void) { NRF24_ASSERT(false); }
+inline void pipe_has_a_full_address(void) { NRF24_ASSERT(false); }
+inline void payload_size_over_32(void) { NRF24_ASSERT(false); }
+inline void invalid_crc_size(void) { NRF24_ASSERT(false); }
+inline void invalid_auto_retransmit(void) { NRF24_ASSERT(false); }
+inline void invalid_data_rate(void) { NRF24_ASSERT(false); }
+inline void invalid_pa_level(void) { NRF24_ASSERT(false); }
+inline void dynamic_payload_without_auto_ack(void) { NRF24_ASSERT(false); }
+inline void ack_payload_without_dynamic_payload(void) { NRF24_ASSERT(false); }
+inline void rx_pipe_without_payload_size(void) { NRF24_ASSERT(false); }
+
+} /* namespace config_error */
+
+class Config {
+public:
+    /* Reset values of the registers, see NRF24_config_defaults */
+    constexpr Config() : image_(), rx_addr_size_(), tx_addr_size_(0), pipes_(0)
+    {
+        image_.config = NRF_CONFIG_ENABLE_CRC;
+        image_.en_aa = NRF_ENABLE_AUTO_ACK_PIPE0 | NRF_ENABLE_AUTO_ACK_PIPE1 |
+            NRF_ENABLE_AUTO_ACK_PIPE2 | NRF_ENABLE_AUTO_ACK_PIPE3 |
+            NRF_ENABLE_AUTO_ACK_PIPE4 | NRF_ENABLE_AUTO_ACK_PIPE5;
+        image_.en_rxaddr = NRF_ENABLE_PIPE0 | NRF_ENABLE_PIPE1;
+        image_.setup_aw = NRF_SETUP_AW_5BYTES;
+        image_.setup_retr = static_cast<unsigned>(NRF_AUTO_RETRANSMIT_DELAY_250_US) |
+            NRF_AUTO_RETRANSMIT_CNT_3;
+        image_.rf_ch = 2;
+        image_.rf_setup = static_cast<unsigned>(NRF_RF_SETUP_RF_DR_2000) | NRF_RF_SETUP_RF_PWR_0;
+
+        for (size_t idx = 0; idx < NRF_CONFIG_ADDR_SIZE_MAX; idx++) {
+            image_.rx_addr_p0[idx] = 0xE7;
+            image_.rx_addr_p1[idx] = 0xC2;
+            image_.tx_addr[idx] = 0xE7;
+        }
+
+        for (size_t idx = 0; idx < sizeof image_.rx_addr_p2_p5; idx++) {
+            image_.rx_addr_p2_p5[idx] = static_cast<uint8_t>(0xC3 + idx);
+        }
+    }
+
+    constexpr Config power_up(const bool enable = true) const
+    {
+        Config next = *this;
+        next.set_bits(next.image_.config, NRF_CONFIG_PWR_UP, enable);
+        return next;
+    }
+
+    constexpr Config receiver(const bool enable = true) const
+    {
+        Config next = *this;
+        next.set_bits(next.image_.config, NRF_CONFIG_RECEIVER, enable);
+        return next;
+    }
+
+    /* 0 (disabled), 1 or 2 bytes */
+    constexpr Config crc(const uint8_t bytes) const
+    {
+        if (2 < bytes) {
+            config_error::invalid_crc_size();
+        }
+
+        Config next = *this;
+        next.set_bits(next.image_.config, NRF_CONFIG_ENABLE_CRC, 0 != bytes);
+        next.set_bits(next.image_.config, NRF_CONFIG_2_BYTE_CRC, 2 == bytes);
+        return next;
+    }
+
+    constexpr Config channel(const uint8_t channel) const
+    {
+        if (NRF_MAX_RF_CHANNEL < channel) {
+            config_error::channel_over_max_rf_channel();
+        }
+
+        Config next = *this;
+        next.image_.rf_ch = channel;
+        return next;
+    }
+
+    constexpr Config address_width(const nrf_pipe_addr_width width) const
+    {
+        if ((NRF_PIPE_ADDR_WIDTH_3BYTES > width) || (NRF_PIPE_ADDR_WIDTH_5BYTES < width)) {
+            config_error::invalid_address_width();
+        }
+
+        Config next = *this;
+        /* SETUP_AW: 01b - 3 bytes, 10b - 4 bytes, 11b - 5 bytes */
+        next.image_.setup_aw = static_cast<uint8_t>(width - 2);
+        return next;
+    }
+
+    /* Full address of pipe 0 or 1, LSByte first */
+    template <size_t N>
+    constexpr Config rx_address(const nrf_pipe pipe, const uint8_t (&addr)[N]) const
+    {
+        static_assert((NRF_PIPE_ADDR_WIDTH_3BYTES <= N) && (NRF_PIPE_ADDR_WIDTH_5BYTES >= N),
+            "Addresses are 3 to 5 bytes");
+
+        if (NRF_PIPE1 < pipe) {
+            config_error::pipe_out_of_range();
+        }
+
+        Config next = *this;
+        uint8_t *dst = (NRF_PIPE0 == pipe) ? next.image_.rx_addr_p0 : next.image_.rx_addr_p1;
+
+        for (size_t idx = 0; idx < N; idx++) {
+            dst[idx] = addr[idx];
+        }
+
+        next.rx_addr_size_[pipe] = N;
+        return next;
+    }
+
+    /* LSByte of the address of pipes 2 to 5, the other bytes are the ones of pipe 1 */
+    constexpr Config rx_address(const nrf_pipe pipe, const uint8_t lsb) const
+    {
+        if (NRF_PIPE2 > pipe) {
+            config_error::pipe_has_a_full_address();
+        }
+
+        if (NRF_PIPE5 < pipe) {
+            config_error::pipe_out_of_range();
+        }
+
+        Config next = *this;
+        next.image_.rx_addr_p2_p5[pipe - NRF_PIPE2] = lsb;
+        return next;
+    }
+
+    template <size_t N>
+    constexpr Config tx_address(const uint8_t (&addr)[N]) const
+    {
+        static_assert((NRF_PIPE_ADDR_WIDTH_3BYTES <= N) && (NRF_PIPE_ADDR_WIDTH_5BYTES >= N),
+            "Addresses are 3 to 5 bytes");
+
+        Config next = *this;
+
+        for (size_t idx = 0; idx < N; idx++) {
+            next.image_.tx_addr[idx] = addr[idx];
+        }
+
+        next.tx_addr_size_ = N;
+        return next;
+    }
+
+    /* Enable the pipe, @p payload_size is ignored with dynamic payloads */
+    constexpr Config pipe(const nrf_pipe pipe, const uint8_t payload_size,
+        const bool auto_ack = true) const
+    {
+        check_pipe(pipe);
+
+        if (NRF_PAYLOAD_SIZE_MAX < payload_size) {
+            config_error::payload_size_over_32();
+        }
+
+        Config next = *this;
+        next.set_bits(next.image_.en_rxaddr, static_cast<uint8_t>(1U << pipe), true);
+        next.set_bits(next.image_.en_aa, static_cast<uint8_t>(1U << pipe), auto_ack);
+        next.image_.rx_pw[pipe] = payload_size;
+        next.set_bits(next.pipes_, static_cast<uint8_t>(1U << pipe), true);
+        return next;
+    }
+
+    constexpr Config disable_pipe(const nrf_pipe pipe) const
+    {
+        check_pipe(pipe);
+
+        Config next = *this;
+        next.set_bits(next.image_.en_rxaddr, static_cast<uint8_t>(1U << pipe), false);
+        return next;
+    }
+
+    constexpr Config dynamic_payload(const nrf_pipe pipe) const
+    {
+        check_pipe(pipe);
+
+        Config next = *this;
+        next.set_bits(next.image_.dynpd, static_cast<uint8_t>(1U << pipe), true);
+        next.set_bits(next.image_.feature, NRF_ENABLE_DYN_PAYLOAD_LEN, true);
+        return next;
+    }
+
+    constexpr Config ack_payload(void) const
+    {
+        Config next = *this;
+        next.set_bits(next.image_.feature, NRF_ENABLE_PAYLOAD_WITH_ACK, true);
+        return next;
+    }
+
+    constexpr Config dynamic_ack(void) const
+    {
+        Config next = *this;
+        next.set_bits(next.image_.feature, NRF_ENABLE_W_TX_PAYLOAD_CMD, true);
+        return next;
+    }
+
+    /* NRF_AUTO_RETRANSMIT_DELAY_x and NRF_AUTO_RETRANSMIT_CNT_x */
+    constexpr Config auto_retransmit(const uint8_t delay, const uint8_t count) const
+    {
+        if ((delay & ~NRF_SETUP_RETR_ARD_MASK) || (count & ~NRF_SETUP_RETR_ARC_MASK)) {
+            config_error::invalid_auto_retransmit();
+        }
+
+        Config next = *this;
+        next.image_.setup_retr = static_cast<uint8_t>(delay | count);
+        return next;
+    }
+
+    /* NRF_RF_SETUP_RF_DR_x */
+    constexpr Config data_rate(const uint8_t data_rate) const
+    {
+        if ((data_rate & ~NRF_RF_SETUP_RF_DR_MASK) || (NRF_RF_SETUP_RF_DR_MASK == data_rate)) {
+            config_error::invalid_data_rate();
+        }
+
+        Config next = *this;
+        next.image_.rf_setup = static_cast<uint8_t>((next.image_.rf_setup & ~NRF_RF_SETUP_RF_DR_MASK) | data_rate);
+        return next;
+    }
+
+    /* NRF_RF_SETUP_RF_PWR_x */
+    constexpr Config pa_level(const uint8_t level) const
+    {
+        if (level & ~NRF_RF_SETUP_RF_PWR_MASK) {
+            config_error::invalid_pa_level();
+        }
+
+        Config next = *this;
+        next.image_.rf_setup = static_cast<uint8_t>((next.image_.rf_setup & ~NRF_RF_SETUP_RF_PWR_MASK) | level);
+        return next;
+    }
+
+    /* Checks the settings that depend on each other */
+    constexpr void validate(void) const
+    {
+        const size_t addr_size = static_cast<size_t>(image_.setup_aw) + 2;
+
+        for (size_t pipe = 0; pipe < 2; pipe++) {
+            if ((0 != rx_addr_size_[pipe]) && (addr_size != rx_addr_size_[pipe])) {
+                config_error::address_size_differs_from_address_width();
+            }
+        }
+
+        if ((0 != tx_addr_size_) && (addr_size != tx_addr_size_)) {
+            config_error::address_size_differs_from_address_width();
+        }
+
+        if (image_.dynpd & ~image_.en_aa) {
+            config_error::dynamic_payload_without_auto_ack();
+        }
+
+        if ((image_.feature & NRF_ENABLE_PAYLOAD_WITH_ACK) &&
+            !(image_.feature & NRF_ENABLE_DYN_PAYLOAD_LEN)) {
+            config_error::ack_payload_without_dynamic_payload();
+        }
+
+        if (!(image_.config & NRF_CONFIG_RECEIVER)) {
+            return;
+        }
+
+        /* Only the pipes given to pipe(), pipe 1 is enabled with RX_PW 0
+         * after reset */
+        for (size_t pipe = 0; pipe < NRF_CONFIG_PIPES; pipe++) {
+            const uint8_t mask = static_cast<uint8_t>(1U << pipe);
+
+            if ((pipes_ & image_.en_rxaddr & mask) && !(image_.dynpd & mask) &&
+                (0 == image_.rx_pw[pipe])) {
+                config_error::rx_pipe_without_payload_size();
+            }
+        }
+    }
+
+    constexpr nrf_config image(void) const
+    {
+        validate();
+        return image_;
+    }
+
+private:
+    nrf_config	image_;
+    /* Size of the addresses given, 0 for the reset value */
+    size_t		rx_addr_size_[2];
+    size_t		tx_addr_size_;
+    /* Pipes given to pipe() */
+    uint8_t		pipes_;
+
+    static constexpr void check_pipe(const nrf_pipe pipe)
+    {
+        if (NRF_PIPE5 < pipe) {
+            config_error::pipe_out_of_range();
+        }
+    }
+
+    static constexpr void set_bits(uint8_t &reg, const uint8_t mask, const bool set)
+    {
+        reg = static_cast<uint8_t>(set ? (reg | mask) : (reg & ~mask));
+    }
+};
+
+/* Register writes to send, see NRF24_config_replay */
+struct ConfigSequence {
+    uint8_t	bytes[NRF_CONFIG_SEQUENCE_MAX_SIZE];
+    /* Bytes used, including the terminating 0 */
+    size_t	size;
+    /* Registers written */
+    size_t	writes;
+};
+
+namespace detail {
+
+constexpr void config_write(ConfigSequence &sequence, const nrf_register reg,
+    const uint8_t *data, const uint8_t *previous, const size_t size, const bool force)
+{
+    bool changed = force;
+
+    for (size_t idx = 0; !changed && (idx < size); idx++) {
+        changed = data[idx] != previous[idx];
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    sequence.bytes[sequence.size++] = static_cast<uint8_t>(size + 1);
+    sequence.bytes[sequence.size++] = static_cast<uint8_t>(NRF_CMD_W_REGISTER | static_cast<unsigned>(reg));
+
+    for (size_t idx = 0; idx < size; idx++) {
+        sequence.bytes[sequence.size++] = data[idx];
+    }
+
+    sequence.writes++;
+}
+
+/* Same order as NRF24_config_apply */
+constexpr ConfigSequence config_sequence(const nrf_config &config, const nrf_config &previous,
+    const bool all)
+{
+    ConfigSequence sequence = {};
+    const size_t addr_size = static_cast<size_t>(config.setup_aw) + 2;
+    /* The addresses are written again with the new width */
+    const bool addr_all = all || (config.setup_aw != previous.setup_aw);
+
+    config_write(sequence, NRF_REG_SETUP_AW, &config.setup_aw, &previous.setup_aw, 1, all);
+    config_write(sequence, NRF_REG_EN_AA, &config.en_aa, &previous.en_aa, 1, all);
+    config_write(sequence, NRF_REG_EN_RXADDR, &config.en_rxaddr, &previous.en_rxaddr, 1, all);
+    config_write(sequence, NRF_REG_SETUP_RETR, &config.setup_retr, &previous.setup_retr, 1, all);
+    config_write(sequence, NRF_REG_RF_CH, &config.rf_ch, &previous.rf_ch, 1, all);
+    config_write(sequence, NRF_REG_RF_SETUP, &config.rf_setup, &previous.rf_setup, 1, all);
+    config_write(sequence, NRF_REG_RX_ADDR_P0, config.rx_addr_p0, previous.rx_addr_p0,
+        addr_size, addr_all);
+    config_write(sequence, NRF_REG_RX_ADDR_P1, config.rx_addr_p1, previous.rx_addr_p1,
+        addr_size, addr_all);
+
+    for (size_t idx = 0; idx < sizeof config.rx_addr_p2_p5; idx++) {
+        config_write(sequence, static_cast<nrf_register>(NRF_REG_RX_ADDR_P2 + idx),
+            &config.rx_addr_p2_p5[idx], &previous.rx_addr_p2_p5[idx], 1, all);
+    }
+
+    config_write(sequence, NRF_REG_TX_ADDR, config.tx_addr, previous.tx_addr,
+        addr_size, addr_all);
+
+    for (size_t idx = 0; idx < NRF_CONFIG_PIPES; idx++) {
+        config_write(sequence, static_cast<nrf_register>(NRF_REG_RX_PW_P0 + idx),
+            &config.rx_pw[idx], &previous.rx_pw[idx], 1, all);
+    }
+
+    config_write(sequence, NRF_REG_FEATURE, &config.feature, &previous.feature, 1, all);
+    config_write(sequence, NRF_REG_DYNPD, &config.dynpd, &previous.dynpd, 1, all);
+    config_write(sequence, NRF_REG_CONFIG, &config.config, &previous.config, 1, all);
+
+    /* Terminating 0, already there */
+    sequence.size++;
+
+    return sequence;
+}
+
+} /* namespace detail */
+
+/* Writes every register */
+constexpr ConfigSequence config_sequence(const Config &config)
+{
+    const nrf_config image = config.image();
+
+    return detail::config_sequence(image, image, true);
+}
+
+/* Only writes the registers that differ from @p previous */
+constexpr ConfigSequence config_sequence(const Config &config, const Config &previous)
+{
+    return detail::config_sequence(config.image(), previous.image(), false);
+}
+
+} /* namespace nrf24 */
+
+#endif /* NRF24_CONFIG_HPP */
@@ -0,0 +1,470 @@
+/**
+* @file     NRF24_CORO.hpp
+* @version  0.1
+*
+* @brief    C++20 coroutines on top of the non-blocking operations (see
+* NRF24_ASYNC.h), define NRF24_ENABLE_ASYNC to use them.
+*
+* A nrf24::CoRadio wraps a nrf_radio set up with an asynchronous SPI
+* callback. Its operations are awaitable, the coroutine is suspended while
+* the SPI transfer or the radio is busy and resumed by the nrf24::Executor
+* once NRF24_async_xfer_complete (SPI done) or CoRadio::notify_irq (IRQ
+* asserted) is called:
+*
+* @code
+* nrf24::Executor executor;
+* nrf24::CoRadio radio(&nrf, executor);
+*
+* nrf24::Task<> sender(nrf24::CoRadio &radio)
+* {
+*     const uint8_t payload[4] = {0};
+*
+*     for (;;) {
+*         const nrf_irq result = co_await radio.send(payload);
+*         ...
+*     }
+* }
+*
+* executor.spawn(sender(radio));
+* for (;;) {
+*     executor.run();
+*     wait_for_event();	// DMA done -> NRF24_async_xfer_complete,
+*     			// IRQ falling edge -> radio.notify_irq()
+* }
+* @endcode
+*
+* Several radios and tasks share one executor (and one thread). Only one
+* operation can be in progress on each radio, i.e. one task per radio or
+* tasks taking turns. The executor isn't interrupt safe: from an ISR set a
+* flag and call NRF24_async_xfer_complete and notify_irq from the executor
+* loop.
+*
+* The coroutine frames are allocated with operator new.
+*/
+
+#ifndef NRF24_CORO_HPP
+#define NRF24_CORO_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <coroutine>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "NRF24.h"
+#include "NRF24_ASYNC.h"
+#include "NRF24_DEFS.h"
+#include "NRF24_HAL.h"
+
+#if defined(NRF24_ENABLE_ASYNC)
+
+/* Coroutines ready to run the executor can hold */
+#ifndef NRF24_CORO_READY_MAX
+#define NRF24_CORO_READY_MAX	16
+#endif
+
+namespace nrf24 {
+
+/* Single threaded FIFO run queue */
+class Executor {
+public:
+    Executor() : head_(0), count_(0) {}
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    void post(std::coroutine_handle<> handle)
+    {
+        NRF24_ASSERT(NRF24_CORO_READY_MAX > count_);
+
+        ready_[(head_ + count_) % NRF24_CORO_READY_MAX] = handle;
+        count_++;
+    }
+
+    /* Start a task, it's destroyed once done */
+    template <class TaskType>
+    void spawn(TaskType task)
+    {
+        post(task.detach());
+    }
+
+    /* Resume one coroutine, false if none was ready */
+    bool run_once(void)
+    {
+        if (0 == count_) {
+            return false;
+        }
+
+        std::coroutine_handle<> handle = ready_[head_];
+
+        head_ = (head_ + 1) % NRF24_CORO_READY_MAX;
+        count_--;
+        handle.resume();
+
+        return true;
+    }
+
+    /* Resume coroutines until none is ready, returns how many were resumed */
+    size_t run(void)
+    {
+        size_t resumed = 0;
+
+        while (run_once()) {
+            resumed++;
+        }
+
+        return resumed;
+    }
+
+    bool idle(void) const
+    {
+        return 0 == count_;
+    }
+
+private:
+    std::coroutine_handle<>	ready_[NRF24_CORO_READY_MAX];
+    size_t			head_;
+    size_t			count_;
+};
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<>	continuation;
+    bool			detached = false;
+
+    std::suspend_always initial_suspend(void) noexcept
+    {
+        return {};
+    }
+
+    /* Resume the awaiting coroutine, or free a detached task */
+    struct FinalAwaiter {
+        bool await_ready(void) noexcept
+        {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            PromiseBase &promise = handle.promise();
+
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+
+            if (promise.detached) {
+                handle.destroy();
+            }
+
+            return std::noop_coroutine();
+        }
+
+        void await_resume(void) noexcept {}
+    };
+
+    FinalAwaiter final_suspend(void) noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception(void)
+    {
+        NRF24_ASSERT(false);
+    }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+    T value{};
+
+    void return_value(T result)
+    {
+        value = std::move(result);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    void return_void(void) {}
+};
+
+} /* namespace detail */
+
+/* Lazy coroutine, started when awaited or spawned on the executor */
+template <class T = void>
+class Task {
+public:
+    struct promise_type : detail::Promise<T> {
+        Task get_return_object(void)
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready(void) const noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume(void)
+    {
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(handle_.promise().value);
+        }
+    }
+
+    /* Hand the coroutine over to the executor, see Executor::spawn */
+    std::coroutine_handle<> detach(void)
+    {
+        handle_.promise().detached = true;
+        return std::exchange(handle_, nullptr);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type>	handle_;
+};
+
+class CoRadio {
+public:
+    /* The async SPI callback must be registered on @p radio */
+    CoRadio(nrf_radio *radio, Executor &executor)
+        : radio_(radio), executor_(executor), irq_waiter_(), irq_pending_(false)
+    {
+        NRF24_ASSERT(radio);
+        NRF24_ASSERT(radio->spi_xfer_async_cb);
+    }
+
+    CoRadio(const CoRadio &) = delete;
+    CoRadio &operator=(const CoRadio &) = delete;
+
+    nrf_radio *radio(void) const
+    {
+        return radio_;
+    }
+
+    /* Awaiting any of the operations gives the STATUS register clocked
+     * out while the command was sent */
+    template <class Start>
+    class Operation {
+    public:
+        Operation(CoRadio &radio, Start start) : radio_(radio), start_(start), status_(0) {}
+
+        bool await_ready(void) const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            handle_ = handle;
+
+            /* The done callback may run before this returns, it only posts
+             * the coroutine so that's fine */
+            const int busy = start_(radio_.radio_, &Operation::done, this);
+
+            NRF24_ASSERT(!busy);
+            (void) busy;
+        }
+
+        uint8_t await_resume(void) const noexcept
+        {
+            return status_;
+        }
+
+    private:
+        CoRadio			&radio_;
+        Start			start_;
+        std::coroutine_handle<>	handle_;
+        uint8_t			status_;
+
+        static void done(nrf_radio *radio, uint8_t status, void *context)
+        {
+            Operation *operation = static_cast<Operation *>(context);
+
+            (void) radio;
+            operation->status_ = status;
+            operation->radio_.executor_.post(operation->handle_);
+        }
+    };
+
+    auto read_reg(const nrf_register reg, uint8_t *data, const size_t data_size)
+    {
+        return operation([=](nrf_radio *radio, nrf_async_done done, void *context) {
+            return NRF24_async_read_reg(radio, reg, data, data_size, done, context);
+        });
+    }
+
+    auto write_reg(const nrf_register reg, const uint8_t *data, const size_t data_size)
+    {
+        return operation([=](nrf_radio *radio, nrf_async_done done, void *context) {
+            return NRF24_async_write_reg(radio, reg, data, data_size, done, context);
+        });
+    }
+
+    auto put_in_tx_fifo(std::span<const uint8_t> payload)
+    {
+        return operation([=](nrf_radio *radio, nrf_async_done done, void *context) {
+            return NRF24_async_put_in_tx_fifo(radio, payload.data(), payload.size(),
+                done, context);
+        });
+    }
+
+    auto get_rx_payload(std::span<uint8_t> payload)
+    {
+        return operation([=](nrf_radio *radio, nrf_async_done done, void *context) {
+            return NRF24_async_get_rx_payload(radio, payload.data(), payload.size(),
+                done, context);
+        });
+    }
+
+    auto clear_irq_flag(const nrf_irq irq_flag)
+    {
+        return operation([=](nrf_radio *radio, nrf_async_done done, void *context) {
+            return NRF24_async_clear_irq_flag(radio, irq_flag, done, context);
+        });
+    }
+
+    /* Ready right away when the IRQ pin is asserted (if there's an IRQ
+     * callback) or notify_irq was called while nobody was waiting */
+    class IrqAwaiter {
+    public:
+        explicit IrqAwaiter(CoRadio &radio) : radio_(radio) {}
+
+        bool await_ready(void) const
+        {
+            if (radio_.irq_pending_) {
+                radio_.irq_pending_ = false;
+                return true;
+            }
+
+            return (NULL != radio_.radio_->read_irq_cb) &&
+                (GPIO_CLEAR == NRF24_hal_get_irq(radio_.radio_));
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            NRF24_ASSERT(!radio_.irq_waiter_);
+
+            radio_.irq_waiter_ = handle;
+        }
+
+        void await_resume(void) const noexcept {}
+
+    private:
+        CoRadio	&radio_;
+    };
+
+    IrqAwaiter wait_irq(void)
+    {
+        return IrqAwaiter(*this);
+    }
+
+    /* Call it when the IRQ pin is asserted (falling edge) */
+    void notify_irq(void)
+    {
+        if (!irq_waiter_) {
+            irq_pending_ = true;
+            return;
+        }
+
+        executor_.post(std::exchange(irq_waiter_, nullptr));
+    }
+
+    /**
+     * NRF24_transmit, then wait for the end of the transmission.
+     *
+     * Returns NRF_TX_DS_IRQ or NRF_MAX_RT_IRQ (the payload is still on the
+     * TX FIFO then, as with NRF24_transmit), the flag is cleared. RX_DR is
+     * left for receive.
+     *
+     * The CE pulse (10us) is a busy wait on the executor thread, the
+     * microseconds delay callback is required so it doesn't fall back to
+     * a 1ms delay.
+     */
+    Task<nrf_irq> send(std::span<const uint8_t> payload)
+    {
+        const uint8_t tx_irqs = NRF_STATUS_TX_DS_MASK | NRF_STATUS_MAX_RT_MASK;
+        uint8_t status = 0;
+
+        NRF24_ASSERT(radio_->delay_us_cb);
+
+        co_await put_in_tx_fifo(payload);
+        NRF24_transmit_pulse(radio_);
+
+        do {
+            co_await wait_irq();
+            status = co_await clear_irq_flag(static_cast<nrf_irq>(tx_irqs));
+        } while (!(status & tx_irqs));
+
+        co_return static_cast<nrf_irq>(status & tx_irqs);
+    }
+
+    /**
+     * Wait for a packet and read it with NRF24_get_rx_payload semantics,
+     * @p payload sets the number of bytes read.
+     *
+     * Returns the pipe the packet was received on. RX_DR is cleared once
+     * the payload is read, the packets already in the RX FIFO are read
+     * without waiting for the IRQ.
+     */
+    Task<uint8_t> receive(std::span<uint8_t> payload)
+    {
+        for (;;) {
+            uint8_t fifo_status = 0;
+            const uint8_t status = co_await read_reg(NRF_REG_FIFO_STATUS, &fifo_status, 1);
+
+            if (!(fifo_status & NRF_FIFO_STATUS_RX_EMPTY)) {
+                const uint8_t pipe = static_cast<uint8_t>(
+                    (status & NRF_STATUS_PIPES_MASK) >> NRF_STATUS_PIPES_SHIFT);
+
+                co_await get_rx_payload(payload);
+                co_await clear_irq_flag(NRF_RX_DR_IRQ);
+                co_return pipe;
+            }
+
+            co_await wait_irq();
+        }
+    }
+
+private:
+    nrf_radio			*radio_;
+    Executor			&executor_;
+    std::coroutine_handle<>	irq_waiter_;
+    bool			irq_pending_;
+
+    template <class Start>
+    Operation<Start> operation(Start start)
+    {
+        return Operation<Start>(*this, start);
+    }
+};
+
+} /* namespace nrf24 */
+
+#endif /* NRF24_ENABLE_ASYNC */
+
+#endif /* NRF24_CORO_HPP */
@@ -97,6 +97,16 @@ typedef enum{
     NRF_MODE_RX = 1,
 } nrf_mode;
 
+/* Power and operating states, see NRF24_set_power_state */
+typedef enum {
+    NRF_STATE_UNKNOWN       = 0,
+    NRF_STATE_POWER_DOWN    = 1,
+    NRF_STATE_STANDBY_I     = 2,
+    NRF_STATE_STANDBY_II    = 3,
+    NRF_STATE_RX            = 4,
+    NRF_STATE_TX            = 5,
+} nrf_power_state;
+
 // CONFIG: Configuration Register
 enum {
     NRF_CONFIG_BIT_PRIM_RX      = 0,
@@ -195,6 +205,11 @@ enum {
     NRF_SETUP_RETR_BIT_ARD  = 4,
 };
 
+enum {
+    NRF_SETUP_RETR_ARC_MASK = 0x0F,
+    NRF_SETUP_RETR_ARD_MASK = 0xF0,
+};
+
 enum {
     NRF_AUTO_RETRANSMIT_CNT_0   = (0x00 << NRF_SETUP_RETR_BIT_ARC),
     NRF_AUTO_RETRANSMIT_CNT_1   = (0x01 << NRF_SETUP_RETR_BIT_ARC),
@@ -245,6 +260,11 @@ enum {
     NRF_RF_SETUP_BIT_CONT_WAVE  = 7,
 };
 
+enum {
+    NRF_RF_SETUP_RF_DR_MASK     = 0x28,
+    NRF_RF_SETUP_RF_PWR_MASK    = 0x06,
+};
+
 enum {
     NRF_RF_SETUP_RF_DR_1000 = 0,
     NRF_RF_SETUP_RF_DR_2000 = 8,
@@ -268,6 +288,7 @@ enum {
 };
 
 enum {
+    NRF_STATUS_TX_FULL_MASK = 0x01,
     NRF_STATUS_MAX_RT_MASK  = 0x10,
     NRF_STATUS_TX_DS_MASK   = 0x20,
     NRF_STATUS_RX_DR_MASK   = 0x40,
@@ -379,6 +400,15 @@ enum {
 enum {
     NRF_STATUS_PIPES_SHIFT  = 1,
     NRF_CE_PULSE_WIDTH_US   = 15,
+    /* Thce, minimum CE high time to send a packet */
+    NRF_CE_HIGH_MIN_US      = 10,
+    NRF_PLL_SETTLE_DELAY_US = 130,
+    NRF_RPD_DELAY_US        = 40,
+    NRF_POWER_UP_DELAY_US   = 1500,
+    /* A payload ends in TX_DS or MAX_RT within 16 attempts 4ms apart */
+    NRF_TX_TIMEOUT_US       = 100000,
+    /* Same without the timestamp callback, each poll is an SPI transaction */
+    NRF_TX_TIMEOUT_POLLS    = 100000,
     NRF_PAYLOAD_SIZE_MAX    = 32,
     NRF_POWER_UP_DELAY_MS   = 100,
     NRF_MAX_RF_CHANNEL      = 125,
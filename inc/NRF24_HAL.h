@@ -9,11 +9,18 @@ extern "C" {
 #endif
 
 #include "NRF24.h"
+#include "NRF24_STATS.h"
+#include "NRF24_TRACE.h"
 
 void NRF24_hal_spi_xfer(nrf_radio *radio, const void *send, void *rcv, size_t xfer_len);
+void NRF24_hal_spi_xfer_vec(nrf_radio *radio, const nrf_spi_segment *segments, size_t count);
+uint8_t NRF24_hal_spi_xfer_sg(nrf_radio *radio, const uint8_t cmd,
+	const uint8_t *in, uint8_t *out, size_t xfer_len);
 void NRF24_hal_set_ce(nrf_radio *radio, nrf_gpio state);
 nrf_gpio NRF24_hal_get_irq(nrf_radio *radio);
 void NRF24_hal_delay(nrf_radio *radio, uint32_t ms);
+void NRF24_hal_delay_us(nrf_radio *radio, uint32_t us);
+uint32_t NRF24_hal_time_us(nrf_radio *radio);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,131 @@
+/**
+* @file     NRF24_HOP.h
+* @version  0.1
+*
+* @brief    Frequency hopping: a pseudo-random hop sequence shared by both
+* ends of the link and a scheduler changing the channel every dwell time.
+*
+* Both ends build the same sequence from the same channel list and seed
+* (NRF24_hop_sequence). Time is divided in slots of dwell_us, slot N uses
+* the channel sequence[N % length], the slot is computed from the timestamp
+* callback (see NRF24_set_time_us_cb) so a hopper serviced late jumps
+* straight to the right channel instead of replaying the hops it missed.
+*
+* The clocks of the two ends are aligned with NRF24_hop_resync, i.e. the
+* receiver calls it when it gets a packet the transmitter sent at the start
+* of a slot. When the receiver didn't resync for sync_timeout_us it stops
+* hopping and waits on its current channel, the transmitter visits it once
+* per sequence cycle so the link is recovered within a cycle.
+*
+* A listening receiver only tunes to the new channel on a CE rising edge, so
+* every hop on it pulses CE and blocks for the PLL settling (130us), see
+* NRF24_change_channel:
+*
+* @code
+* static const uint8_t channels[] = {3, 17, 29, 40, 52, 64, 77, 81};
+* static uint8_t sequence[NRF_ARRAY_SIZE(channels)];
+* nrf_hop hop;
+*
+* NRF24_set_time_us_cb(&radio, board_time_us);
+* NRF24_hop_sequence(sequence, channels, NRF_ARRAY_SIZE(channels), 0xC0FFEE);
+* NRF24_hop_init(&hop, sequence, NRF_ARRAY_SIZE(sequence), 20000, 0);
+*
+* for (;;) {
+*     NRF24_hop_service(&radio, &hop);
+*     ...
+* }
+* @endcode
+*/
+
+#ifndef NRF24_HOP_H
+#define NRF24_HOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+/* No channel selected yet */
+#define NRF_HOP_NONE	((size_t) -1)
+
+typedef struct {
+	const uint8_t	*sequence;
+	size_t		length;
+	uint32_t	dwell_us;
+	/* Start of slot 0, moved forward a whole cycle at a time */
+	uint32_t	epoch;
+	/* Slot whose channel is on the radio */
+	size_t		slot;
+	/* 0 to hop forever (i.e. on the transmitter) */
+	uint32_t	sync_timeout_us;
+	uint32_t	last_sync;
+	/* Set by the first service or resync */
+	uint8_t		started;
+	/* Stopped by the sync timeout */
+	uint8_t		searching;
+} nrf_hop;
+
+/**
+ * @brief Build a hop sequence, a pseudo-random permutation of @p channels.
+ *
+ * The same @p channels and @p seed give the same sequence on every
+ * platform.
+ *
+ * @param[out]	sequence: @p count channels.
+ * @param[in]	channels: Channels to hop on, i.e. the quietest ones found
+ * 				with NRF24_scan_quietest.
+ * @param[in]	count: Number of channels.
+ * @param[in]	seed: Shared by both ends of the link.
+ */
+void NRF24_hop_sequence(uint8_t *sequence, const uint8_t *channels, const size_t count,
+	const uint32_t seed);
+
+/**
+ * @brief Initialize the hopper.
+ *
+ * @param[in]	hop:
+ * @param[in]	sequence: Hop sequence, must be valid while the hopper is used.
+ * @param[in]	length: Number of channels of @p sequence.
+ * @param[in]	dwell_us: Time on each channel.
+ * @param[in]	sync_timeout_us: Time without NRF24_hop_resync after which the
+ * 				hopper stops on its channel, 0 to never stop.
+ */
+void NRF24_hop_init(nrf_hop *hop, const uint8_t *sequence, const size_t length,
+	const uint32_t dwell_us, const uint32_t sync_timeout_us);
+
+/**
+ * @brief Align the slots: @p slot started at @p timestamp.
+ *
+ * Resumes the hopping when it was stopped by the sync timeout.
+ *
+ * @param[in]	hop:
+ * @param[in]	slot: Slot, taken modulo the sequence length.
+ * @param[in]	timestamp: From the timestamp callback.
+ */
+void NRF24_hop_resync(nrf_hop *hop, const size_t slot, const uint32_t timestamp);
+
+/**
+ * @brief Move to the channel of the current slot.
+ *
+ * Call it at least once per dwell time. The channel is changed with
+ * NRF24_change_channel, so the FIFOs are only flushed when they are not
+ * empty, nothing is sent when the slot didn't change. On a listening
+ * receiver (CE high) a hop blocks for 130us while the PLL settles.
+ *
+ * @param[in]	radio:
+ * @param[in]	hop:
+ *
+ * @return Non zero if the channel changed.
+ */
+int NRF24_hop_service(nrf_radio *radio, nrf_hop *hop);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_HOP_H */
@@ -78,6 +78,141 @@ void NRF24_set_bit(nrf_radio *radio, const nrf_register reg, const uint8_t bit_p
  */
 void NRF24_write_bits(nrf_radio *radio, const nrf_register reg, uint8_t bits_mask, uint8_t value);
 
+/**
+ * Read a single byte register.
+ *
+ * When the register cache is enabled (NRF24_ENABLE_REG_CACHE) and the
+ * register is cached the value is returned without touching the SPI bus,
+ * otherwise the register is read from the radio (and cached).
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	reg: Register to be read, see @c nrf_register.
+ *
+ * @return Register value.
+ */
+uint8_t NRF24_read_reg_cached(nrf_radio *radio, const nrf_register reg);
+
+/* power_config and power_ce of nrf_radio before they are read or written */
+#define NRF_POWER_UNKNOWN	0xFFU
+
+/* Transitions of the power state machine still settling */
+enum {
+	/* Tpd2stby, since power_up_time */
+	NRF_POWER_PENDING_UP	= 0x01,
+	/* Tstby2a, since ce_high_time */
+	NRF_POWER_PENDING_CE	= 0x02,
+};
+
+/**
+ * Mark all the cached registers as unknown, the next access to each of them
+ * will be read from the radio.
+ *
+ * Call it when the radio registers could have changed without the library
+ * knowing it, i.e. after a radio power cycle.
+ * The power state machine forgets PWR_UP and PRIM_RX too, the register
+ * cache doesn't need to be enabled for that.
+ *
+ * @param[in]	radio: Radio handle.
+ */
+void NRF24_reg_cache_invalidate(nrf_radio *radio);
+
+/**
+ * Update the register cache with a value read from or written to @p reg.
+ *
+ * Used by the functions that talk to the radio without NRF24_read_reg or
+ * NRF24_write_reg. Does nothing when the register cache is disabled or
+ * @p reg is not cacheable. CONFIG is always handed to the power state
+ * machine (NRF24_power_config_update).
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	reg: Register, see @c nrf_register.
+ * @param[in]	data: Register content.
+ * @param[in]	data_size: Size (in bytes) of the register and data.
+ */
+void NRF24_reg_cache_update(nrf_radio *radio, const nrf_register reg,
+	const uint8_t *data, const size_t data_size);
+
+/**
+ * Read all the cacheable registers from the radio into the register cache.
+ *
+ * Does nothing when the register cache is disabled.
+ *
+ * @param[in]	radio: Radio handle.
+ */
+void NRF24_reg_cache_sync(nrf_radio *radio);
+
+/**
+ * Track the PWR_UP and PRIM_RX bits of CONFIG for the power state machine.
+ *
+ * When PWR_UP goes from 0 (or unknown) to 1, Tpd2stby starts.
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	config: CONFIG register, as read or written.
+ */
+void NRF24_power_config_update(nrf_radio *radio, const uint8_t config);
+
+/**
+ * Track the CE level for the power state machine, used by the HAL.
+ *
+ * When CE goes high Tstby2a starts.
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	state: CE level written.
+ */
+void NRF24_power_ce_update(nrf_radio *radio, const nrf_gpio state);
+
+/**
+ * Wait for what's left of the @p pending transitions.
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	pending: NRF_POWER_PENDING_UP and/or NRF_POWER_PENDING_CE.
+ */
+void NRF24_power_settle(nrf_radio *radio, const uint8_t pending);
+
+/**
+ * Wait until @p duration_us have passed since @p since.
+ *
+ * Without the timestamp callback the whole @p duration_us is waited.
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	since: Timestamp the duration starts at.
+ * @param[in]	duration_us:
+ */
+void NRF24_power_wait(nrf_radio *radio, const uint32_t since, const uint32_t duration_us);
+
+/**
+ * Get the STATUS register.
+ *
+ * When the status cache is enabled (NRF24_ENABLE_STATUS_CACHE) and the last
+ * STATUS seen is fresh (see NRF24_set_status_max_age) it's returned without
+ * touching the SPI bus, otherwise STATUS is read with a NOP command.
+ *
+ * @param[in]	radio: Radio handle.
+ *
+ * @return STATUS register.
+ */
+uint8_t NRF24_read_status_cached(nrf_radio *radio);
+
+/**
+ * Store the STATUS register clocked out by a SPI transaction.
+ *
+ * Used by the HAL on every transaction. Does nothing when the status cache
+ * is disabled or the maximum age is 0.
+ *
+ * @param[in]	radio: Radio handle.
+ * @param[in]	status: STATUS register.
+ */
+void NRF24_status_cache_update(nrf_radio *radio, const uint8_t status);
+
+/**
+ * Drop the STATUS kept, the next query reads the radio.
+ *
+ * Does nothing when the status cache is disabled.
+ *
+ * @param[in]	radio: Radio handle.
+ */
+void NRF24_status_cache_invalidate(nrf_radio *radio);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,109 @@
+/**
+* @file     NRF24_LINK.h
+* @version  0.1
+*
+* @brief    Adaptive tuning of the automatic retransmissions and data rate of
+* a transmitter.
+*
+* The tuner is fed with the result of each transmission (TX_DS or MAX_RT),
+* on TX_DS it reads the retransmissions count (ARC_CNT of OBSERVE_TX, one
+* transaction), a MAX_RT is a lost packet (the event that increments
+* PLOS_CNT) and doesn't need any SPI traffic. Every NRF_LINK_WINDOW packets
+* the settings are adjusted:
+*
+* - Packets lost: the retransmission count is raised to 15, when already
+*   there the data rate is lowered (better sensitivity).
+* - More than one retransmission per packet: the retransmission delay is
+*   raised one step (up to NRF_LINK_MAX_DELAY) to spread colliding
+*   transmitters, when already there the data rate is lowered.
+* - No retransmissions: the delay is lowered one step and the count is
+*   lowered down to 3, every NRF_LINK_CLEAN_WINDOWS windows in a row the
+*   data rate is raised.
+*
+* The retransmission delay never goes below the datasheet minimum for the
+* data rate and ACK payload size (see NRF24_min_retransmit_delay).
+*
+* @note Both ends of the link must use the same data rate, only enable the
+* data rate adaptation when the receiver follows the changes (i.e. it's told
+* by the application, or it scans the data rates).
+*/
+
+#ifndef NRF24_LINK_H
+#define NRF24_LINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+enum {
+	/* Packets between adjustments */
+	NRF_LINK_WINDOW		= 16,
+	/* Clean windows in a row before raising the data rate */
+	NRF_LINK_CLEAN_WINDOWS	= 4,
+	NRF_LINK_MAX_DELAY	= NRF_AUTO_RETRANSMIT_DELAY_1500_US,
+	NRF_LINK_MIN_COUNT	= NRF_AUTO_RETRANSMIT_CNT_3,
+};
+
+typedef struct {
+	/* Current settings, NRF_RF_SETUP_RF_DR_x, NRF_AUTO_RETRANSMIT_DELAY_x
+	 * and NRF_AUTO_RETRANSMIT_CNT_x */
+	uint8_t		data_rate;
+	uint8_t		delay;
+	uint8_t		count;
+	/* Largest ACK payload, 0 if not used */
+	uint8_t		ack_payload_size;
+	uint8_t		adapt_data_rate;
+	/* Current window */
+	uint8_t		packets;
+	uint8_t		lost;
+	uint16_t	retransmissions;
+	uint8_t		clean_windows;
+} nrf_link_tuner;
+
+/**
+ * @brief Initialize the tuner.
+ *
+ * The retransmission delay starts at the minimum for @p data_rate and
+ * @p ack_payload_size and the count at 3, call NRF24_link_tuner_apply to
+ * write them.
+ *
+ * @param[in]	tuner:
+ * @param[in]	data_rate: Initial data rate, NRF_RF_SETUP_RF_DR_x.
+ * @param[in]	ack_payload_size: Largest ACK payload, 0 if not used.
+ * @param[in]	adapt_data_rate: Non zero to let the tuner change the data rate.
+ */
+void NRF24_link_tuner_init(nrf_link_tuner *tuner, const uint8_t data_rate,
+	const uint8_t ack_payload_size, const uint8_t adapt_data_rate);
+
+/**
+ * @brief Write the tuner settings into the radio.
+ *
+ * @param[in]	radio:
+ * @param[in]	tuner:
+ */
+void NRF24_link_tuner_apply(nrf_radio *radio, const nrf_link_tuner *tuner);
+
+/**
+ * @brief Account the result of a transmission.
+ *
+ * @param[in]	radio:
+ * @param[in]	tuner:
+ * @param[in]	result: NRF_TX_DS_IRQ or NRF_MAX_RT_IRQ, i.e. returned by
+ * 				NRF24_poll_interrupt. Call it before the next transmission
+ * 				starts, ARC_CNT is reset by it.
+ *
+ * @return Non zero if the settings changed (they are written already).
+ */
+int NRF24_link_tuner_update(nrf_radio *radio, nrf_link_tuner *tuner, const nrf_irq result);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_LINK_H */
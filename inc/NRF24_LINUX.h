@@ -0,0 +1,169 @@
+/**
+* @file     NRF24_LINUX.h
+* @version  0.1
+*
+* @brief    Linux userspace backend: the radio on a spidev device and the CE
+* and IRQ signals on GPIO lines of the GPIO character device (uAPI v2).
+*
+* The batches of commands handed to the vectored SPI callback (see
+* NRF24_BATCH.h) are sent with a single SPI_IOC_MESSAGE(n) ioctl, the chip
+* select toggled between commands, and a command with a payload (scatter
+* gather SPI callback) is a single ioctl without copying the payload. CE
+* writes that don't change the level don't reach the kernel.
+*
+* The IRQ line is requested with edge detection, its file descriptor can be
+* added to an epoll/poll set and becomes readable when the IRQ signal
+* changes. NRF24_linux_handle_irq consumes the edge events and keeps the
+* level, so the IRQ callback used by NRF24_poll_interrupt doesn't need a
+* syscall:
+*
+* @code
+* nrf_linux lx;
+* nrf_radio radio;
+*
+* NRF24_linux_open(&lx, "/dev/spidev0.0", 8000000, "/dev/gpiochip0", 25, 24);
+* NRF24_linux_attach(&lx, &radio);
+* ...
+* struct epoll_event ev = {.events = EPOLLIN, .data.ptr = &lx};
+* epoll_ctl(epfd, EPOLL_CTL_ADD, NRF24_linux_irq_fd(&lx), &ev);
+*
+* for (;;) {
+*     epoll_wait(epfd, &ev, 1, -1);
+*     if (NRF24_linux_handle_irq(&lx)) {
+*         NRF24_poll_interrupt(&radio);
+*     }
+* }
+* @endcode
+*
+* The library callbacks don't have a context, so each backend attached to a
+* radio takes one of NRF_LINUX_MAX_RADIOS slots with its own callbacks.
+*
+* Callbacks can't report errors, the errno of the first failed syscall is
+* kept in the error member.
+*/
+
+#ifndef NRF24_LINUX_H
+#define NRF24_LINUX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+enum {
+	/* Radios attached at the same time */
+	NRF_LINUX_MAX_RADIOS	= 2,
+	/* Transfers per ioctl, longer batches are split */
+	NRF_LINUX_MAX_XFERS	= 32,
+	/* Shorter delays are busy waits, a sleep of a few us takes much longer */
+	NRF_LINUX_SPIN_US	= 200,
+};
+
+/* Same signature as ioctl(2), replaced on tests to talk to a stand-in radio */
+typedef int (*nrf_linux_ioctl)(int fd, unsigned long request, void *arg);
+
+typedef struct {
+	int		spi_fd;
+	/* GPIO line requests, -1 when the signal isn't connected (CE tied
+	 * high or IRQ not used) */
+	int		ce_fd;
+	int		irq_fd;
+	uint32_t	speed_hz;
+	nrf_linux_ioctl	ioctl_cb;
+	/* Last level written to CE, read from the IRQ edge events */
+	nrf_gpio	ce_level;
+	nrf_gpio	irq_level;
+	/* Slot of the attached radio, -1 if not attached */
+	int		slot;
+	/* errno of the first syscall that failed, 0 if none */
+	int		error;
+} nrf_linux;
+
+/**
+ * @brief Initialize the backend on file descriptors already opened.
+ *
+ * The backend owns them from now on, NRF24_linux_close closes them.
+ *
+ * @param[in]	lx:
+ * @param[in]	spi_fd: spidev device, set up for SPI mode 0 and 8 bits words.
+ * @param[in]	ce_fd: GPIO line request of CE (output), -1 if CE is tied high.
+ * @param[in]	irq_fd: GPIO line request of IRQ with edge detection on both
+ * 				edges, non blocking, -1 to not use the IRQ signal.
+ * @param[in]	speed_hz: SPI clock, up to 10MHz.
+ */
+void NRF24_linux_init(nrf_linux *lx, const int spi_fd, const int ce_fd, const int irq_fd,
+	const uint32_t speed_hz);
+
+/**
+ * @brief Open and set up the spidev device and request the GPIO lines.
+ *
+ * @param[in]	lx:
+ * @param[in]	spidev: i.e. "/dev/spidev0.0".
+ * @param[in]	speed_hz: SPI clock, up to 10MHz.
+ * @param[in]	gpiochip: i.e. "/dev/gpiochip0".
+ * @param[in]	ce_line: Line offset of CE on @p gpiochip, negative if CE is
+ * 				tied high.
+ * @param[in]	irq_line: Line offset of IRQ on @p gpiochip, negative to not
+ * 				use the IRQ signal.
+ *
+ * @return 0 on success, 1 on error (the errno is in lx->error).
+ */
+int NRF24_linux_open(nrf_linux *lx, const char *spidev, const uint32_t speed_hz,
+	const char *gpiochip, const int ce_line, const int irq_line);
+
+/**
+ * @brief Replace the ioctl used to talk to the devices.
+ *
+ * @param[in]	lx:
+ * @param[in]	ioctl_cb: ioctl stand-in, NULL to use ioctl(2).
+ */
+void NRF24_linux_set_ioctl_cb(nrf_linux *lx, nrf_linux_ioctl ioctl_cb);
+
+/**
+ * @brief Initialize @p radio with the callbacks of the backend.
+ *
+ * Registers the vectored, scatter gather and timestamp callbacks too.
+ *
+ * @param[in]	lx:
+ * @param[in]	radio:
+ *
+ * @return 0 on success, 1 if the NRF_LINUX_MAX_RADIOS slots are in use.
+ */
+int NRF24_linux_attach(nrf_linux *lx, nrf_radio *radio);
+
+/**
+ * @brief File descriptor to wait on for IRQ changes (readable).
+ *
+ * @param[in]	lx:
+ *
+ * @return File descriptor, -1 when the IRQ signal isn't used.
+ */
+int NRF24_linux_irq_fd(const nrf_linux *lx);
+
+/**
+ * @brief Consume the pending IRQ edge events, call it when the IRQ file
+ * descriptor is readable.
+ *
+ * @param[in]	lx:
+ *
+ * @return Non zero if the IRQ signal is asserted.
+ */
+int NRF24_linux_handle_irq(nrf_linux *lx);
+
+/**
+ * @brief Release the slot and close the file descriptors.
+ *
+ * @param[in]	lx:
+ */
+void NRF24_linux_close(nrf_linux *lx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_LINUX_H */
@@ -0,0 +1,116 @@
+/**
+* @file     NRF24_NODES.h
+* @version  0.1
+*
+* @brief    Table of node addresses for a transmitter talking to several
+* receivers (i.e. the hub of a star network).
+*
+* Each node is registered once, selecting it as the target writes its
+* address in TX_ADDR and, to get the ACKs, in RX_ADDR_P0. The table
+* remembers the target selected so the writes are skipped when it doesn't
+* change, and only the address bytes that differ from the previous target
+* are written (the bytes are clocked LSByte first, the bytes not clocked
+* keep their value), nodes differing only on their LSByte cost 2 bytes per
+* register.
+*
+* The table doesn't own any memory, the user provides the nodes:
+*
+* @code
+* static nrf_node nodes[16];
+* static nrf_node_table table;
+* size_t sensor;
+*
+* NRF24_node_table_init(&table, nodes, NRF_ARRAY_SIZE(nodes), NRF_PIPE_ADDR_WIDTH_5BYTES, 1);
+* NRF24_node_add(&table, sensor_addr, &sensor);
+* NRF24_node_select(&radio, &table, sensor);
+* NRF24_transmit(&radio, payload, sizeof payload);
+* @endcode
+*/
+
+#ifndef NRF24_NODES_H
+#define NRF24_NODES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+/* No node selected, or the address registers content is unknown */
+#define NRF_NODE_NONE	((size_t) -1)
+
+typedef struct {
+	/* LSByte first */
+	uint8_t	addr[NRF_PIPE_ADDR_WIDTH_5BYTES];
+} nrf_node;
+
+typedef struct {
+	nrf_node	*nodes;
+	size_t		max_nodes;
+	size_t		count;
+	/* Address width configured on the radio (SETUP_AW), in bytes */
+	uint8_t		addr_width;
+	/* Non zero to write RX_ADDR_P0 too */
+	uint8_t		auto_ack;
+	/* Node whose address is on the radio */
+	size_t		selected;
+} nrf_node_table;
+
+/**
+ * @brief Initialize an empty table.
+ *
+ * @param[in]	table:
+ * @param[in]	nodes: Storage of the node addresses.
+ * @param[in]	max_nodes: Number of elements of @p nodes.
+ * @param[in]	addr_width: Address width configured on the radio, so it
+ * 				doesn't have to be read each time a node is selected.
+ * @param[in]	auto_ack: Non zero if the nodes ACK the packets, RX_ADDR_P0 is
+ * 				then set to the node address as well.
+ */
+void NRF24_node_table_init(nrf_node_table *table, nrf_node *nodes, const size_t max_nodes,
+	const nrf_pipe_addr_width addr_width, const uint8_t auto_ack);
+
+/**
+ * @brief Register a node.
+ *
+ * @param[in]	table:
+ * @param[in]	addr: Node address, addr_width bytes LSByte first.
+ * @param[out]	node: Identifier of the node, used to select it.
+ *
+ * @return 0 on success, 1 if the table is full.
+ */
+int NRF24_node_add(nrf_node_table *table, const uint8_t *addr, size_t *node);
+
+/**
+ * @brief Make @p node the target of the next transmissions.
+ *
+ * Nothing is sent when @p node is already selected, otherwise TX_ADDR (and
+ * RX_ADDR_P0) are written with one transaction each, sent as a batch (see
+ * NRF24_set_spi_xfer_vec_cb).
+ *
+ * @param[in]	radio:
+ * @param[in]	table:
+ * @param[in]	node: Identifier returned by NRF24_node_add.
+ */
+void NRF24_node_select(nrf_radio *radio, nrf_node_table *table, const size_t node);
+
+/**
+ * @brief Forget the node selected, the next selection writes the whole
+ * addresses.
+ *
+ * Call it when the address registers are written by other means or the
+ * radio was reset.
+ *
+ * @param[in]	table:
+ */
+void NRF24_node_table_invalidate(nrf_node_table *table);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_NODES_H */
@@ -0,0 +1,117 @@
+/**
+* @file     NRF24_RING.h
+* @version  0.1
+*
+* @brief    Lock-free single producer single consumer packet queues.
+*
+* The rings sit between the radio interrupt handler and the application:
+* packets received are moved from the RX FIFO into the RX ring, and packets
+* queued in the TX ring are moved into the TX FIFO, by NRF24_poll_interrupt
+* (see NRF24_set_rings).
+*
+* Each ring has exactly one producer and one consumer, they can run in an ISR
+* and the main loop on a Cortex-M, or in two threads on a host, no locks are
+* needed. The producer only writes head and the consumer only writes tail,
+* both indexes are free running and the slots are used modulo the capacity.
+*
+* The ring doesn't own any memory, the user provides the slots, their number
+* must be a power of two:
+*
+* @code
+* static nrf_packet rx_slots[8];
+* static nrf_ring rx_ring;
+*
+* NRF24_ring_init(&rx_ring, rx_slots, NRF_ARRAY_SIZE(rx_slots));
+* @endcode
+*/
+
+#ifndef NRF24_RING_H
+#define NRF24_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+
+/* Index accesses with acquire/release semantics, the GCC/Clang builtins are
+ * used by default. Define them before including this file for other
+ * compilers */
+#ifndef NRF_RING_LOAD_ACQUIRE
+	#define NRF_RING_LOAD_ACQUIRE(ptr)		__atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#endif
+#ifndef NRF_RING_STORE_RELEASE
+	#define NRF_RING_STORE_RELEASE(ptr, val)	__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#endif
+
+struct _nrf_ring {
+	nrf_packet	*slots;
+	size_t		capacity;
+	/* Written by the producer only */
+	size_t		head;
+	/* Written by the consumer only */
+	size_t		tail;
+};
+
+/**
+ * @brief Initialize an empty ring.
+ *
+ * @param[in]	ring:
+ * @param[in]	slots: Storage for the packets.
+ * @param[in]	capacity: Number of slots, must be a power of two.
+ */
+void NRF24_ring_init(nrf_ring *ring, nrf_packet *slots, const size_t capacity);
+
+/**
+ * @return Number of packets in the ring.
+ */
+size_t NRF24_ring_count(const nrf_ring *ring);
+
+/**
+ * @brief Producer side, get the next free slot without publishing it.
+ *
+ * Fill the slot in place and call NRF24_ring_commit to publish it.
+ *
+ * @return Pointer to the free slot, NULL if the ring is full.
+ */
+nrf_packet *NRF24_ring_reserve(nrf_ring *ring);
+
+/**
+ * @brief Producer side, publish the slot got with NRF24_ring_reserve.
+ */
+void NRF24_ring_commit(nrf_ring *ring);
+
+/**
+ * @brief Consumer side, get the oldest packet without removing it.
+ *
+ * @return Pointer to the packet, NULL if the ring is empty.
+ */
+nrf_packet *NRF24_ring_peek(nrf_ring *ring);
+
+/**
+ * @brief Consumer side, remove the packet got with NRF24_ring_peek.
+ */
+void NRF24_ring_release(nrf_ring *ring);
+
+/**
+ * @brief Producer side, copy @p packet into the ring.
+ *
+ * @return 0 on success, 1 if the ring is full.
+ */
+int NRF24_ring_push(nrf_ring *ring, const nrf_packet *packet);
+
+/**
+ * @brief Consumer side, copy the oldest packet into @p packet and remove it.
+ *
+ * @return 0 on success, 1 if the ring is empty.
+ */
+int NRF24_ring_pop(nrf_ring *ring, nrf_packet *packet);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_RING_H */
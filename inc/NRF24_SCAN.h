@@ -0,0 +1,89 @@
+/**
+* @file     NRF24_SCAN.h
+* @version  0.1
+*
+* @brief    Channel occupancy scanner based on the Received Power Detector.
+*
+* A sweep tunes the receiver to each channel from 0 to NRF_MAX_RF_CHANNEL,
+* waits for RPD to be valid (PLL settling plus the AGC delay, 170us) and
+* reads it. Unlike NRF24_set_channel the FIFOs are not flushed, the RPD read
+* of a channel and the RF_CH write of the next one are sent as one batch
+* (see NRF24_set_spi_xfer_vec_cb) while CE is high, the new channel is
+* tuned on the next CE rising edge.
+*
+* The number of sweeps where a carrier was detected is accumulated per
+* channel, once 255 sweeps are done the counts are halved so the recent
+* sweeps weigh more than the old ones:
+*
+* @code
+* nrf_scan scan;
+* uint8_t channels[3];
+*
+* NRF24_scan_init(&scan);
+* for (size_t idx = 0; idx < 100; idx++) {
+*     NRF24_scan_sweep(&radio, &scan);
+* }
+* NRF24_scan_quietest(&scan, channels, NRF_ARRAY_SIZE(channels));
+* @endcode
+*/
+
+#ifndef NRF24_SCAN_H
+#define NRF24_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+enum {
+	NRF_SCAN_CHANNELS	= NRF_MAX_RF_CHANNEL + 1,
+	/* Time on each channel, until RPD is valid */
+	NRF_SCAN_DWELL_US	= NRF_PLL_SETTLE_DELAY_US + NRF_RPD_DELAY_US,
+};
+
+typedef struct {
+	/* Sweeps where a carrier was detected, per channel */
+	uint8_t	hits[NRF_SCAN_CHANNELS];
+	uint8_t	sweeps;
+} nrf_scan;
+
+/**
+ * @brief Clear the accumulated counts.
+ *
+ * @param[in]	scan:
+ */
+void NRF24_scan_init(nrf_scan *scan);
+
+/**
+ * @brief Sweep all the channels once.
+ *
+ * @note The radio must be powered up as receiver. CE is left low and RF_CH
+ * is restored when the sweep is done.
+ *
+ * @param[in]	radio:
+ * @param[in]	scan: Where the result is accumulated.
+ */
+void NRF24_scan_sweep(nrf_radio *radio, nrf_scan *scan);
+
+/**
+ * @brief Get the channels with the fewest detections.
+ *
+ * @param[in]	scan:
+ * @param[out]	channels: The quietest channels first, on a tie the lowest
+ * 				channel first.
+ * @param[in]	max_channels: Number of elements of @p channels.
+ *
+ * @return Number of channels stored in @p channels.
+ */
+size_t NRF24_scan_quietest(const nrf_scan *scan, uint8_t *channels, const size_t max_channels);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_SCAN_H */
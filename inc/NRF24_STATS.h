@@ -0,0 +1,59 @@
+/**
+* @file     NRF24_STATS.h
+* @version  0.1
+*
+* @brief    Runtime counters, define NRF24_ENABLE_STATS to use them.
+*
+* The counters live in the radio object and are updated on the hot paths
+* (SPI transfers, CE writes, payload commands, STATUS writes clearing the
+* interrupt flags and OBSERVE_TX reads). When NRF24_ENABLE_STATS is not
+* defined the updates compile to nothing and the radio object doesn't grow.
+*/
+
+#ifndef NRF24_STATS_H
+#define NRF24_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+
+#if defined(NRF24_ENABLE_STATS)
+
+/* Used by the library to update the counters */
+#define NRF24_STATS_ADD(radio, counter, value)	((radio)->stats.counter += (uint32_t) (value))
+
+/**
+ * @brief Copy the counters into @p snapshot.
+ *
+ * @note The copy isn't atomic, don't call it while the radio is used from
+ * an ISR.
+ *
+ * @param[in]	radio:
+ * @param[out]	snapshot: Where the counters are copied.
+ * @param[in]	reset: Non zero to reset the counters after the copy.
+ */
+void NRF24_stats_snapshot(nrf_radio *radio, nrf_stats *snapshot, const uint8_t reset);
+
+/**
+ * @brief Reset the counters.
+ *
+ * @param[in]	radio:
+ */
+void NRF24_stats_reset(nrf_radio *radio);
+
+#else
+
+#define NRF24_STATS_ADD(radio, counter, value)	((void) 0)
+
+#endif /* NRF24_ENABLE_STATS */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_STATS_H */
@@ -0,0 +1,170 @@
+/**
+* @file     NRF24_TRACE.h
+* @version  0.1
+*
+* @brief    Bus trace: the SPI transactions, CE writes and delays requested by
+* the library recorded in a lock-free ring, define NRF24_ENABLE_TRACE to use
+* it.
+*
+* Records are appended by the HAL (NRF24_hal_spi_xfer, NRF24_hal_set_ce,
+* NRF24_hal_delay, ...) while a trace is attached to the radio. The ring
+* has one producer (the driver) and one consumer (i.e. the main loop
+* sending the trace over a UART), it never blocks: when a record doesn't fit
+* it's dropped and a NRF_TRACE_LOST record with the number of records
+* dropped is written once there's room again. Without a trace attached a
+* HAL call costs a NULL check, without NRF24_ENABLE_TRACE nothing.
+*
+* Each record is a header, type (1 byte), data size (1 byte) and timestamp
+* (4 bytes, little endian, from the timestamp callback or 0 without it),
+* followed by the data:
+*
+*	NRF_TRACE_SPI		bytes sent followed by the bytes received
+*	NRF_TRACE_CE		level written
+*	NRF_TRACE_DELAY_US	delay, 4 bytes little endian
+*	NRF_TRACE_LOST		records dropped, 4 bytes little endian
+*
+* The transfers of the non-blocking operations (NRF24_ASYNC.h) don't go
+* through the HAL and aren't traced.
+*
+* @code
+* static uint8_t trace_buffer[4096];
+* static nrf_trace trace;
+*
+* NRF24_trace_init(&trace, trace_buffer, sizeof trace_buffer);
+* NRF24_trace_attach(&radio, &trace);
+* ...
+* uint8_t chunk[128];
+* size_t size;
+*
+* while (0 != (size = NRF24_trace_read(&trace, chunk, sizeof chunk))) {
+*     uart_write(chunk, size);
+* }
+* @endcode
+*
+* tools/nrf24_trace.c decodes the dumps and replays them on the emulator
+* (make trace_tool).
+*/
+
+#ifndef NRF24_TRACE_H
+#define NRF24_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+typedef enum {
+	NRF_TRACE_SPI		= 1,
+	NRF_TRACE_CE		= 2,
+	NRF_TRACE_DELAY_US	= 3,
+	NRF_TRACE_LOST		= 4,
+} nrf_trace_type;
+
+enum {
+	/* Type, data size and timestamp */
+	NRF_TRACE_HEADER_SIZE		= 6,
+	/* Largest transaction: command and a full payload, both ways */
+	NRF_TRACE_RECORD_MAX_SIZE	= NRF_TRACE_HEADER_SIZE + (2 * (NRF_PAYLOAD_SIZE_MAX + 1)),
+};
+
+/* Decoded record, points into the trace data */
+typedef struct {
+	nrf_trace_type	type;
+	uint32_t	timestamp;
+	/* NRF_TRACE_SPI: size of the transaction, NRF_TRACE_CE: level,
+	 * NRF_TRACE_DELAY_US: delay, NRF_TRACE_LOST: records dropped */
+	uint32_t	value;
+	const uint8_t	*mosi;
+	const uint8_t	*miso;
+} nrf_trace_record;
+
+struct _nrf_trace {
+	uint8_t		*buffer;
+	size_t		capacity;
+	/* Written by the producer only */
+	size_t		head;
+	/* Written by the consumer only */
+	size_t		tail;
+	/* Records dropped since the last NRF_TRACE_LOST record */
+	uint32_t	lost;
+};
+
+/**
+ * @brief Decode the record at the start of @p data, works on the host.
+ *
+ * @param[in]	data: Trace, as read with NRF24_trace_read.
+ * @param[in]	size: Bytes of @p data.
+ * @param[out]	record:
+ *
+ * @return Size of the record, 0 if @p data doesn't start with a whole valid
+ * 		record.
+ */
+size_t NRF24_trace_decode(const uint8_t *data, const size_t size, nrf_trace_record *record);
+
+#if defined(NRF24_ENABLE_TRACE)
+
+/* Used by the HAL to append the records */
+#define NRF24_TRACE_SPI(radio, in, out, size)	\
+	do { if (NULL != (radio)->trace) { NRF24_trace_spi((radio), (in), (out), (size)); } } while (0)
+#define NRF24_TRACE_SPI_SG(radio, cmd, status, in, out, size)	\
+	do { if (NULL != (radio)->trace) { NRF24_trace_spi_sg((radio), (cmd), (status), (in), (out), (size)); } } while (0)
+#define NRF24_TRACE_CE(radio, state)	\
+	do { if (NULL != (radio)->trace) { NRF24_trace_ce((radio), (state)); } } while (0)
+#define NRF24_TRACE_DELAY_US(radio, us)	\
+	do { if (NULL != (radio)->trace) { NRF24_trace_delay_us((radio), (us)); } } while (0)
+
+/**
+ * @brief Initialize an empty trace.
+ *
+ * @param[in]	trace:
+ * @param[in]	buffer: Storage for the records.
+ * @param[in]	capacity: Bytes of @p buffer, must be a power of two and
+ * 				hold at least NRF_TRACE_RECORD_MAX_SIZE bytes.
+ */
+void NRF24_trace_init(nrf_trace *trace, uint8_t *buffer, const size_t capacity);
+
+/**
+ * @brief Start (or stop) recording the bus traffic of @p radio.
+ *
+ * @param[in]	radio:
+ * @param[in]	trace: NULL to stop.
+ */
+void NRF24_trace_attach(nrf_radio *radio, nrf_trace *trace);
+
+/**
+ * @brief Consumer side, move whole records out of the ring.
+ *
+ * @param[in]	trace:
+ * @param[out]	data:
+ * @param[in]	max_size: Bytes of @p data, at least NRF_TRACE_RECORD_MAX_SIZE
+ * 				to be sure to make progress.
+ *
+ * @return Bytes copied into @p data, 0 if the ring is empty.
+ */
+size_t NRF24_trace_read(nrf_trace *trace, uint8_t *data, const size_t max_size);
+
+void NRF24_trace_spi(nrf_radio *radio, const void *in, const void *out, const size_t size);
+void NRF24_trace_spi_sg(nrf_radio *radio, const uint8_t cmd, const uint8_t status,
+	const uint8_t *in, const uint8_t *out, const size_t size);
+void NRF24_trace_ce(nrf_radio *radio, const nrf_gpio state);
+void NRF24_trace_delay_us(nrf_radio *radio, const uint32_t us);
+
+#else
+
+#define NRF24_TRACE_SPI(radio, in, out, size)			((void) 0)
+#define NRF24_TRACE_SPI_SG(radio, cmd, status, in, out, size)	((void) 0)
+#define NRF24_TRACE_CE(radio, state)				((void) 0)
+#define NRF24_TRACE_DELAY_US(radio, us)				((void) 0)
+
+#endif /* NRF24_ENABLE_TRACE */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_TRACE_H */
@@ -9,19 +9,72 @@
 #include "NRF24_DEFS.h"
 #include "NRF24_COMMANDS.h"
 #include "NRF24_INTERFACE.h"
+#include "NRF24_BATCH.h"
+#include "NRF24_RING.h"
+#include "NRF24_STATS.h"
+
+/**
+ * @brief Move the packets in the RX FIFO into @p packets or, if it's NULL,
+ * into @p ring.
+ *
+ * @return Number of packets read.
+ */
+static size_t NRF24_drain_rx_fifo(nrf_radio *radio, nrf_packet *packets,
+	const size_t max_packets, nrf_ring *ring);
+
+/**
+ * @brief Move packets from @p ring into the TX FIFO until it's full.
+ */
+static void NRF24_fill_tx_fifo(nrf_radio *radio, nrf_ring *ring, uint8_t status);
+
+/**
+ * @brief Write the @p mask bits of CONFIG with @p value, unless they are
+ * known to have that value already.
+ */
+static void NRF24_power_write_config(nrf_radio *radio, const uint8_t mask, const uint8_t value);
+
+/**
+ * @brief Drive CE low, once it was high for Thce if the radio may be a
+ * transmitter sending a payload.
+ */
+static void NRF24_power_ce_low(nrf_radio *radio);
+
+/* Steps of the split-phase operations left for NRF24_service */
+enum {
+	/* CE goes high once Tpd2stby is over */
+	NRF_SERVICE_CE_HIGH	= 0x01,
+	/* CE goes low at service_ce_low_time, ending the transmit pulse */
+	NRF_SERVICE_CE_LOW	= 0x02,
+};
+
+/**
+ * @brief Whether @p now is at or past @p deadline, across the timestamp
+ * wrap around.
+ */
+static int NRF24_deadline_reached(const uint32_t now, const uint32_t deadline);
+
+/**
+ * @brief The deadline of @p a and @p b that comes first.
+ */
+static uint32_t NRF24_deadline_first(const uint32_t a, const uint32_t b);
 
 /*
 struct _nrf_radio {
 	nrf_write_ce 	write_ce_cb;
 	nrf_read_irq 	read_irq_cb;
 	nrf_delay_ms 	delay_ms_cb;
+	nrf_delay_us	delay_us_cb;
 	nrf_spi_xfer	spi_xfer_data_cb;
+	nrf_spi_xfer_vec	spi_xfer_vec_cb;
+	nrf_spi_xfer_sg		spi_xfer_sg_cb;
+	nrf_time_us	time_us_cb;
 };
 */
 
 int NRF24_init(nrf_radio *radio,
 	nrf_spi_xfer spi_xfer_cb, nrf_write_ce write_ce_cb,
-	nrf_read_irq read_irq_cb, nrf_delay_ms delay_ms_cb)
+	nrf_read_irq read_irq_cb, nrf_delay_ms delay_ms_cb,
+	nrf_delay_us delay_us_cb)
 {
     if ((NULL == radio) ||
         (NULL == spi_xfer_cb) ||
@@ -31,13 +84,214 @@ int NRF24_init(nrf_radio *radio,
         return 1;
     }
 	radio->delay_ms_cb = delay_ms_cb;
+	radio->delay_us_cb = delay_us_cb;
 	radio->read_irq_cb = read_irq_cb;
 	radio->spi_xfer_data_cb = spi_xfer_cb;
 	radio->write_ce_cb = write_ce_cb;
+	radio->spi_xfer_vec_cb = NULL;
+	radio->spi_xfer_sg_cb = NULL;
+	radio->time_us_cb = NULL;
+
+	for (size_t idx = 0; idx < NRF_IRQ_HANDLERS; idx++) {
+		radio->irq_handlers[idx] = NULL;
+		radio->irq_contexts[idx] = NULL;
+	}
+
+	radio->rx_ring = NULL;
+	radio->tx_ring = NULL;
+
+#if defined(NRF24_ENABLE_STATS)
+	NRF24_stats_reset(radio);
+	radio->stats_ce = GPIO_CLEAR;
+	radio->stats_plos = 0;
+#endif
+
+#if defined(NRF24_ENABLE_ASYNC)
+	radio->spi_xfer_async_cb = NULL;
+	/* No asynchronous operation in progress */
+	radio->async.op = 0;
+#endif
+
+#if defined(NRF24_ENABLE_TRACE)
+	radio->trace = NULL;
+#endif
+
+	NRF24_reg_cache_invalidate(radio);
+
+	radio->power_config = NRF_POWER_UNKNOWN;
+	radio->power_ce = NRF_POWER_UNKNOWN;
+	radio->power_pending = 0;
+	radio->power_up_time = 0;
+	radio->ce_high_time = 0;
+	radio->service_steps = 0;
+	radio->service_ce_low_time = 0;
+
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+	radio->status_valid = 0;
+	radio->status_max_age_us = 0;
+#endif
 
     return 0;
 }
 
+void NRF24_set_spi_xfer_vec_cb(nrf_radio *radio, nrf_spi_xfer_vec spi_xfer_vec_cb)
+{
+	NRF24_ASSERT(radio);
+
+	radio->spi_xfer_vec_cb = spi_xfer_vec_cb;
+}
+
+void NRF24_set_spi_xfer_sg_cb(nrf_radio *radio, nrf_spi_xfer_sg spi_xfer_sg_cb)
+{
+	NRF24_ASSERT(radio);
+
+	radio->spi_xfer_sg_cb = spi_xfer_sg_cb;
+}
+
+void NRF24_set_time_us_cb(nrf_radio *radio, nrf_time_us time_us_cb)
+{
+	NRF24_ASSERT(radio);
+
+	radio->time_us_cb = time_us_cb;
+}
+
+void NRF24_set_status_max_age(nrf_radio *radio, const uint32_t max_age_us)
+{
+	NRF24_ASSERT(radio);
+
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+	NRF24_ASSERT((0 == max_age_us) || (NULL != radio->time_us_cb));
+
+	radio->status_max_age_us = max_age_us;
+	radio->status_valid = 0;
+#else
+	(void) max_age_us;
+#endif
+}
+
+void NRF24_set_power_state(nrf_radio *radio, const nrf_power_state state)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->write_ce_cb);
+	NRF24_ASSERT((NRF_STATE_POWER_DOWN <= state) && (NRF_STATE_TX >= state));
+
+	/* CE is high in standby-II, RX and TX, PRIM_RX only matters then */
+	const uint8_t active = (NRF_STATE_STANDBY_II <= state);
+	const uint8_t mask = (uint8_t) (active ? (NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER) :
+		NRF_CONFIG_PWR_UP);
+	const uint8_t value = (uint8_t) ((NRF_STATE_POWER_DOWN == state) ? 0 :
+		(NRF_STATE_RX == state) ? (NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER) :
+		NRF_CONFIG_PWR_UP);
+	const uint8_t config_done = (NRF_POWER_UNKNOWN != radio->power_config) &&
+		((radio->power_config & mask) == value);
+
+	/* The mode changes with CE low, going through standby-I */
+	if ((GPIO_CLEAR != radio->power_ce) && (!active || !config_done)) {
+		NRF24_power_ce_low(radio);
+	}
+
+	if (!config_done) {
+		NRF24_power_write_config(radio, mask, value);
+	}
+
+	if (NRF_STATE_POWER_DOWN == state) {
+		return;
+	}
+
+	/* Tpd2stby before CE goes high, so Tstby2a starts in standby-I */
+	NRF24_power_settle(radio, NRF_POWER_PENDING_UP);
+
+	if (active && (GPIO_SET != radio->power_ce)) {
+		NRF24_hal_set_ce(radio, GPIO_SET);
+	}
+
+	if ((NRF_STATE_RX == state) || (NRF_STATE_TX == state)) {
+		NRF24_power_settle(radio, NRF_POWER_PENDING_CE);
+	}
+}
+
+nrf_power_state NRF24_get_power_state(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	if ((NRF_POWER_UNKNOWN == radio->power_config) || (NRF_POWER_UNKNOWN == radio->power_ce)) {
+		return NRF_STATE_UNKNOWN;
+	}
+
+	if (!(radio->power_config & NRF_CONFIG_PWR_UP)) {
+		return NRF_STATE_POWER_DOWN;
+	}
+
+	if (GPIO_SET != radio->power_ce) {
+		return NRF_STATE_STANDBY_I;
+	}
+
+	return (radio->power_config & NRF_CONFIG_RECEIVER) ? NRF_STATE_RX : NRF_STATE_STANDBY_II;
+}
+
+int NRF24_service(nrf_radio *radio, const uint32_t now)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->time_us_cb);
+
+	if ((radio->power_pending & NRF_POWER_PENDING_UP) &&
+		NRF24_deadline_reached(now, radio->power_up_time + NRF_POWER_UP_DELAY_US)) {
+		radio->power_pending &= (uint8_t) ~NRF_POWER_PENDING_UP;
+
+		/* Tstby2a starts once in standby */
+		if (radio->power_pending & NRF_POWER_PENDING_CE) {
+			radio->ce_high_time = radio->power_up_time + NRF_POWER_UP_DELAY_US;
+		}
+	}
+
+	if ((radio->service_steps & NRF_SERVICE_CE_HIGH) &&
+		!(radio->power_pending & NRF_POWER_PENDING_UP)) {
+		NRF24_hal_set_ce(radio, GPIO_SET);
+		radio->service_steps &= (uint8_t) ~NRF_SERVICE_CE_HIGH;
+		radio->service_ce_low_time = now + NRF_CE_PULSE_WIDTH_US;
+	}
+
+	if ((NRF_SERVICE_CE_LOW == radio->service_steps) &&
+		NRF24_deadline_reached(now, radio->service_ce_low_time)) {
+		NRF24_hal_set_ce(radio, GPIO_CLEAR);
+		radio->service_steps = 0;
+	}
+
+	if ((NRF_POWER_PENDING_CE == radio->power_pending) &&
+		NRF24_deadline_reached(now, radio->ce_high_time + NRF_PLL_SETTLE_DELAY_US)) {
+		radio->power_pending = 0;
+	}
+
+	return (0 != radio->service_steps) || (0 != radio->power_pending);
+}
+
+uint32_t NRF24_service_deadline(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->time_us_cb);
+
+	/* Everything else waits for the power up */
+	if (radio->power_pending & NRF_POWER_PENDING_UP) {
+		return radio->power_up_time + NRF_POWER_UP_DELAY_US;
+	}
+
+	if ((radio->service_steps & NRF_SERVICE_CE_LOW) &&
+		(radio->power_pending & NRF_POWER_PENDING_CE)) {
+		return NRF24_deadline_first(radio->service_ce_low_time,
+			radio->ce_high_time + NRF_PLL_SETTLE_DELAY_US);
+	}
+
+	if (radio->service_steps & NRF_SERVICE_CE_LOW) {
+		return radio->service_ce_low_time;
+	}
+
+	if (radio->power_pending & NRF_POWER_PENDING_CE) {
+		return radio->ce_high_time + NRF_PLL_SETTLE_DELAY_US;
+	}
+
+	return NRF24_hal_time_us(radio);
+}
+
 void NRF24_sleep(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
@@ -50,10 +304,20 @@ void NRF24_wakeup(nrf_radio *radio)
 	NRF24_ASSERT(radio);
 	NRF24_ASSERT(radio->delay_ms_cb);
 
-    NRF24_set_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
-    /* after leaving standby-I mode the radio need a time to return to TX or
-     * RX Mode */
-    NRF24_hal_delay(radio, 5);
+    NRF24_power_write_config(radio, NRF_CONFIG_PWR_UP, NRF_CONFIG_PWR_UP);
+    /* after leaving power down mode the radio need a time (Tpd2stby) to
+     * enter standby-I mode, only what's left of it is waited */
+    NRF24_power_settle(radio, NRF_POWER_PENDING_UP);
+}
+
+uint32_t NRF24_wakeup_begin(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->time_us_cb);
+
+    NRF24_power_write_config(radio, NRF_CONFIG_PWR_UP, NRF_CONFIG_PWR_UP);
+
+    return NRF24_service_deadline(radio);
 }
 
 void NRF24_set_mode(nrf_radio *radio, const nrf_mode mode)
@@ -63,49 +327,51 @@ void NRF24_set_mode(nrf_radio *radio, const nrf_mode mode)
 	NRF_MODE_RX == mode ? NRF24_set_rx_mode(radio) : NRF24_set_tx_mode(radio);
 }
 
-/* TODO */
 nrf_mode NRF24_get_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-	return NRF_MODE_RX;
+	if (NRF_POWER_UNKNOWN != radio->power_config) {
+		return (radio->power_config & NRF_CONFIG_RECEIVER) ? NRF_MODE_RX : NRF_MODE_TX;
+	}
+
+	return NRF24_read_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PRIM_RX) ?
+		NRF_MODE_RX : NRF_MODE_TX;
 }
 
 void NRF24_set_power_down_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    NRF24_clear_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
+    NRF24_set_power_state(radio, NRF_STATE_POWER_DOWN);
 }
 
 void NRF24_set_standby_i_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    NRF24_stop_listening(radio);
-    NRF24_set_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_PWR_UP);
+    NRF24_set_power_state(radio, NRF_STATE_STANDBY_I);
 }
 
 void NRF24_set_standby_ii_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    NRF24_start_listening(radio);
-    NRF24_set_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
+    NRF24_set_power_state(radio, NRF_STATE_STANDBY_II);
 }
 
 void NRF24_set_rx_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    NRF24_set_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PRIM_RX);
+    NRF24_power_write_config(radio, NRF_CONFIG_RECEIVER, NRF_CONFIG_RECEIVER);
 }
 
 void NRF24_set_tx_mode(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    NRF24_clear_bit(radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PRIM_RX);
+    NRF24_power_write_config(radio, NRF_CONFIG_RECEIVER, NRF_CONFIG_TRANSMITTER);
 }
 
 void NRF24_enable_auto_ack(nrf_radio *radio, const nrf_pipe pipe)
@@ -130,19 +396,70 @@ void NRF24_set_channel(nrf_radio *radio, uint8_t channel)
         channel = NRF_MAX_RF_CHANNEL;
     }
 
-    NRF24_write_reg(radio, NRF_REG_RF_CH, &channel, 1);
+    /* W_REGISTER RF_CH, FLUSH_RX and FLUSH_TX */
+    uint8_t in[4];
+    uint8_t out[4];
+    nrf_spi_segment segments[3];
+    nrf_batch batch;
 
-    NRF24_cmd_flush_rx(radio);
-    NRF24_cmd_flush_tx(radio);
+    NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+    NRF24_batch_write_reg(&batch, NRF_REG_RF_CH, &channel, 1);
+    NRF24_batch_cmd(&batch, NRF_CMD_FLUSH_RX);
+    NRF24_batch_cmd(&batch, NRF_CMD_FLUSH_TX);
+
+    NRF24_batch_submit(radio, &batch);
+}
+
+void NRF24_change_channel(nrf_radio *radio, uint8_t channel)
+{
+	NRF24_ASSERT(radio);
+
+    if (NRF_MAX_RF_CHANNEL < channel) {
+        channel = NRF_MAX_RF_CHANNEL;
+    }
+
+    /* The radio only tunes to RF_CH on a CE rising edge, with CE high it
+     * goes through standby-I to take the new channel */
+    const uint8_t retune = (GPIO_SET == radio->power_ce);
+
+    if (retune) {
+        NRF24_power_ce_low(radio);
+    }
+
+    /* W_REGISTER RF_CH and R_REGISTER FIFO_STATUS, then FLUSH_RX and
+     * FLUSH_TX if needed */
+    uint8_t in[4];
+    uint8_t out[4];
+    nrf_spi_segment segments[2];
+    nrf_batch batch;
+
+    NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+    NRF24_batch_write_reg(&batch, NRF_REG_RF_CH, &channel, 1);
+    NRF24_batch_read_reg(&batch, NRF_REG_FIFO_STATUS, 1);
+    NRF24_batch_submit(radio, &batch);
+
+    const uint8_t fifo_status = NRF24_batch_data(&batch, 1)[0];
+
+    if (!(fifo_status & NRF_FIFO_STATUS_RX_EMPTY)) {
+        NRF24_cmd_flush_rx(radio);
+    }
+
+    if (!(fifo_status & NRF_FIFO_STATUS_TX_EMPTY)) {
+        NRF24_cmd_flush_tx(radio);
+    }
+
+    if (retune) {
+        NRF24_hal_set_ce(radio, GPIO_SET);
+        /* Tstby2a on the new channel */
+        NRF24_power_settle(radio, NRF_POWER_PENDING_CE);
+    }
 }
 
 uint8_t NRF24_get_channel(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    uint8_t channel;
-    NRF24_read_reg(radio, NRF_REG_RF_CH, &channel, 1);
-    return channel;
+    return NRF24_read_reg_cached(radio, NRF_REG_RF_CH);
 }
 
 void NRF24_set_address_width(nrf_radio *radio, const nrf_addr_width addr_width)
@@ -157,8 +474,7 @@ uint8_t NRF24_get_address_width(nrf_radio *radio)
 	NRF24_ASSERT(radio);
 
 	uint8_t retval = 0;
-	uint8_t addr_width = 0;
-	NRF24_read_reg(radio, NRF_REG_SETUP_AW, (uint8_t *) &addr_width, 1);
+	uint8_t addr_width = NRF24_read_reg_cached(radio, NRF_REG_SETUP_AW);
 
 	switch (addr_width) {
 	case 1:
@@ -303,6 +619,86 @@ nrf_rx_pipe_enabled NRF24_rx_pipe_is_enabled(nrf_radio *radio, nrf_pipe pipe)
 	return (nrf_rx_pipe_enabled) NRF24_read_bit(radio, NRF_REG_EN_RXADDR, pipe);
 }
 
+void NRF24_set_auto_retransmit(nrf_radio *radio, const uint8_t delay, const uint8_t count)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(!(delay & ~NRF_SETUP_RETR_ARD_MASK));
+	NRF24_ASSERT(!(count & ~NRF_SETUP_RETR_ARC_MASK));
+
+	const uint8_t setup_retr = (uint8_t) (delay | count);
+
+	NRF24_write_reg(radio, NRF_REG_SETUP_RETR, &setup_retr, 1);
+}
+
+uint8_t NRF24_get_auto_retransmit_delay(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	return NRF24_read_reg_cached(radio, NRF_REG_SETUP_RETR) & NRF_SETUP_RETR_ARD_MASK;
+}
+
+uint8_t NRF24_get_auto_retransmit_count(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	return NRF24_read_reg_cached(radio, NRF_REG_SETUP_RETR) & NRF_SETUP_RETR_ARC_MASK;
+}
+
+uint8_t NRF24_min_retransmit_delay(const uint8_t data_rate, const uint8_t ack_payload_size)
+{
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= ack_payload_size);
+
+	uint8_t steps = 0;
+
+	switch (data_rate) {
+	case NRF_RF_SETUP_RF_DR_2000:
+		steps = (15 < ack_payload_size) ? 1 : 0;
+		break;
+	case NRF_RF_SETUP_RF_DR_1000:
+		steps = (5 < ack_payload_size) ? 1 : 0;
+		break;
+	default:
+		/* 250kbps: 500us without ACK payload, 750us up to 8 bytes, 1000us
+		 * up to 16, ... */
+		steps = (0 == ack_payload_size) ? 1 : (uint8_t) (1 + (ack_payload_size + 7) / 8);
+		break;
+	}
+
+	return (uint8_t) (steps << NRF_SETUP_RETR_BIT_ARD);
+}
+
+void NRF24_set_data_rate(nrf_radio *radio, const uint8_t data_rate)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(!(data_rate & ~NRF_RF_SETUP_RF_DR_MASK));
+	/* RF_DR_LOW and RF_DR_HIGH set is reserved */
+	NRF24_ASSERT(NRF_RF_SETUP_RF_DR_MASK != data_rate);
+
+	NRF24_write_bits(radio, NRF_REG_RF_SETUP, NRF_RF_SETUP_RF_DR_MASK, data_rate);
+}
+
+uint8_t NRF24_get_data_rate(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	return NRF24_read_reg_cached(radio, NRF_REG_RF_SETUP) & NRF_RF_SETUP_RF_DR_MASK;
+}
+
+void NRF24_set_pa_level(nrf_radio *radio, const uint8_t level)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(!(level & ~NRF_RF_SETUP_RF_PWR_MASK));
+
+	NRF24_write_bits(radio, NRF_REG_RF_SETUP, NRF_RF_SETUP_RF_PWR_MASK, level);
+}
+
+uint8_t NRF24_get_pa_level(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	return NRF24_read_reg_cached(radio, NRF_REG_RF_SETUP) & NRF_RF_SETUP_RF_PWR_MASK;
+}
+
 void NRF24_set_tx_address(nrf_radio *radio, const uint8_t *const addr, size_t size)
 {
     NRF24_ASSERT(radio);
@@ -344,9 +740,7 @@ uint8_t NRF24_get_payload_size(nrf_radio *radio, const nrf_pld_size pipe)
 {
 	NRF24_ASSERT(radio);
 
-    uint8_t payload_size;
-    NRF24_read_reg(radio, pipe, &payload_size, 1);
-    return payload_size;
+    return NRF24_read_reg_cached(radio, (nrf_register) pipe);
 }
 
 void NRF24_reuse_last_transmitted_payload(nrf_radio *radio)
@@ -439,6 +833,21 @@ void NRF24_start_listening(nrf_radio *radio)
 	NRF24_ASSERT(radio->write_ce_cb);
 
 	NRF24_hal_set_ce(radio, GPIO_SET);
+	/* Wait for the PLL to settle before the radio is actually listening
+	 * (and for the power up to end, if it hasn't) */
+	NRF24_power_settle(radio, NRF_POWER_PENDING_UP | NRF_POWER_PENDING_CE);
+}
+
+uint32_t NRF24_start_listening_begin(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->write_ce_cb);
+	NRF24_ASSERT(radio->time_us_cb);
+
+	radio->service_steps |= NRF_SERVICE_CE_HIGH;
+	NRF24_service(radio, NRF24_hal_time_us(radio));
+
+	return NRF24_service_deadline(radio);
 }
 
 void NRF24_stop_listening(nrf_radio *radio)
@@ -456,15 +865,28 @@ void NRF24_transmit_pulse(nrf_radio *radio)
 	NRF24_ASSERT(radio->delay_ms_cb);
 
 	NRF24_hal_set_ce(radio, GPIO_SET);
-	NRF24_hal_delay(radio, NRF_CE_PULSE_WIDTH_US);
+	NRF24_hal_delay_us(radio, NRF_CE_PULSE_WIDTH_US);
 	NRF24_hal_set_ce(radio, GPIO_CLEAR);
 }
 
+uint32_t NRF24_transmit_pulse_begin(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->write_ce_cb);
+	NRF24_ASSERT(radio->time_us_cb);
+
+	/* A pulse still going on is stretched to 15us from now */
+	radio->service_steps |= NRF_SERVICE_CE_HIGH | NRF_SERVICE_CE_LOW;
+	NRF24_service(radio, NRF24_hal_time_us(radio));
+
+	return NRF24_service_deadline(radio);
+}
+
 uint8_t NRF24_get_status(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    return NRF24_cmd_nop(radio);
+    return NRF24_read_status_cached(radio);
 }
 
 uint8_t NRF24_get_fifo_status(nrf_radio *radio)
@@ -483,8 +905,11 @@ uint8_t NRF24_get_retransmissions_count(nrf_radio *radio)
 
     uint8_t count;
     NRF24_read_reg(radio, NRF_REG_OBSERVE_TX, &count, 1);
+    count &= NRF_OBSERVE_TX_ARC_CNT_MASK;
+
+    NRF24_STATS_ADD(radio, arc, count);
 
-    return count & NRF_OBSERVE_TX_ARC_CNT_MASK;
+    return count;
 }
 
 uint8_t NRF24_get_lost_packets_count(nrf_radio *radio)
@@ -494,8 +919,20 @@ uint8_t NRF24_get_lost_packets_count(nrf_radio *radio)
     uint8_t lostPackets;
     NRF24_read_reg(radio, NRF_REG_OBSERVE_TX, &lostPackets, 1);
     lostPackets = lostPackets & NRF_OBSERVE_TX_PLOS_CNT_MASK;
+    lostPackets = lostPackets >> NRF_OBSERVE_TX_BIT_PLOS_CNT;
+
+#if defined(NRF24_ENABLE_STATS)
+    /* PLOS_CNT saturates at 15 and it's reset when RF_CH is written, only
+     * accumulate what it went up since the last read */
+    if (lostPackets >= radio->stats_plos) {
+        NRF24_STATS_ADD(radio, plos, lostPackets - radio->stats_plos);
+    } else {
+        NRF24_STATS_ADD(radio, plos, lostPackets);
+    }
+    radio->stats_plos = lostPackets;
+#endif
 
-    return lostPackets >> NRF_OBSERVE_TX_BIT_PLOS_CNT;
+    return lostPackets;
 }
 
 void NRF24_put_in_tx_fifo(nrf_radio *radio, const uint8_t* payload, size_t payload_size)
@@ -517,6 +954,107 @@ void NRF24_transmit(nrf_radio *radio, const uint8_t* payload, size_t payload_siz
     NRF24_transmit_pulse(radio);
 }
 
+uint32_t NRF24_transmit_begin(nrf_radio *radio, const uint8_t* payload, size_t payload_size)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(payload);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+    NRF24_put_in_tx_fifo(radio, payload, payload_size);
+
+    return NRF24_transmit_pulse_begin(radio);
+}
+
+nrf_irq NRF24_transmit_stream(nrf_radio *radio, const uint8_t *payloads,
+	size_t payload_size, size_t count, size_t *queued)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->write_ce_cb);
+	NRF24_ASSERT(payloads);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+	nrf_irq result = NRF_TX_DS_IRQ;
+	size_t written = 0;
+
+	/* Nothing to send, unless payloads were left by a previous MAX_RT */
+	if ((0 == count) &&
+		NRF24_read_bit(radio, NRF_REG_FIFO_STATUS, NRF_FIFO_STATUS_BIT_TX_EMPTY)) {
+		if (NULL != queued) {
+			*queued = 0;
+		}
+
+		return result;
+	}
+
+	uint8_t status = NRF24_cmd_nop(radio);
+
+	/* Pre-fill the TX FIFO */
+	while ((written < count) && !(NRF_STATUS_TX_FULL_MASK & status)) {
+		NRF24_cmd_write_tx_payload(radio, &payloads[written * payload_size], payload_size);
+		written++;
+		status = NRF24_cmd_nop(radio);
+	}
+
+	NRF24_hal_set_ce(radio, GPIO_SET);
+
+	/* Give up when no payload was sent for too long, i.e. the radio is
+	 * powered down or a receiver */
+	const uint8_t timed = (NULL != radio->time_us_cb);
+	uint32_t since = timed ? NRF24_hal_time_us(radio) : 0;
+	uint32_t polls = 0;
+
+	for (;;) {
+		if (NRF_STATUS_MAX_RT_MASK & status) {
+			result = NRF_MAX_RT_IRQ;
+			break;
+		}
+
+		if (NRF_STATUS_TX_DS_MASK & status) {
+			uint8_t tx_ds = NRF_STATUS_TX_DS_MASK;
+			NRF24_write_reg(radio, NRF_REG_STATUS, &tx_ds, 1);
+
+			/* Refill the TX FIFO */
+			while ((written < count) && !(NRF_STATUS_TX_FULL_MASK & status)) {
+				NRF24_cmd_write_tx_payload(radio, &payloads[written * payload_size],
+					payload_size);
+				written++;
+				status = NRF24_cmd_nop(radio);
+			}
+
+			/* TX_DS was cleared after the last payload may have been sent,
+			 * so check the TX FIFO instead of waiting for another TX_DS */
+			if ((written == count) && NRF24_read_bit(radio, NRF_REG_FIFO_STATUS,
+				NRF_FIFO_STATUS_BIT_TX_EMPTY)) {
+				break;
+			}
+
+			since = timed ? NRF24_hal_time_us(radio) : 0;
+			polls = 0;
+		} else if (timed ? ((uint32_t) (NRF24_hal_time_us(radio) - since) >= NRF_TX_TIMEOUT_US) :
+			(NRF_TX_TIMEOUT_POLLS <= ++polls)) {
+			result = NRF_NONE_IRQ;
+			break;
+		}
+
+		status = NRF24_cmd_nop(radio);
+	}
+
+	NRF24_hal_set_ce(radio, GPIO_CLEAR);
+
+	if (NRF_MAX_RT_IRQ == result) {
+		/* The payload that failed and the ones behind it stay on the TX
+		 * FIFO, with MAX_RT cleared the next CE pulse retries them */
+		uint8_t irqs = NRF_STATUS_MAX_RT_MASK | NRF_STATUS_TX_DS_MASK;
+		NRF24_write_reg(radio, NRF_REG_STATUS, &irqs, 1);
+	}
+
+	if (NULL != queued) {
+		*queued = written;
+	}
+
+	return result;
+}
+
 uint8_t NRF24_is_data_ready(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
@@ -535,6 +1073,14 @@ void NRF24_get_rx_payload(nrf_radio *radio, uint8_t *payload, const size_t paylo
     NRF24_hal_set_ce(radio, GPIO_SET);
 }
 
+size_t NRF24_receive_all(nrf_radio *radio, nrf_packet *packets, const size_t max_packets)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(packets);
+
+	return NRF24_drain_rx_fifo(radio, packets, max_packets, NULL);
+}
+
 void NRF24_tx_transmit_no_ack(nrf_radio *radio, const uint8_t *payload, size_t payload_size)
 {
 	NRF24_ASSERT(radio);
@@ -562,9 +1108,8 @@ uint8_t NRF24_get_data_pipe_with_payload(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    uint8_t pipe;
-    NRF24_read_reg(radio, NRF_REG_STATUS, &pipe, 1);
-    return (pipe & NRF_STATUS_PIPES_MASK) >> NRF_STATUS_PIPES_SHIFT;
+    const uint8_t status = NRF24_read_status_cached(radio);
+    return (status & NRF_STATUS_PIPES_MASK) >> NRF_STATUS_PIPES_SHIFT;
 }
 
 uint8_t NRF24_received_power_detector(nrf_radio *radio)
@@ -578,7 +1123,8 @@ uint8_t NRF24_is_tx_fifo_full(nrf_radio *radio)
 {
 	NRF24_ASSERT(radio);
 
-    return NRF24_read_bit(radio, NRF_REG_FIFO_STATUS, NRF_FIFO_STATUS_BIT_TX_FULL);
+    /* STATUS mirrors the TX_FULL flag of FIFO_STATUS */
+    return 0 != (NRF_STATUS_TX_FULL_MASK & NRF24_read_status_cached(radio));
 }
 
 uint8_t NRF24_is_rx_fifo_empty(nrf_radio *radio)
@@ -603,31 +1149,94 @@ void NRF24_clear_all_irqs(nrf_radio *radio)
     NRF24_write_reg(radio, NRF_REG_STATUS, &mask, 1);
 }
 
+void NRF24_set_irq_handler(nrf_radio *radio, const nrf_irq irq,
+	nrf_irq_handler handler, void *context)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT((NRF_RX_DR_IRQ == irq) || (NRF_TX_DS_IRQ == irq) ||
+		(NRF_MAX_RT_IRQ == irq));
+
+	size_t idx = 0;
+	while (((uint8_t) NRF_MAX_RT_IRQ << idx) != (uint8_t) irq) {
+		idx++;
+	}
+
+	radio->irq_handlers[idx] = handler;
+	radio->irq_contexts[idx] = context;
+}
+
+void NRF24_set_rings(nrf_radio *radio, nrf_ring *rx_ring, nrf_ring *tx_ring)
+{
+	NRF24_ASSERT(radio);
+
+	radio->rx_ring = rx_ring;
+	radio->tx_ring = tx_ring;
+}
+
 void NRF24_clear_irq_flag(nrf_radio *radio, const nrf_irq irq_flag)
 {
 	NRF24_ASSERT(radio);
 
-    uint8_t status = NRF24_get_status(radio);
-    status |= (uint8_t) irq_flag;
-    
-    NRF24_write_reg(radio, NRF_REG_STATUS, &status, 1);
+    /* Writing 0 to the other flags leave them untouched */
+    uint8_t flag = (uint8_t) irq_flag & NRF_ALL_IRQ_MASK;
+    NRF24_write_reg(radio, NRF_REG_STATUS, &flag, 1);
 }
 
 nrf_irq NRF24_get_irq_flag(nrf_radio *radio)
 {
     NRF24_ASSERT(radio);
 
-    return (nrf_irq) NRF_ALL_IRQ_MASK & NRF24_cmd_nop(radio);
+    return (nrf_irq) NRF_ALL_IRQ_MASK & NRF24_read_status_cached(radio);
 }
 
 nrf_irq NRF24_poll_interrupt(nrf_radio *radio)
 {
-	nrf_irq irq = NRF_NONE_IRQ;
 	NRF24_ASSERT(radio);
 
-	/* TODO */
+	const uint8_t tx_queued = (NULL != radio->tx_ring) &&
+		(0 != NRF24_ring_count(radio->tx_ring));
+
+	/* The IRQ signal is active low, while it's high there's nothing to do
+	 * (unless there are packets waiting to be moved into the TX FIFO) */
+	if (!tx_queued && (NULL != radio->read_irq_cb) &&
+		(GPIO_SET == NRF24_hal_get_irq(radio))) {
+		return NRF_NONE_IRQ;
+	}
+
+	const uint8_t status = NRF24_cmd_nop(radio);
+	const uint8_t irqs = status & NRF_ALL_IRQ_MASK;
+
+	/* Clear only the flags we got, a flag set after the read is kept for
+	 * the next poll. With a RX ring RX_DR is cleared once the RX FIFO is
+	 * drained, so it stays set if the ring gets full */
+	uint8_t clear = irqs;
 
-	return irq;
+	if (NULL != radio->rx_ring) {
+		clear &= (uint8_t) ~NRF_STATUS_RX_DR_MASK;
+	}
+
+	if (0 != clear) {
+		NRF24_write_reg(radio, NRF_REG_STATUS, &clear, 1);
+	}
+
+	if ((NULL != radio->rx_ring) && (NRF_STATUS_RX_DR_MASK & irqs)) {
+		NRF24_drain_rx_fifo(radio, NULL, 0, radio->rx_ring);
+	}
+
+	if (tx_queued) {
+		NRF24_fill_tx_fifo(radio, radio->tx_ring, status);
+	}
+
+	/* RX_DR first, so the RX FIFO is serviced as soon as possible */
+	for (size_t idx = NRF_IRQ_HANDLERS; idx > 0; idx--) {
+		const uint8_t flag = (uint8_t) NRF_MAX_RT_IRQ << (idx - 1);
+
+		if ((irqs & flag) && (NULL != radio->irq_handlers[idx - 1])) {
+			radio->irq_handlers[idx - 1](radio, status, radio->irq_contexts[idx - 1]);
+		}
+	}
+
+	return (nrf_irq) irqs;
 }
 
 uint8_t NRF24_get_status_clear_irq(nrf_radio *radio)
@@ -653,3 +1262,104 @@ void NRF24_flush_tx(nrf_radio *radio)
     NRF24_cmd_flush_tx(radio);
 }
 
+static size_t NRF24_drain_rx_fifo(nrf_radio *radio, nrf_packet *packets,
+	const size_t max_packets, nrf_ring *ring)
+{
+	size_t received = 0;
+	const uint8_t dynpd = NRF24_read_reg_cached(radio, NRF_REG_DYNPD);
+
+	for (;;) {
+		nrf_packet *packet = (NULL == packets) ? NRF24_ring_reserve(ring) :
+			((received < max_packets) ? &packets[received] : NULL);
+
+		if (NULL == packet) {
+			break;
+		}
+
+		uint8_t width = 0;
+		/* R_RX_PL_WID gives us the STATUS register and the width of the
+		 * payload on top of the RX FIFO in a single transaction */
+		uint8_t status = (0 != dynpd) ? NRF24_cmd_read_payload_width(radio, &width)
+			: NRF24_cmd_nop(radio);
+		const uint8_t pipe = (status & NRF_STATUS_PIPES_MASK) >> NRF_STATUS_PIPES_SHIFT;
+
+		if (NRF_PIPE5 < pipe) {
+			/* RX FIFO empty, clear RX_DR. A packet received before the flag
+			 * is cleared shows up in the STATUS returned by the write */
+			if (!(NRF_STATUS_RX_DR_MASK & status)) {
+				break;
+			}
+
+			uint8_t rx_dr = NRF_STATUS_RX_DR_MASK;
+			status = NRF24_write_reg(radio, NRF_REG_STATUS, &rx_dr, 1);
+
+			if (NRF_STATUS_PIPES_MASK == (status & NRF_STATUS_PIPES_MASK)) {
+				break;
+			}
+
+			continue;
+		}
+
+		if (!(dynpd & (1U << pipe))) {
+			width = NRF24_read_reg_cached(radio, (nrf_register) (NRF_REG_RX_PW_P0 + pipe));
+		} else if (NRF_PAYLOAD_SIZE_MAX < width) {
+			/* Corrupted packet, the datasheet asks to flush the RX FIFO */
+			NRF24_cmd_flush_rx(radio);
+			continue;
+		}
+
+		packet->pipe = pipe;
+		packet->payload_size = width;
+		NRF24_cmd_read_rx_payload(radio, packet->payload, width);
+		received++;
+
+		if (NULL == packets) {
+			NRF24_ring_commit(ring);
+		}
+	}
+
+	return received;
+}
+
+static void NRF24_fill_tx_fifo(nrf_radio *radio, nrf_ring *ring, uint8_t status)
+{
+	nrf_packet *packet;
+
+	while (!(NRF_STATUS_TX_FULL_MASK & status) && (NULL != (packet = NRF24_ring_peek(ring)))) {
+		NRF24_cmd_write_tx_payload(radio, packet->payload, packet->payload_size);
+		NRF24_ring_release(ring);
+		status = NRF24_cmd_nop(radio);
+	}
+}
+
+static void NRF24_power_write_config(nrf_radio *radio, const uint8_t mask, const uint8_t value)
+{
+	if ((NRF_POWER_UNKNOWN != radio->power_config) && ((radio->power_config & mask) == value)) {
+		return;
+	}
+
+	/* NRF24_write_bits keeps power_config up to date */
+	NRF24_write_bits(radio, NRF_REG_CONFIG, mask, value);
+}
+
+static void NRF24_power_ce_low(nrf_radio *radio)
+{
+	/* A transmitter may be sending a payload, it needs CE high for Thce */
+	if ((GPIO_SET == radio->power_ce) && ((NRF_POWER_UNKNOWN == radio->power_config) ||
+		!(radio->power_config & NRF_CONFIG_RECEIVER))) {
+		NRF24_power_wait(radio, radio->ce_high_time, NRF_CE_HIGH_MIN_US);
+	}
+
+	NRF24_hal_set_ce(radio, GPIO_CLEAR);
+}
+
+static int NRF24_deadline_reached(const uint32_t now, const uint32_t deadline)
+{
+	/* Deadlines are less than half the timestamp range away */
+	return (uint32_t) (now - deadline) < 0x80000000UL;
+}
+
+static uint32_t NRF24_deadline_first(const uint32_t a, const uint32_t b)
+{
+	return NRF24_deadline_reached(b, a) ? a : b;
+}
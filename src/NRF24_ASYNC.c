@@ -0,0 +1,270 @@
+/**
+* @file     NRF24_ASYNC.c
+* @version  0.1
+*
+* @brief    Non-blocking operations, define NRF24_ENABLE_ASYNC to use them.
+*/
+
+#include "NRF24_ASYNC.h"
+
+#if defined(NRF24_ENABLE_ASYNC)
+
+#include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+
+/* Operations */
+typedef enum {
+	NRF_ASYNC_OP_NONE,
+	NRF_ASYNC_OP_READ_REG,
+	NRF_ASYNC_OP_WRITE_REG,
+	NRF_ASYNC_OP_WRITE_PAYLOAD,
+	NRF_ASYNC_OP_READ_PAYLOAD,
+	NRF_ASYNC_OP_CLEAR_IRQ,
+} nrf_async_op;
+
+/**
+ * @brief Claim the async state of the radio for @p op.
+ *
+ * @return 0 on success, 1 if there is an operation in progress already.
+ */
+static int NRF24_async_begin(nrf_radio *radio, const nrf_async_op op,
+	nrf_async_done done_cb, void *context);
+
+/**
+ * @brief Start the transfer of the first @p xfer_size bytes of the async
+ * buffers.
+ */
+static void NRF24_async_xfer(nrf_radio *radio, const size_t xfer_size);
+
+/**
+ * @brief Release the async state of the radio and call the done callback.
+ */
+static void NRF24_async_finish(nrf_radio *radio);
+
+void NRF24_set_spi_xfer_async_cb(nrf_radio *radio, nrf_spi_xfer_async spi_xfer_async_cb)
+{
+	NRF24_ASSERT(radio);
+
+	radio->spi_xfer_async_cb = spi_xfer_async_cb;
+}
+
+uint8_t NRF24_async_is_busy(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	return NRF_ASYNC_OP_NONE != radio->async.op;
+}
+
+int NRF24_async_read_reg(nrf_radio *radio, const nrf_register reg,
+	uint8_t *data, const size_t data_size, nrf_async_done done_cb, void *context)
+{
+	NRF24_ASSERT(data);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= data_size);
+
+	if (NRF24_async_begin(radio, NRF_ASYNC_OP_READ_REG, done_cb, context)) {
+		return 1;
+	}
+
+	nrf_async *async = &radio->async;
+
+	async->in[0] = (uint8_t) (NRF_CMD_R_REGISTER | reg);
+	for (size_t idx = 0; idx < data_size; idx++) {
+		async->in[idx + 1] = NRF_CMD_NOP;
+	}
+
+	async->data = data;
+	async->data_size = data_size;
+
+	NRF24_async_xfer(radio, data_size + 1);
+
+	return 0;
+}
+
+int NRF24_async_write_reg(nrf_radio *radio, const nrf_register reg,
+	const uint8_t *data, const size_t data_size, nrf_async_done done_cb, void *context)
+{
+	NRF24_ASSERT(data);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= data_size);
+
+	if (NRF24_async_begin(radio, NRF_ASYNC_OP_WRITE_REG, done_cb, context)) {
+		return 1;
+	}
+
+	nrf_async *async = &radio->async;
+
+	async->in[0] = (uint8_t) (NRF_CMD_W_REGISTER | reg);
+	for (size_t idx = 0; idx < data_size; idx++) {
+		async->in[idx + 1] = data[idx];
+	}
+
+	async->data_size = data_size;
+
+	NRF24_async_xfer(radio, data_size + 1);
+
+	return 0;
+}
+
+int NRF24_async_put_in_tx_fifo(nrf_radio *radio, const uint8_t *payload,
+	const size_t payload_size, nrf_async_done done_cb, void *context)
+{
+	NRF24_ASSERT(payload);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+	if (NRF24_async_begin(radio, NRF_ASYNC_OP_WRITE_PAYLOAD, done_cb, context)) {
+		return 1;
+	}
+
+	nrf_async *async = &radio->async;
+
+	async->in[0] = (uint8_t) NRF_CMD_W_TX_PAYLOAD;
+	NRF24_STATS_ADD(radio, packets_sent, 1);
+	for (size_t idx = 0; idx < payload_size; idx++) {
+		async->in[idx + 1] = payload[idx];
+	}
+
+	NRF24_async_xfer(radio, payload_size + 1);
+
+	return 0;
+}
+
+int NRF24_async_get_rx_payload(nrf_radio *radio, uint8_t *payload,
+	const size_t payload_size, nrf_async_done done_cb, void *context)
+{
+	NRF24_ASSERT(payload);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= payload_size);
+
+	if (NRF24_async_begin(radio, NRF_ASYNC_OP_READ_PAYLOAD, done_cb, context)) {
+		return 1;
+	}
+
+	nrf_async *async = &radio->async;
+
+	async->in[0] = (uint8_t) NRF_CMD_R_RX_PAYLOAD;
+	NRF24_STATS_ADD(radio, packets_received, 1);
+	for (size_t idx = 0; idx < payload_size; idx++) {
+		async->in[idx + 1] = NRF_CMD_NOP;
+	}
+
+	async->data = payload;
+	async->data_size = payload_size;
+
+	NRF24_hal_set_ce(radio, GPIO_CLEAR);
+	NRF24_async_xfer(radio, payload_size + 1);
+
+	return 0;
+}
+
+int NRF24_async_clear_irq_flag(nrf_radio *radio, const nrf_irq irq_flag,
+	nrf_async_done done_cb, void *context)
+{
+	if (NRF24_async_begin(radio, NRF_ASYNC_OP_CLEAR_IRQ, done_cb, context)) {
+		return 1;
+	}
+
+	nrf_async *async = &radio->async;
+
+	/* Writing 0 to the other flags leave them untouched */
+	async->in[0] = (uint8_t) (NRF_CMD_W_REGISTER | NRF_REG_STATUS);
+	async->in[1] = (uint8_t) irq_flag & NRF_ALL_IRQ_MASK;
+
+	NRF24_async_xfer(radio, 2);
+
+	return 0;
+}
+
+void NRF24_async_xfer_complete(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	nrf_async *async = &radio->async;
+
+	switch (async->op) {
+	case NRF_ASYNC_OP_READ_REG:
+		for (size_t idx = 0; idx < async->data_size; idx++) {
+			async->data[idx] = async->out[idx + 1];
+		}
+
+		NRF24_reg_cache_update(radio, (nrf_register) (async->in[0] & ~NRF_CMD_R_REGISTER),
+			async->data, async->data_size);
+		NRF24_async_finish(radio);
+		break;
+	case NRF_ASYNC_OP_WRITE_REG:
+		NRF24_reg_cache_update(radio, (nrf_register) (async->in[0] & ~NRF_CMD_W_REGISTER),
+			&async->in[1], async->data_size);
+		NRF24_async_finish(radio);
+		break;
+	case NRF_ASYNC_OP_WRITE_PAYLOAD:
+		NRF24_async_finish(radio);
+		break;
+	case NRF_ASYNC_OP_READ_PAYLOAD:
+		for (size_t idx = 0; idx < async->data_size; idx++) {
+			async->data[idx] = async->out[idx + 1];
+		}
+
+		NRF24_hal_set_ce(radio, GPIO_SET);
+		NRF24_async_finish(radio);
+		break;
+	case NRF_ASYNC_OP_CLEAR_IRQ: {
+#if defined(NRF24_ENABLE_STATS)
+		const uint8_t cleared = async->out[0] & async->in[1];
+
+		NRF24_STATS_ADD(radio, tx_ds, 0 != (cleared & NRF_STATUS_TX_DS_MASK));
+		NRF24_STATS_ADD(radio, max_rt, 0 != (cleared & NRF_STATUS_MAX_RT_MASK));
+		NRF24_STATS_ADD(radio, rx_dr, 0 != (cleared & NRF_STATUS_RX_DR_MASK));
+#endif
+		NRF24_async_finish(radio);
+		break;
+	}
+	default:
+		/* Spurious completion, nothing in progress */
+		break;
+	}
+}
+
+static int NRF24_async_begin(nrf_radio *radio, const nrf_async_op op,
+	nrf_async_done done_cb, void *context)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(radio->spi_xfer_async_cb);
+
+	nrf_async *async = &radio->async;
+
+	if (NRF_ASYNC_OP_NONE != async->op) {
+		return 1;
+	}
+
+	async->op = (uint8_t) op;
+	async->done_cb = done_cb;
+	async->context = context;
+
+	return 0;
+}
+
+static void NRF24_async_xfer(nrf_radio *radio, const size_t xfer_size)
+{
+	NRF24_STATS_ADD(radio, spi_transactions, 1);
+	NRF24_STATS_ADD(radio, spi_bytes, xfer_size);
+
+	/* The transfer doesn't go through the HAL, STATUS isn't kept */
+	NRF24_status_cache_invalidate(radio);
+
+	radio->spi_xfer_async_cb(radio->async.in, radio->async.out, xfer_size);
+}
+
+static void NRF24_async_finish(nrf_radio *radio)
+{
+	nrf_async *async = &radio->async;
+
+	/* Copy what the done callback needs, it may start a new operation */
+	const uint8_t status = async->out[0];
+	nrf_async_done done_cb = async->done_cb;
+	void *context = async->context;
+
+	async->op = NRF_ASYNC_OP_NONE;
+
+	if (NULL != done_cb) {
+		done_cb(radio, status, context);
+	}
+}
+
+#endif /* NRF24_ENABLE_ASYNC */
@@ -0,0 +1,149 @@
+/**
+* @file     NRF24_BATCH.c
+* @version  0.1
+*
+* @brief    Queue several commands and register accesses and send them to the
+* radio at once.
+*/
+
+#include "NRF24_BATCH.h"
+#include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+
+/* W_REGISTER commands are 001A AAAA, R_REGISTER commands are 000A AAAA */
+enum {
+	NRF_CMD_REGISTER_MASK	= 0xE0,
+	NRF_CMD_REG_ADDR_MASK	= 0x1F,
+};
+
+/**
+ * @brief Reserve room for a command of @p xfer_size bytes.
+ *
+ * @return Pointer to the bytes to be sent, NULL if there's no room left.
+ */
+static uint8_t *NRF24_batch_push(nrf_batch *batch, const size_t xfer_size);
+
+void NRF24_batch_init(nrf_batch *batch, uint8_t *in, uint8_t *out,
+	const size_t buffer_size, nrf_spi_segment *segments, const size_t max_segments)
+{
+	NRF24_ASSERT(batch);
+	NRF24_ASSERT(in);
+	NRF24_ASSERT(out);
+	NRF24_ASSERT(segments);
+
+	batch->in = in;
+	batch->out = out;
+	batch->buffer_size = buffer_size;
+	batch->segments = segments;
+	batch->max_segments = max_segments;
+
+	NRF24_batch_reset(batch);
+}
+
+void NRF24_batch_reset(nrf_batch *batch)
+{
+	NRF24_ASSERT(batch);
+
+	batch->used = 0;
+	batch->count = 0;
+}
+
+int NRF24_batch_cmd(nrf_batch *batch, const nrf_cmd cmd)
+{
+	return NRF24_batch_cmd_with_data(batch, (uint8_t) cmd, NULL, 0);
+}
+
+int NRF24_batch_cmd_with_data(nrf_batch *batch, const uint8_t cmd,
+	const uint8_t *data, const size_t data_size)
+{
+	NRF24_ASSERT(batch);
+
+	uint8_t *xfer = NRF24_batch_push(batch, data_size + 1);
+
+	if (NULL == xfer) {
+		return 1;
+	}
+
+	xfer[0] = cmd;
+
+	for (size_t idx = 0; idx < data_size; idx++) {
+		xfer[idx + 1] = (NULL != data) ? data[idx] : (uint8_t) NRF_CMD_NOP;
+	}
+
+	return 0;
+}
+
+int NRF24_batch_write_reg(nrf_batch *batch, const nrf_register reg,
+	const uint8_t *data, const size_t data_size)
+{
+	NRF24_ASSERT(data);
+
+	return NRF24_batch_cmd_with_data(batch,
+		(uint8_t) (NRF_CMD_W_REGISTER | reg), data, data_size);
+}
+
+int NRF24_batch_read_reg(nrf_batch *batch, const nrf_register reg, const size_t data_size)
+{
+	return NRF24_batch_cmd_with_data(batch,
+		(uint8_t) (NRF_CMD_R_REGISTER | reg), NULL, data_size);
+}
+
+void NRF24_batch_submit(nrf_radio *radio, nrf_batch *batch)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(batch);
+
+	if (0 == batch->count) {
+		return;
+	}
+
+	NRF24_hal_spi_xfer_vec(radio, batch->segments, batch->count);
+
+	/* Keep the register cache up to date */
+	for (size_t idx = 0; idx < batch->count; idx++) {
+		const nrf_spi_segment *segment = &batch->segments[idx];
+		const uint8_t cmd = segment->in[0];
+		const nrf_register reg = (nrf_register) (cmd & NRF_CMD_REG_ADDR_MASK);
+
+		if (NRF_CMD_W_REGISTER == (cmd & NRF_CMD_REGISTER_MASK)) {
+			NRF24_reg_cache_update(radio, reg, &segment->in[1], segment->xfer_size - 1);
+		} else if (NRF_CMD_R_REGISTER == (cmd & NRF_CMD_REGISTER_MASK)) {
+			NRF24_reg_cache_update(radio, reg, &segment->out[1], segment->xfer_size - 1);
+		}
+	}
+}
+
+uint8_t NRF24_batch_status(const nrf_batch *batch, const size_t idx)
+{
+	NRF24_ASSERT(batch);
+	NRF24_ASSERT(batch->count > idx);
+
+	return batch->segments[idx].out[0];
+}
+
+const uint8_t *NRF24_batch_data(const nrf_batch *batch, const size_t idx)
+{
+	NRF24_ASSERT(batch);
+	NRF24_ASSERT(batch->count > idx);
+
+	return &batch->segments[idx].out[1];
+}
+
+static uint8_t *NRF24_batch_push(nrf_batch *batch, const size_t xfer_size)
+{
+	if ((batch->max_segments <= batch->count) ||
+		(batch->buffer_size - batch->used < xfer_size)) {
+		return NULL;
+	}
+
+	nrf_spi_segment *segment = &batch->segments[batch->count];
+
+	segment->in = &batch->in[batch->used];
+	segment->out = &batch->out[batch->used];
+	segment->xfer_size = xfer_size;
+
+	batch->used += xfer_size;
+	batch->count++;
+
+	return &batch->in[batch->used - xfer_size];
+}
@@ -19,6 +19,20 @@
  */
 static uint8_t NRF24_send_cmd(nrf_radio *radio, const nrf_cmd cmd);
 
+/**
+ * @brief Send the @c cmd followed by a payload to the NRF24.
+ *
+ * The payload is passed as is to the scatter/gather SPI callback when
+ * available, otherwise it's copied into a temporary buffer.
+ *
+ * @param[in]	cmd: Command byte.
+ * @param[in]	payload_in: Payload to be sent, NULL to send dummy bytes.
+ * @param[out]	payload_out: Where to store the bytes read, NULL to discard them.
+ * @param[in]	payload_size: Bytes of payload.
+ */
+static uint8_t NRF24_send_payload_cmd(nrf_radio *radio, const uint8_t cmd,
+    const uint8_t *payload_in, uint8_t *payload_out, const size_t payload_size);
+
 uint8_t NRF24_cmd_reuse_tx_payload(nrf_radio *radio)
 {
     return NRF24_send_cmd(radio, NRF_CMD_REUSE_TX_PL);
@@ -36,38 +50,16 @@ uint8_t NRF24_cmd_flush_tx(nrf_radio *radio)
 
 uint8_t NRF24_cmd_read_rx_payload(nrf_radio *radio, uint8_t *payload, const size_t payload_size)
 {
-    uint8_t nrf_data_out[payload_size + 1];
+    NRF24_STATS_ADD(radio, packets_received, 1);
 
-    // the nrf_data_in array is to keep the spi sending dummy bytes so the
-    // radio can send us the payload, there's no need to set the array to
-    // any specific value, apart of the first element being the command
-    uint8_t nrf_data_in[payload_size + 1];
-    
-    nrf_data_in[0] = (uint8_t) NRF_CMD_R_RX_PAYLOAD;
-    
-    NRF24_hal_spi_xfer(radio, nrf_data_in, nrf_data_out, sizeof nrf_data_out);
-    
-    for (size_t idx = 0; idx < payload_size; idx++) {
-    	payload[idx] = nrf_data_out[idx + 1];
-    }
-
-    return nrf_data_out[0];
+    return NRF24_send_payload_cmd(radio, NRF_CMD_R_RX_PAYLOAD, NULL, payload, payload_size);
 }
 
 uint8_t NRF24_cmd_write_tx_payload(nrf_radio *radio, const uint8_t *payload, const size_t payload_size)
 {
-    uint8_t nrf_data_in[payload_size + 1];
-    uint8_t nrf_data_out[payload_size + 1];
-    
-    nrf_data_in[0] = (uint8_t) NRF_CMD_W_TX_PAYLOAD;
-
-    for (size_t idx = 0; idx < payload_size; idx++) {
-    	nrf_data_in[idx + 1] = payload[idx];
-    }
-    
-    NRF24_hal_spi_xfer(radio, nrf_data_in, nrf_data_out, sizeof nrf_data_in);
+    NRF24_STATS_ADD(radio, packets_sent, 1);
 
-    return nrf_data_out[0];
+    return NRF24_send_payload_cmd(radio, NRF_CMD_W_TX_PAYLOAD, payload, NULL, payload_size);
 }
 
 uint8_t NRF24_cmd_read_payload_width(nrf_radio *radio, uint8_t *payload_width)
@@ -87,34 +79,15 @@ uint8_t NRF24_cmd_read_payload_width(nrf_radio *radio, uint8_t *payload_width)
 uint8_t NRF24_cmd_payload_write_ack(nrf_radio *radio, const nrf_pipe pipe,
 		const uint8_t* payload, const size_t payload_size)
 {
-    uint8_t nrf_data_in[payload_size + 1];
-    uint8_t nrf_data_out[payload_size + 1];
-    
-    nrf_data_in[0] = (uint8_t) (NRF_CMD_W_ACK_PAYLOAD | pipe);
-
-    for (size_t idx = 0; idx < payload_size; idx++) {
-    	nrf_data_in[idx + 1] = payload[idx];
-    }
-    
-    NRF24_hal_spi_xfer(radio, nrf_data_in, nrf_data_out, sizeof nrf_data_in);
-
-    return nrf_data_out[0];
+    return NRF24_send_payload_cmd(radio, (uint8_t) (NRF_CMD_W_ACK_PAYLOAD | pipe),
+        payload, NULL, payload_size);
 }
 
 uint8_t NRF24_cmd_payload_without_ack(nrf_radio *radio, const uint8_t* payload, const size_t payload_size)
 {
-    uint8_t nrf_data_in[payload_size + 1];
-    uint8_t nrf_data_out[payload_size + 1];
-    
-    nrf_data_in[0] = (uint8_t) NRF_CMD_W_TX_PAYLOAD_NO_ACK;
+    NRF24_STATS_ADD(radio, packets_sent, 1);
 
-    for (size_t idx = 0; idx < payload_size; idx++) {
-    	nrf_data_in[idx + 1] = payload[idx];
-    }
-    
-    NRF24_hal_spi_xfer(radio, nrf_data_in, nrf_data_out, sizeof nrf_data_in);
-
-    return nrf_data_out[0];
+    return NRF24_send_payload_cmd(radio, NRF_CMD_W_TX_PAYLOAD_NO_ACK, payload, NULL, payload_size);
 }
 
 uint8_t NRF24_cmd_nop(nrf_radio *radio)
@@ -128,3 +101,32 @@ static uint8_t NRF24_send_cmd(nrf_radio *radio, const nrf_cmd cmd)
     NRF24_hal_spi_xfer(radio, (uint8_t *) &cmd, &status, 1);
     return status;
 }
+
+static uint8_t NRF24_send_payload_cmd(nrf_radio *radio, const uint8_t cmd,
+    const uint8_t *payload_in, uint8_t *payload_out, const size_t payload_size)
+{
+    if (NULL != radio->spi_xfer_sg_cb) {
+        return NRF24_hal_spi_xfer_sg(radio, cmd, payload_in, payload_out, payload_size);
+    }
+
+    uint8_t nrf_data_in[payload_size + 1];
+    uint8_t nrf_data_out[payload_size + 1];
+
+    nrf_data_in[0] = cmd;
+
+    // when reading the payload we keep the spi sending dummy bytes so the
+    // radio can send us the payload
+    for (size_t idx = 0; idx < payload_size; idx++) {
+        nrf_data_in[idx + 1] = (NULL != payload_in) ? payload_in[idx] : (uint8_t) NRF_CMD_NOP;
+    }
+
+    NRF24_hal_spi_xfer(radio, nrf_data_in, nrf_data_out, sizeof nrf_data_in);
+
+    if (NULL != payload_out) {
+        for (size_t idx = 0; idx < payload_size; idx++) {
+            payload_out[idx] = nrf_data_out[idx + 1];
+        }
+    }
+
+    return nrf_data_out[0];
+}
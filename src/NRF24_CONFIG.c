@@ -0,0 +1,208 @@
+/**
+* @file     NRF24_CONFIG.c
+* @version  0.1
+*
+* @brief    Configure the radio from a register image.
+*/
+
+#include <string.h>
+
+#include "NRF24_CONFIG.h"
+#include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+
+/* W_REGISTER commands are 001A AAAA */
+enum {
+	NRF_CMD_REGISTER_MASK	= 0xE0,
+	NRF_CMD_REG_ADDR_MASK	= 0x1F,
+};
+
+/* Register of the image, address registers have a size of 0 as their size is
+ * given by SETUP_AW */
+typedef struct {
+	uint8_t	reg;
+	uint8_t	offset;
+	uint8_t	size;
+} nrf_config_reg;
+
+/* Order of the writes: the address width before the addresses, FEATURE
+ * before DYNPD and CONFIG (which may power up the radio) at the end */
+static const nrf_config_reg NRF24_config_regs[] = {
+	{NRF_REG_SETUP_AW,	offsetof(nrf_config, setup_aw),		1},
+	{NRF_REG_EN_AA,		offsetof(nrf_config, en_aa),		1},
+	{NRF_REG_EN_RXADDR,	offsetof(nrf_config, en_rxaddr),	1},
+	{NRF_REG_SETUP_RETR,	offsetof(nrf_config, setup_retr),	1},
+	{NRF_REG_RF_CH,		offsetof(nrf_config, rf_ch),		1},
+	{NRF_REG_RF_SETUP,	offsetof(nrf_config, rf_setup),		1},
+	{NRF_REG_RX_ADDR_P0,	offsetof(nrf_config, rx_addr_p0),	0},
+	{NRF_REG_RX_ADDR_P1,	offsetof(nrf_config, rx_addr_p1),	0},
+	{NRF_REG_RX_ADDR_P2,	offsetof(nrf_config, rx_addr_p2_p5) + 0,	1},
+	{NRF_REG_RX_ADDR_P3,	offsetof(nrf_config, rx_addr_p2_p5) + 1,	1},
+	{NRF_REG_RX_ADDR_P4,	offsetof(nrf_config, rx_addr_p2_p5) + 2,	1},
+	{NRF_REG_RX_ADDR_P5,	offsetof(nrf_config, rx_addr_p2_p5) + 3,	1},
+	{NRF_REG_TX_ADDR,	offsetof(nrf_config, tx_addr),		0},
+	{NRF_REG_RX_PW_P0,	offsetof(nrf_config, rx_pw) + 0,	1},
+	{NRF_REG_RX_PW_P1,	offsetof(nrf_config, rx_pw) + 1,	1},
+	{NRF_REG_RX_PW_P2,	offsetof(nrf_config, rx_pw) + 2,	1},
+	{NRF_REG_RX_PW_P3,	offsetof(nrf_config, rx_pw) + 3,	1},
+	{NRF_REG_RX_PW_P4,	offsetof(nrf_config, rx_pw) + 4,	1},
+	{NRF_REG_RX_PW_P5,	offsetof(nrf_config, rx_pw) + 5,	1},
+	{NRF_REG_FEATURE,	offsetof(nrf_config, feature),		1},
+	{NRF_REG_DYNPD,		offsetof(nrf_config, dynpd),		1},
+	{NRF_REG_CONFIG,	offsetof(nrf_config, config),		1},
+};
+
+/**
+ * @return Size (in bytes) of @p reg on @p config.
+ */
+static size_t NRF24_config_size(const nrf_config *config, const nrf_config_reg *reg);
+
+/**
+ * @brief Check if @p reg has to be written to go from @p previous to @p config.
+ */
+static int NRF24_config_changed(const nrf_config *config, const nrf_config *previous,
+	const nrf_config_reg *reg);
+
+void NRF24_config_defaults(nrf_config *config)
+{
+	NRF24_ASSERT(config);
+
+	config->config = NRF_CONFIG_ENABLE_CRC;
+	config->en_aa = NRF_ENABLE_AUTO_ACK_PIPE0 | NRF_ENABLE_AUTO_ACK_PIPE1 |
+		NRF_ENABLE_AUTO_ACK_PIPE2 | NRF_ENABLE_AUTO_ACK_PIPE3 |
+		NRF_ENABLE_AUTO_ACK_PIPE4 | NRF_ENABLE_AUTO_ACK_PIPE5;
+	config->en_rxaddr = NRF_ENABLE_PIPE0 | NRF_ENABLE_PIPE1;
+	config->setup_aw = NRF_SETUP_AW_5BYTES;
+	config->setup_retr = NRF_AUTO_RETRANSMIT_DELAY_250_US | NRF_AUTO_RETRANSMIT_CNT_3;
+	config->rf_ch = 2;
+	config->rf_setup = NRF_RF_SETUP_RF_DR_2000 | NRF_RF_SETUP_RF_PWR_0;
+
+	memset(config->rx_addr_p0, 0xE7, sizeof config->rx_addr_p0);
+	memset(config->rx_addr_p1, 0xC2, sizeof config->rx_addr_p1);
+	for (size_t idx = 0; idx < sizeof config->rx_addr_p2_p5; idx++) {
+		config->rx_addr_p2_p5[idx] = (uint8_t) (0xC3 + idx);
+	}
+	memset(config->tx_addr, 0xE7, sizeof config->tx_addr);
+
+	memset(config->rx_pw, 0, sizeof config->rx_pw);
+	config->dynpd = 0;
+	config->feature = 0;
+}
+
+size_t NRF24_config_apply(nrf_radio *radio, const nrf_config *config,
+	const nrf_config *previous)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(config);
+
+	size_t written = 0;
+
+	for (size_t idx = 0; idx < NRF_ARRAY_SIZE(NRF24_config_regs); idx++) {
+		const nrf_config_reg *reg = &NRF24_config_regs[idx];
+
+		if (!NRF24_config_changed(config, previous, reg)) {
+			continue;
+		}
+
+		NRF24_write_reg(radio, (nrf_register) reg->reg,
+			(const uint8_t *) config + reg->offset, NRF24_config_size(config, reg));
+		written++;
+	}
+
+	/* Tpd2stby if CONFIG powered the radio up, only what's left of it */
+	NRF24_power_settle(radio, NRF_POWER_PENDING_UP);
+
+	return written;
+}
+
+int NRF24_config_queue(nrf_batch *batch, const nrf_config *config,
+	const nrf_config *previous)
+{
+	NRF24_ASSERT(batch);
+	NRF24_ASSERT(config);
+
+	for (size_t idx = 0; idx < NRF_ARRAY_SIZE(NRF24_config_regs); idx++) {
+		const nrf_config_reg *reg = &NRF24_config_regs[idx];
+
+		if (!NRF24_config_changed(config, previous, reg)) {
+			continue;
+		}
+
+		if (NRF24_batch_write_reg(batch, (nrf_register) reg->reg,
+			(const uint8_t *) config + reg->offset, NRF24_config_size(config, reg))) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void NRF24_config_replay(nrf_radio *radio, const uint8_t *sequence)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(sequence);
+
+	uint8_t out[NRF_CONFIG_ADDR_SIZE_MAX + 1];
+
+	while (0 != *sequence) {
+		const size_t xfer_size = *sequence++;
+		const nrf_register reg = (nrf_register) (sequence[0] & NRF_CMD_REG_ADDR_MASK);
+
+		NRF24_ASSERT(sizeof out >= xfer_size);
+		NRF24_ASSERT(NRF_CMD_W_REGISTER == (sequence[0] & NRF_CMD_REGISTER_MASK));
+
+		NRF24_hal_spi_xfer(radio, sequence, out, xfer_size);
+		NRF24_reg_cache_update(radio, reg, &sequence[1], xfer_size - 1);
+
+		sequence += xfer_size;
+	}
+
+	NRF24_power_settle(radio, NRF_POWER_PENDING_UP);
+}
+
+void NRF24_config_read(nrf_radio *radio, nrf_config *config)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(config);
+
+	/* The address bytes beyond the address width aren't read */
+	memset(config, 0, sizeof *config);
+
+	/* SETUP_AW goes first, the size of the addresses depends on it */
+	for (size_t idx = 0; idx < NRF_ARRAY_SIZE(NRF24_config_regs); idx++) {
+		const nrf_config_reg *reg = &NRF24_config_regs[idx];
+
+		NRF24_read_reg(radio, (nrf_register) reg->reg,
+			(uint8_t *) config + reg->offset, NRF24_config_size(config, reg));
+	}
+}
+
+static size_t NRF24_config_size(const nrf_config *config, const nrf_config_reg *reg)
+{
+	if (0 != reg->size) {
+		return reg->size;
+	}
+
+	/* SETUP_AW: 01b - 3 bytes, 10b - 4 bytes, 11b - 5 bytes */
+	const uint8_t aw = config->setup_aw & NRF_SETUP_AW_5BYTES;
+
+	NRF24_ASSERT(0 != aw);
+
+	return (size_t) aw + 2;
+}
+
+static int NRF24_config_changed(const nrf_config *config, const nrf_config *previous,
+	const nrf_config_reg *reg)
+{
+	if (NULL == previous) {
+		return 1;
+	}
+
+	/* The addresses are written again with the new width */
+	if ((0 == reg->size) && (config->setup_aw != previous->setup_aw)) {
+		return 1;
+	}
+
+	return 0 != memcmp((const uint8_t *) config + reg->offset,
+		(const uint8_t *) previous + reg->offset, NRF24_config_size(config, reg));
+}
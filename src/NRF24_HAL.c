@@ -1,13 +1,87 @@
 #include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+
+/**
+ * @brief Keep the STATUS clocked out by a transaction, when it's still right
+ * once the transaction is done.
+ *
+ * The payload and flush commands change the FIFOs (TX_FULL and RX_P_NO)
+ * after STATUS is clocked out, writing STATUS clears the flags written.
+ */
+static void NRF24_hal_keep_status(nrf_radio *radio, const uint8_t *in,
+	const uint8_t *out, size_t xfer_len);
 
 void NRF24_hal_spi_xfer(nrf_radio *radio, const void *send, void *rcv, size_t xfer_len)
 {
+    NRF24_STATS_ADD(radio, spi_transactions, 1);
+    NRF24_STATS_ADD(radio, spi_bytes, xfer_len);
+
     radio->spi_xfer_data_cb(send, rcv, xfer_len);
+    NRF24_TRACE_SPI(radio, send, rcv, xfer_len);
+    NRF24_hal_keep_status(radio, (const uint8_t *) send, (const uint8_t *) rcv, xfer_len);
+}
+
+void NRF24_hal_spi_xfer_vec(nrf_radio *radio, const nrf_spi_segment *segments, size_t count)
+{
+#if defined(NRF24_ENABLE_STATS)
+    NRF24_STATS_ADD(radio, spi_transactions, count);
+    for (size_t idx = 0; idx < count; idx++) {
+        NRF24_STATS_ADD(radio, spi_bytes, segments[idx].xfer_size);
+    }
+#endif
+
+    if (NULL != radio->spi_xfer_vec_cb) {
+        radio->spi_xfer_vec_cb(segments, count);
+    } else {
+        for (size_t idx = 0; idx < count; idx++) {
+            radio->spi_xfer_data_cb(segments[idx].in, segments[idx].out,
+                segments[idx].xfer_size);
+        }
+    }
+
+#if defined(NRF24_ENABLE_TRACE)
+    for (size_t idx = 0; idx < count; idx++) {
+        NRF24_TRACE_SPI(radio, segments[idx].in, segments[idx].out, segments[idx].xfer_size);
+    }
+#endif
+
+    if (0 != count) {
+        /* The last STATUS received is the most recent one */
+        NRF24_hal_keep_status(radio, segments[count - 1].in, segments[count - 1].out,
+            segments[count - 1].xfer_size);
+    }
+}
+
+uint8_t NRF24_hal_spi_xfer_sg(nrf_radio *radio, const uint8_t cmd,
+	const uint8_t *in, uint8_t *out, size_t xfer_len)
+{
+    uint8_t status = 0;
+
+    NRF24_STATS_ADD(radio, spi_transactions, 1);
+    NRF24_STATS_ADD(radio, spi_bytes, xfer_len + 1);
+
+    radio->spi_xfer_sg_cb(cmd, &status, in, out, xfer_len);
+    NRF24_TRACE_SPI_SG(radio, cmd, status, in, out, xfer_len);
+    NRF24_hal_keep_status(radio, &cmd, &status, 1);
+
+    return status;
 }
 
 void NRF24_hal_set_ce(nrf_radio *radio, nrf_gpio state)
 {
+#if defined(NRF24_ENABLE_STATS)
+    if ((uint8_t) state != radio->stats_ce) {
+        radio->stats_ce = (uint8_t) state;
+        NRF24_STATS_ADD(radio, ce_edges, 1);
+    }
+#endif
+
     radio->write_ce_cb(state);
+    NRF24_TRACE_CE(radio, state);
+    NRF24_power_ce_update(radio, state);
+
+    /* Starts or stops what sets the interrupt flags */
+    NRF24_status_cache_invalidate(radio);
 }
 
 nrf_gpio NRF24_hal_get_irq(nrf_radio *radio)
@@ -17,5 +91,57 @@ nrf_gpio NRF24_hal_get_irq(nrf_radio *radio)
 
 void NRF24_hal_delay(nrf_radio *radio, uint32_t ms)
 {
+	NRF24_TRACE_DELAY_US(radio, ms * 1000U);
 	radio->delay_ms_cb(ms);
 }
+
+void NRF24_hal_delay_us(nrf_radio *radio, uint32_t us)
+{
+    NRF24_TRACE_DELAY_US(radio, us);
+
+    if (NULL != radio->delay_us_cb) {
+        radio->delay_us_cb(us);
+    } else {
+        /* Round up to the next ms */
+        radio->delay_ms_cb((us + 999U) / 1000U);
+    }
+}
+
+uint32_t NRF24_hal_time_us(nrf_radio *radio)
+{
+    NRF24_ASSERT(radio->time_us_cb);
+
+    return radio->time_us_cb();
+}
+
+static void NRF24_hal_keep_status(nrf_radio *radio, const uint8_t *in,
+	const uint8_t *out, size_t xfer_len)
+{
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+    if ((NULL == in) || (NULL == out) || (0 == xfer_len)) {
+        NRF24_status_cache_invalidate(radio);
+        return;
+    }
+
+    const uint8_t cmd = in[0];
+    uint8_t status = out[0];
+
+    /* R_REGISTER and W_REGISTER, R_RX_PL_WID and NOP leave the FIFOs alone */
+    if (((uint8_t) (NRF_CMD_W_REGISTER | NRF_REG_FEATURE) < cmd) &&
+        ((uint8_t) NRF_CMD_R_RX_PL_WID != cmd) && ((uint8_t) NRF_CMD_NOP != cmd)) {
+        NRF24_status_cache_invalidate(radio);
+        return;
+    }
+
+    if (((uint8_t) (NRF_CMD_W_REGISTER | NRF_REG_STATUS) == cmd) && (1 < xfer_len)) {
+        status = (uint8_t) (status & ~(in[1] & NRF_ALL_IRQ_MASK));
+    }
+
+    NRF24_status_cache_update(radio, status);
+#else
+    (void) radio;
+    (void) in;
+    (void) out;
+    (void) xfer_len;
+#endif
+}
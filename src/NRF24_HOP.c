@@ -0,0 +1,124 @@
+/**
+* @file     NRF24_HOP.c
+* @version  0.1
+*
+* @brief    Frequency hopping: a pseudo-random hop sequence shared by both
+* ends of the link and a scheduler changing the channel every dwell time.
+*/
+
+#include <string.h>
+
+#include "NRF24_HOP.h"
+#include "NRF24_HAL.h"
+
+/* Used when the seed is 0, xorshift needs a non zero state */
+#define NRF_HOP_DEFAULT_SEED	0x9E3779B9UL
+
+/**
+ * @brief xorshift32 pseudo-random generator.
+ */
+static uint32_t NRF24_hop_random(uint32_t *state);
+
+void NRF24_hop_sequence(uint8_t *sequence, const uint8_t *channels, const size_t count,
+	const uint32_t seed)
+{
+	NRF24_ASSERT(sequence);
+	NRF24_ASSERT(channels);
+
+	uint32_t state = (0 != seed) ? seed : NRF_HOP_DEFAULT_SEED;
+
+	memcpy(sequence, channels, count);
+
+	/* Fisher-Yates shuffle */
+	for (size_t idx = count; 1 < idx; idx--) {
+		const size_t other = NRF24_hop_random(&state) % idx;
+		const uint8_t tmp = sequence[idx - 1];
+
+		sequence[idx - 1] = sequence[other];
+		sequence[other] = tmp;
+	}
+}
+
+void NRF24_hop_init(nrf_hop *hop, const uint8_t *sequence, const size_t length,
+	const uint32_t dwell_us, const uint32_t sync_timeout_us)
+{
+	NRF24_ASSERT(hop);
+	NRF24_ASSERT(sequence);
+	NRF24_ASSERT(0 != length);
+	NRF24_ASSERT(0 != dwell_us);
+	/* A whole cycle must fit in the timestamp range */
+	NRF24_ASSERT(UINT32_MAX / dwell_us >= length);
+
+	hop->sequence = sequence;
+	hop->length = length;
+	hop->dwell_us = dwell_us;
+	hop->epoch = 0;
+	hop->slot = NRF_HOP_NONE;
+	hop->sync_timeout_us = sync_timeout_us;
+	hop->last_sync = 0;
+	hop->started = 0;
+	hop->searching = 0;
+}
+
+void NRF24_hop_resync(nrf_hop *hop, const size_t slot, const uint32_t timestamp)
+{
+	NRF24_ASSERT(hop);
+
+	hop->epoch = timestamp - (uint32_t) (slot % hop->length) * hop->dwell_us;
+	hop->last_sync = timestamp;
+	hop->started = 1;
+	hop->searching = 0;
+}
+
+int NRF24_hop_service(nrf_radio *radio, nrf_hop *hop)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(hop);
+
+	const uint32_t now = NRF24_hal_time_us(radio);
+
+	if (!hop->started) {
+		NRF24_hop_resync(hop, 0, now);
+	}
+
+	if ((0 != hop->sync_timeout_us) && (now - hop->last_sync > hop->sync_timeout_us)) {
+		hop->searching = 1;
+	}
+
+	/* Wait on the current channel for the other end to come by */
+	if (hop->searching && (NRF_HOP_NONE != hop->slot)) {
+		return 0;
+	}
+
+	const uint32_t cycle = (uint32_t) hop->length * hop->dwell_us;
+	uint32_t elapsed = now - hop->epoch;
+
+	/* Keep the epoch within a cycle, so the timestamp can wrap around */
+	if (cycle <= elapsed) {
+		hop->epoch += (elapsed / cycle) * cycle;
+		elapsed %= cycle;
+	}
+
+	const size_t slot = elapsed / hop->dwell_us;
+
+	if (slot == hop->slot) {
+		return 0;
+	}
+
+	NRF24_change_channel(radio, hop->sequence[slot]);
+	hop->slot = slot;
+
+	return 1;
+}
+
+static uint32_t NRF24_hop_random(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
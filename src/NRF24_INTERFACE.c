@@ -8,6 +8,7 @@
 
 #include "NRF24.h"
 #include "NRF24_INTERFACE.h"
+#include "NRF24_COMMANDS.h"
 
 /* Static functions */
 typedef enum {
@@ -18,6 +19,25 @@ typedef enum {
 static void NRF24_write_bit(nrf_radio *radio, const nrf_register reg,
 	const uint8_t bit_pos, const nrf_bit value);
 
+#if defined(NRF24_ENABLE_REG_CACHE)
+/* Single byte registers that only change when written by us, STATUS,
+ * OBSERVE_TX, RPD and FIFO_STATUS are updated by the radio and the
+ * RX_ADDR_P0, RX_ADDR_P1 and TX_ADDR registers are multi byte. */
+#define NRF_REG_CACHEABLE_MASK	( \
+	(1UL << NRF_REG_CONFIG)		| (1UL << NRF_REG_EN_AA)	| \
+	(1UL << NRF_REG_EN_RXADDR)	| (1UL << NRF_REG_SETUP_AW)	| \
+	(1UL << NRF_REG_SETUP_RETR)	| (1UL << NRF_REG_RF_CH)	| \
+	(1UL << NRF_REG_RF_SETUP)	| (1UL << NRF_REG_RX_ADDR_P2)	| \
+	(1UL << NRF_REG_RX_ADDR_P3)	| (1UL << NRF_REG_RX_ADDR_P4)	| \
+	(1UL << NRF_REG_RX_ADDR_P5)	| (1UL << NRF_REG_RX_PW_P0)	| \
+	(1UL << NRF_REG_RX_PW_P1)	| (1UL << NRF_REG_RX_PW_P2)	| \
+	(1UL << NRF_REG_RX_PW_P3)	| (1UL << NRF_REG_RX_PW_P4)	| \
+	(1UL << NRF_REG_RX_PW_P5)	| (1UL << NRF_REG_DYNPD)	| \
+	(1UL << NRF_REG_FEATURE))
+
+static int NRF24_reg_is_cacheable(const nrf_register reg, const size_t data_size);
+#endif
+
 uint8_t NRF24_read_reg(nrf_radio *radio, const nrf_register reg,
     uint8_t *data, const size_t data_size)
 {
@@ -25,11 +45,19 @@ uint8_t NRF24_read_reg(nrf_radio *radio, const nrf_register reg,
     uint8_t data_in[data_size + 1];
     
     data_in[0] = (uint8_t) (NRF_CMD_R_REGISTER | reg);
+
+    /* Clock out dummy bytes while reading the register */
+    for (size_t idx = 0; idx < data_size; idx++) {
+    	data_in[idx + 1] = NRF_CMD_NOP;
+    }
+
     NRF24_hal_spi_xfer(radio, data_in, data_out, NRF_ARRAY_SIZE(data_in));
 
     for (size_t idx = 0; idx < data_size; idx++) {
     	data[idx] = data_out[idx + 1];
     }
+
+    NRF24_reg_cache_update(radio, reg, data, data_size);
     
     return data_out[0];
 }
@@ -47,16 +75,194 @@ uint8_t NRF24_write_reg(nrf_radio *radio, const nrf_register reg,
     }
 
     NRF24_hal_spi_xfer(radio, data_in, data_out, NRF_ARRAY_SIZE(data_in));
+
+    NRF24_reg_cache_update(radio, reg, data, data_size);
+
+#if defined(NRF24_ENABLE_STATS)
+    if (NRF_REG_STATUS == reg) {
+        /* The flags cleared are the ones set (STATUS clocked out) and written */
+        const uint8_t cleared = data_out[0] & data[0];
+
+        NRF24_STATS_ADD(radio, tx_ds, 0 != (cleared & NRF_STATUS_TX_DS_MASK));
+        NRF24_STATS_ADD(radio, max_rt, 0 != (cleared & NRF_STATUS_MAX_RT_MASK));
+        NRF24_STATS_ADD(radio, rx_dr, 0 != (cleared & NRF_STATUS_RX_DR_MASK));
+    }
+#endif
     
     return data_out[0];
 }
 
+uint8_t NRF24_read_reg_cached(nrf_radio *radio, const nrf_register reg)
+{
+    NRF24_ASSERT(radio);
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+    if (NRF24_reg_is_cacheable(reg, 1) &&
+        (radio->reg_cache_valid & (1UL << reg))) {
+    	return radio->reg_cache[reg];
+    }
+#endif
+
+    uint8_t reg_value = 0;
+    NRF24_read_reg(radio, reg, &reg_value, sizeof reg_value);
+    return reg_value;
+}
+
+void NRF24_reg_cache_invalidate(nrf_radio *radio)
+{
+    NRF24_ASSERT(radio);
+
+    radio->power_config = NRF_POWER_UNKNOWN;
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+    radio->reg_cache_valid = 0;
+#endif
+}
+
+void NRF24_reg_cache_update(nrf_radio *radio, const nrf_register reg,
+    const uint8_t *data, const size_t data_size)
+{
+    if ((NRF_REG_CONFIG == reg) && (1 == data_size)) {
+    	NRF24_power_config_update(radio, data[0]);
+    }
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+    if (NRF24_reg_is_cacheable(reg, data_size)) {
+    	radio->reg_cache[reg] = data[0];
+    	radio->reg_cache_valid |= (1UL << reg);
+    }
+#endif
+}
+
+void NRF24_reg_cache_sync(nrf_radio *radio)
+{
+    NRF24_ASSERT(radio);
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+    uint8_t reg_value;
+
+    for (uint8_t reg = NRF_REG_CONFIG; reg < NRF_REG_CACHE_SIZE; reg++) {
+    	if (NRF24_reg_is_cacheable((nrf_register) reg, 1)) {
+    		/* NRF24_read_reg updates the cache */
+    		NRF24_read_reg(radio, (nrf_register) reg, &reg_value, 1);
+    	}
+    }
+#endif
+}
+
+void NRF24_power_config_update(nrf_radio *radio, const uint8_t config)
+{
+    NRF24_ASSERT(radio);
+
+    const uint8_t bits = (uint8_t) (config & (NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER));
+
+    if (!(bits & NRF_CONFIG_PWR_UP)) {
+    	radio->power_pending &= (uint8_t) ~NRF_POWER_PENDING_UP;
+    } else if ((NRF_POWER_UNKNOWN == radio->power_config) ||
+    	!(radio->power_config & NRF_CONFIG_PWR_UP)) {
+    	/* Not knowing when it was powered up, the whole Tpd2stby is waited */
+    	radio->power_pending |= NRF_POWER_PENDING_UP;
+    	radio->power_up_time = (NULL != radio->time_us_cb) ? NRF24_hal_time_us(radio) : 0;
+    }
+
+    radio->power_config = bits;
+}
+
+void NRF24_power_ce_update(nrf_radio *radio, const nrf_gpio state)
+{
+    NRF24_ASSERT(radio);
+
+    if (GPIO_SET != state) {
+    	radio->power_pending &= (uint8_t) ~NRF_POWER_PENDING_CE;
+    } else if (GPIO_SET != radio->power_ce) {
+    	radio->power_pending |= NRF_POWER_PENDING_CE;
+    	radio->ce_high_time = (NULL != radio->time_us_cb) ? NRF24_hal_time_us(radio) : 0;
+    }
+
+    radio->power_ce = (uint8_t) state;
+}
+
+void NRF24_power_settle(nrf_radio *radio, const uint8_t pending)
+{
+    NRF24_ASSERT(radio);
+
+    if ((pending & radio->power_pending) & NRF_POWER_PENDING_UP) {
+    	NRF24_power_wait(radio, radio->power_up_time, NRF_POWER_UP_DELAY_US);
+    	radio->power_pending &= (uint8_t) ~NRF_POWER_PENDING_UP;
+
+    	/* Tstby2a starts once in standby */
+    	if ((radio->power_pending & NRF_POWER_PENDING_CE) && (NULL != radio->time_us_cb)) {
+    		radio->ce_high_time = NRF24_hal_time_us(radio);
+    	}
+    }
+
+    if ((pending & radio->power_pending) & NRF_POWER_PENDING_CE) {
+    	NRF24_power_wait(radio, radio->ce_high_time, NRF_PLL_SETTLE_DELAY_US);
+    	radio->power_pending &= (uint8_t) ~NRF_POWER_PENDING_CE;
+    }
+}
+
+void NRF24_power_wait(nrf_radio *radio, const uint32_t since, const uint32_t duration_us)
+{
+    NRF24_ASSERT(radio);
+
+    uint32_t remaining = duration_us;
+
+    if (NULL != radio->time_us_cb) {
+    	/* Wraps around like the timestamps */
+    	const uint32_t elapsed = NRF24_hal_time_us(radio) - since;
+
+    	remaining = (elapsed < duration_us) ? (duration_us - elapsed) : 0;
+    }
+
+    if (0 != remaining) {
+    	NRF24_hal_delay_us(radio, remaining);
+    }
+}
+
+uint8_t NRF24_read_status_cached(nrf_radio *radio)
+{
+    NRF24_ASSERT(radio);
+
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+    if (radio->status_valid &&
+        ((uint32_t) (NRF24_hal_time_us(radio) - radio->status_time) < radio->status_max_age_us)) {
+    	return radio->status;
+    }
+#endif
+
+    /* The HAL keeps the STATUS clocked out */
+    return NRF24_cmd_nop(radio);
+}
+
+void NRF24_status_cache_update(nrf_radio *radio, const uint8_t status)
+{
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+    if (0 != radio->status_max_age_us) {
+    	radio->status = status;
+    	radio->status_time = NRF24_hal_time_us(radio);
+    	radio->status_valid = 1;
+    }
+#else
+    (void) radio;
+    (void) status;
+#endif
+}
+
+void NRF24_status_cache_invalidate(nrf_radio *radio)
+{
+    NRF24_ASSERT(radio);
+
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+    radio->status_valid = 0;
+#endif
+}
+
 uint8_t NRF24_read_bit(nrf_radio *radio, const nrf_register reg, const uint8_t bit_pos)
 {
 	NRF24_ASSERT(8 > bit_pos);
 
-    uint8_t reg_val;
-    NRF24_read_reg(radio, reg, &reg_val, 1);
+    uint8_t reg_val = NRF24_read_reg_cached(radio, reg);
     return (reg_val & (1 << bit_pos)) != 0;
 }
 
@@ -81,8 +287,7 @@ void NRF24_write_bits(nrf_radio *radio, const nrf_register reg, uint8_t mask, ui
     NRF24_ASSERT(radio);
 
     /* Get the current register value */
-    uint8_t reg_value = 0;
-    NRF24_read_reg(radio, reg, &reg_value, sizeof reg_value);
+    uint8_t reg_value = NRF24_read_reg_cached(radio, reg);
     
     /* Invert the mask, when we AND it with the register value we set
      * the masked bits to zero. */
@@ -98,9 +303,8 @@ void NRF24_write_bits(nrf_radio *radio, const nrf_register reg, uint8_t mask, ui
 /**
  * Set (1) or clear (0) the specified bit of the specified NRF24 register.
  *
- * First we read the specified register and check the content of the specified
- * bit, exit early if the bit already is the value we wanted, otherwise we set
- * the bit to the specified value.
+ * First we read the specified register (from the register cache if enabled)
+ * and then write it back with the specified bit set to the specified value.
  *
  * @param[in] reg: Register to be written, see @c nrf_register.
  * @param[in] bit_pos: Position of the bit to be written.
@@ -111,8 +315,7 @@ static void NRF24_write_bit(nrf_radio *radio, const nrf_register reg,
 {
 	NRF24_ASSERT(8 > bit_pos);
 
-    uint8_t temp = 0;
-    NRF24_read_reg(radio, reg, &temp, 1);
+    uint8_t temp = NRF24_read_reg_cached(radio, reg);
     
     const uint8_t bit_mask = (uint8_t) (1U << bit_pos);
     
@@ -121,3 +324,12 @@ static void NRF24_write_bit(nrf_radio *radio, const nrf_register reg,
 
     NRF24_write_reg(radio, reg, &temp, 1);
 }
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+static int NRF24_reg_is_cacheable(const nrf_register reg, const size_t data_size)
+{
+    return (1 == data_size) &&
+        (NRF_REG_CACHE_SIZE > reg) &&
+        (NRF_REG_CACHEABLE_MASK & (1UL << reg));
+}
+#endif
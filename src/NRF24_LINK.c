@@ -0,0 +1,165 @@
+/**
+* @file     NRF24_LINK.c
+* @version  0.1
+*
+* @brief    Adaptive tuning of the automatic retransmissions and data rate of
+* a transmitter.
+*/
+
+#include "NRF24_LINK.h"
+
+enum {
+	/* 250us */
+	NRF_LINK_DELAY_STEP	= (1 << NRF_SETUP_RETR_BIT_ARD),
+	NRF_LINK_COUNT_MAX	= NRF_AUTO_RETRANSMIT_CNT_15,
+};
+
+/* Data rates from the slowest to the fastest */
+static const uint8_t NRF24_link_data_rates[] = {
+	NRF_RF_SETUP_RF_DR_250,
+	NRF_RF_SETUP_RF_DR_1000,
+	NRF_RF_SETUP_RF_DR_2000,
+};
+
+/**
+ * @brief Move the data rate one step up (@p faster non zero) or down, if
+ * the adaptation is enabled and it's not the fastest (or slowest) already.
+ */
+static void NRF24_link_step_data_rate(nrf_link_tuner *tuner, const int faster);
+
+/**
+ * @brief Adjust the settings at the end of a window.
+ */
+static void NRF24_link_adjust(nrf_link_tuner *tuner);
+
+void NRF24_link_tuner_init(nrf_link_tuner *tuner, const uint8_t data_rate,
+	const uint8_t ack_payload_size, const uint8_t adapt_data_rate)
+{
+	NRF24_ASSERT(tuner);
+	NRF24_ASSERT(NRF_PAYLOAD_SIZE_MAX >= ack_payload_size);
+
+	tuner->data_rate = data_rate;
+	tuner->ack_payload_size = ack_payload_size;
+	tuner->adapt_data_rate = adapt_data_rate;
+	tuner->delay = NRF24_min_retransmit_delay(data_rate, ack_payload_size);
+	tuner->count = NRF_LINK_MIN_COUNT;
+
+	tuner->packets = 0;
+	tuner->lost = 0;
+	tuner->retransmissions = 0;
+	tuner->clean_windows = 0;
+}
+
+void NRF24_link_tuner_apply(nrf_radio *radio, const nrf_link_tuner *tuner)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(tuner);
+
+	NRF24_set_auto_retransmit(radio, tuner->delay, tuner->count);
+	NRF24_set_data_rate(radio, tuner->data_rate);
+}
+
+int NRF24_link_tuner_update(nrf_radio *radio, nrf_link_tuner *tuner, const nrf_irq result)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(tuner);
+
+	if (NRF_MAX_RT_IRQ == result) {
+		/* Every retransmission was used, no need to read ARC_CNT */
+		tuner->lost++;
+		tuner->retransmissions += tuner->count;
+	} else {
+		tuner->retransmissions += NRF24_get_retransmissions_count(radio);
+	}
+
+	if (NRF_LINK_WINDOW > ++tuner->packets) {
+		return 0;
+	}
+
+	const uint8_t data_rate = tuner->data_rate;
+	const uint8_t delay = tuner->delay;
+	const uint8_t count = tuner->count;
+
+	NRF24_link_adjust(tuner);
+
+	tuner->packets = 0;
+	tuner->lost = 0;
+	tuner->retransmissions = 0;
+
+	if ((delay != tuner->delay) || (count != tuner->count)) {
+		NRF24_set_auto_retransmit(radio, tuner->delay, tuner->count);
+	}
+
+	if (data_rate != tuner->data_rate) {
+		NRF24_set_data_rate(radio, tuner->data_rate);
+	}
+
+	return (delay != tuner->delay) || (count != tuner->count) ||
+		(data_rate != tuner->data_rate);
+}
+
+static void NRF24_link_adjust(nrf_link_tuner *tuner)
+{
+	if (0 != tuner->lost) {
+		tuner->clean_windows = 0;
+
+		if (NRF_LINK_COUNT_MAX != tuner->count) {
+			tuner->count = NRF_LINK_COUNT_MAX;
+		} else {
+			NRF24_link_step_data_rate(tuner, 0);
+		}
+	} else if (tuner->retransmissions > tuner->packets) {
+		tuner->clean_windows = 0;
+
+		if (NRF_LINK_MAX_DELAY > tuner->delay) {
+			tuner->delay = (uint8_t) (tuner->delay + NRF_LINK_DELAY_STEP);
+		} else {
+			NRF24_link_step_data_rate(tuner, 0);
+		}
+	} else if (0 == tuner->retransmissions) {
+		if (NRF_AUTO_RETRANSMIT_DELAY_250_US != tuner->delay) {
+			tuner->delay = (uint8_t) (tuner->delay - NRF_LINK_DELAY_STEP);
+		}
+
+		if (NRF_LINK_MIN_COUNT < tuner->count) {
+			tuner->count--;
+		}
+
+		if (NRF_LINK_CLEAN_WINDOWS <= ++tuner->clean_windows) {
+			tuner->clean_windows = 0;
+			NRF24_link_step_data_rate(tuner, 1);
+		}
+	} else {
+		tuner->clean_windows = 0;
+	}
+
+	/* The ACK must still fit in the delay */
+	const uint8_t min_delay = NRF24_min_retransmit_delay(tuner->data_rate,
+		tuner->ack_payload_size);
+
+	if (min_delay > tuner->delay) {
+		tuner->delay = min_delay;
+	}
+}
+
+static void NRF24_link_step_data_rate(nrf_link_tuner *tuner, const int faster)
+{
+	if (!tuner->adapt_data_rate) {
+		return;
+	}
+
+	const size_t last = NRF_ARRAY_SIZE(NRF24_link_data_rates) - 1;
+
+	for (size_t idx = 0; idx <= last; idx++) {
+		if (NRF24_link_data_rates[idx] != tuner->data_rate) {
+			continue;
+		}
+
+		if ((faster && (last == idx)) || (!faster && (0 == idx))) {
+			return;
+		}
+
+		tuner->data_rate = NRF24_link_data_rates[faster ? idx + 1 : idx - 1];
+		return;
+	}
+}
@@ -0,0 +1,498 @@
+/**
+* @file     NRF24_LINUX.c
+* @version  0.1
+*
+* @brief    Linux userspace backend, spidev and GPIO character device.
+*/
+
+#include "NRF24_LINUX.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+
+enum {
+	NRF_LINUX_BITS_PER_WORD	= 8,
+	/* IRQ edge events read at once */
+	NRF_LINUX_EVENTS	= 8,
+};
+
+/* Callbacks of one slot */
+typedef struct {
+	nrf_spi_xfer		spi_xfer;
+	nrf_spi_xfer_vec	spi_xfer_vec;
+	nrf_spi_xfer_sg		spi_xfer_sg;
+	nrf_write_ce		write_ce;
+	nrf_read_irq		read_irq;
+} nrf_linux_callbacks;
+
+static nrf_linux *nrf_linux_slots[NRF_LINUX_MAX_RADIOS];
+
+/**
+ * @brief ioctl through the stand-in if there's one, the errno of the first
+ * failure is kept.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int NRF24_linux_ioctl(nrf_linux *lx, const int fd, const unsigned long request,
+	void *arg);
+
+/**
+ * @brief Keep errno if it's the first failure.
+ */
+static void NRF24_linux_fail(nrf_linux *lx);
+
+/**
+ * @brief Send @p count transfers as a single SPI message.
+ */
+static void NRF24_linux_spi_message(nrf_linux *lx, struct spi_ioc_transfer *xfers,
+	const size_t count);
+
+static void NRF24_linux_spi_xfer(nrf_linux *lx, const uint8_t *in, uint8_t *out,
+	const size_t xfer_size);
+static void NRF24_linux_spi_xfer_vec(nrf_linux *lx, const nrf_spi_segment *segments,
+	const size_t count);
+static void NRF24_linux_spi_xfer_sg(nrf_linux *lx, const uint8_t cmd, uint8_t *status,
+	const uint8_t *in, uint8_t *out, const size_t xfer_size);
+static void NRF24_linux_write_ce(nrf_linux *lx, const nrf_gpio state);
+static nrf_gpio NRF24_linux_read_irq(nrf_linux *lx);
+
+/**
+ * @brief Request a single GPIO line.
+ *
+ * @return File descriptor of the line request, -1 on error.
+ */
+static int NRF24_linux_request_line(nrf_linux *lx, const int chip_fd, const int line,
+	const uint64_t flags, const char *consumer);
+
+static uint64_t NRF24_linux_now_ns(void);
+static void NRF24_linux_sleep_ns(const uint64_t ns);
+static void NRF24_linux_delay_ms(uint32_t ms);
+static void NRF24_linux_delay_us(uint32_t us);
+static uint32_t NRF24_linux_time_us(void);
+
+/* Callbacks of the radio attached on slot n */
+#define NRF_LINUX_SLOT(n)								\
+static void NRF24_linux_spi_xfer_##n(const uint8_t *in, uint8_t *out,			\
+	const size_t xfer_size)								\
+{											\
+	NRF24_linux_spi_xfer(nrf_linux_slots[n], in, out, xfer_size);			\
+}											\
+											\
+static void NRF24_linux_spi_xfer_vec_##n(const nrf_spi_segment *segments,		\
+	const size_t count)								\
+{											\
+	NRF24_linux_spi_xfer_vec(nrf_linux_slots[n], segments, count);			\
+}											\
+											\
+static void NRF24_linux_spi_xfer_sg_##n(const uint8_t cmd, uint8_t *status,		\
+	const uint8_t *in, uint8_t *out, const size_t xfer_size)			\
+{											\
+	NRF24_linux_spi_xfer_sg(nrf_linux_slots[n], cmd, status, in, out, xfer_size);	\
+}											\
+											\
+static void NRF24_linux_write_ce_##n(nrf_gpio state)					\
+{											\
+	NRF24_linux_write_ce(nrf_linux_slots[n], state);				\
+}											\
+											\
+static nrf_gpio NRF24_linux_read_irq_##n(void)						\
+{											\
+	return NRF24_linux_read_irq(nrf_linux_slots[n]);				\
+}
+
+#define NRF_LINUX_SLOT_CALLBACKS(n)	{						\
+	NRF24_linux_spi_xfer_##n, NRF24_linux_spi_xfer_vec_##n,				\
+	NRF24_linux_spi_xfer_sg_##n, NRF24_linux_write_ce_##n,				\
+	NRF24_linux_read_irq_##n							\
+}
+
+NRF_LINUX_SLOT(0)
+NRF_LINUX_SLOT(1)
+
+static const nrf_linux_callbacks nrf_linux_slot_callbacks[NRF_LINUX_MAX_RADIOS] = {
+	NRF_LINUX_SLOT_CALLBACKS(0),
+	NRF_LINUX_SLOT_CALLBACKS(1),
+};
+
+void NRF24_linux_init(nrf_linux *lx, const int spi_fd, const int ce_fd, const int irq_fd,
+	const uint32_t speed_hz)
+{
+	NRF24_ASSERT(lx);
+
+	lx->spi_fd = spi_fd;
+	lx->ce_fd = ce_fd;
+	lx->irq_fd = irq_fd;
+	lx->speed_hz = speed_hz;
+	lx->ioctl_cb = NULL;
+	/* Output lines are requested low, the IRQ line is idle high */
+	lx->ce_level = GPIO_CLEAR;
+	lx->irq_level = GPIO_SET;
+	lx->slot = -1;
+	lx->error = 0;
+}
+
+int NRF24_linux_open(nrf_linux *lx, const char *spidev, const uint32_t speed_hz,
+	const char *gpiochip, const int ce_line, const int irq_line)
+{
+	NRF24_ASSERT(lx);
+	NRF24_ASSERT(spidev);
+
+	uint8_t mode = SPI_MODE_0;
+	uint8_t bits = NRF_LINUX_BITS_PER_WORD;
+	uint32_t speed = speed_hz;
+
+	NRF24_linux_init(lx, -1, -1, -1, speed_hz);
+
+	lx->spi_fd = open(spidev, O_RDWR | O_CLOEXEC);
+
+	if (0 > lx->spi_fd) {
+		NRF24_linux_fail(lx);
+		return 1;
+	}
+
+	if (NRF24_linux_ioctl(lx, lx->spi_fd, SPI_IOC_WR_MODE, &mode) ||
+		NRF24_linux_ioctl(lx, lx->spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) ||
+		NRF24_linux_ioctl(lx, lx->spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed)) {
+		NRF24_linux_close(lx);
+		return 1;
+	}
+
+	if ((0 > ce_line) && (0 > irq_line)) {
+		return 0;
+	}
+
+	NRF24_ASSERT(gpiochip);
+
+	const int chip_fd = open(gpiochip, O_RDWR | O_CLOEXEC);
+
+	if (0 > chip_fd) {
+		NRF24_linux_fail(lx);
+		NRF24_linux_close(lx);
+		return 1;
+	}
+
+	if (0 <= ce_line) {
+		lx->ce_fd = NRF24_linux_request_line(lx, chip_fd, ce_line,
+			GPIO_V2_LINE_FLAG_OUTPUT, "nrf24-ce");
+	}
+
+	if (0 <= irq_line) {
+		lx->irq_fd = NRF24_linux_request_line(lx, chip_fd, irq_line,
+			GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING |
+			GPIO_V2_LINE_FLAG_EDGE_RISING, "nrf24-irq");
+	}
+
+	close(chip_fd);
+
+	if (((0 <= ce_line) && (0 > lx->ce_fd)) || ((0 <= irq_line) && (0 > lx->irq_fd))) {
+		NRF24_linux_close(lx);
+		return 1;
+	}
+
+	if (0 <= lx->irq_fd) {
+		struct gpio_v2_line_values values = {.bits = 0, .mask = 1};
+
+		/* Level before the first edge event */
+		if (NRF24_linux_ioctl(lx, lx->irq_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) ||
+			(0 > fcntl(lx->irq_fd, F_SETFL, O_NONBLOCK))) {
+			NRF24_linux_fail(lx);
+			NRF24_linux_close(lx);
+			return 1;
+		}
+
+		lx->irq_level = (values.bits & 1U) ? GPIO_SET : GPIO_CLEAR;
+	}
+
+	return 0;
+}
+
+void NRF24_linux_set_ioctl_cb(nrf_linux *lx, nrf_linux_ioctl ioctl_cb)
+{
+	NRF24_ASSERT(lx);
+
+	lx->ioctl_cb = ioctl_cb;
+}
+
+int NRF24_linux_attach(nrf_linux *lx, nrf_radio *radio)
+{
+	NRF24_ASSERT(lx);
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(0 <= lx->spi_fd);
+
+	int slot = 0;
+
+	/* Attaching again reuses the slot */
+	while ((NRF_LINUX_MAX_RADIOS > slot) && (NULL != nrf_linux_slots[slot]) &&
+		(lx != nrf_linux_slots[slot])) {
+		slot++;
+	}
+
+	if (NRF_LINUX_MAX_RADIOS == slot) {
+		return 1;
+	}
+
+	const nrf_linux_callbacks *callbacks = &nrf_linux_slot_callbacks[slot];
+
+	if (NRF24_init(radio, callbacks->spi_xfer, callbacks->write_ce,
+		(0 <= lx->irq_fd) ? callbacks->read_irq : NULL,
+		NRF24_linux_delay_ms, NRF24_linux_delay_us)) {
+		return 1;
+	}
+
+	nrf_linux_slots[slot] = lx;
+	lx->slot = slot;
+
+	NRF24_set_spi_xfer_vec_cb(radio, callbacks->spi_xfer_vec);
+	NRF24_set_spi_xfer_sg_cb(radio, callbacks->spi_xfer_sg);
+	NRF24_set_time_us_cb(radio, NRF24_linux_time_us);
+
+	return 0;
+}
+
+int NRF24_linux_irq_fd(const nrf_linux *lx)
+{
+	NRF24_ASSERT(lx);
+
+	return lx->irq_fd;
+}
+
+int NRF24_linux_handle_irq(nrf_linux *lx)
+{
+	NRF24_ASSERT(lx);
+
+	struct gpio_v2_line_event events[NRF_LINUX_EVENTS];
+	ssize_t got;
+
+	if (0 > lx->irq_fd) {
+		return 0;
+	}
+
+	/* Only the last edge tells the level, a short read means the events
+	 * are drained, no need for another read to get EAGAIN */
+	while (0 < (got = read(lx->irq_fd, events, sizeof events))) {
+		const size_t count = (size_t) got / sizeof events[0];
+
+		if (0 < count) {
+			lx->irq_level = (GPIO_V2_LINE_EVENT_FALLING_EDGE == events[count - 1].id) ?
+				GPIO_CLEAR : GPIO_SET;
+		}
+
+		if (sizeof events > (size_t) got) {
+			break;
+		}
+	}
+
+	if ((0 > got) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)) {
+		NRF24_linux_fail(lx);
+	}
+
+	return GPIO_CLEAR == lx->irq_level;
+}
+
+void NRF24_linux_close(nrf_linux *lx)
+{
+	NRF24_ASSERT(lx);
+
+	if (0 <= lx->slot) {
+		nrf_linux_slots[lx->slot] = NULL;
+		lx->slot = -1;
+	}
+
+	if (0 <= lx->spi_fd) {
+		close(lx->spi_fd);
+		lx->spi_fd = -1;
+	}
+
+	if (0 <= lx->ce_fd) {
+		close(lx->ce_fd);
+		lx->ce_fd = -1;
+	}
+
+	if (0 <= lx->irq_fd) {
+		close(lx->irq_fd);
+		lx->irq_fd = -1;
+	}
+}
+
+static int NRF24_linux_ioctl(nrf_linux *lx, const int fd, const unsigned long request,
+	void *arg)
+{
+	const int result = (NULL != lx->ioctl_cb) ? lx->ioctl_cb(fd, request, arg) :
+		ioctl(fd, request, arg);
+
+	if (0 > result) {
+		NRF24_linux_fail(lx);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void NRF24_linux_fail(nrf_linux *lx)
+{
+	if (0 == lx->error) {
+		lx->error = errno;
+	}
+}
+
+static void NRF24_linux_spi_message(nrf_linux *lx, struct spi_ioc_transfer *xfers,
+	const size_t count)
+{
+	for (size_t idx = 0; idx < count; idx++) {
+		xfers[idx].speed_hz = lx->speed_hz;
+		xfers[idx].bits_per_word = NRF_LINUX_BITS_PER_WORD;
+	}
+
+	(void) NRF24_linux_ioctl(lx, lx->spi_fd, SPI_IOC_MESSAGE(count), xfers);
+}
+
+static void NRF24_linux_spi_xfer(nrf_linux *lx, const uint8_t *in, uint8_t *out,
+	const size_t xfer_size)
+{
+	struct spi_ioc_transfer xfer;
+
+	memset(&xfer, 0, sizeof xfer);
+	xfer.tx_buf = (uintptr_t) in;
+	xfer.rx_buf = (uintptr_t) out;
+	xfer.len = (uint32_t) xfer_size;
+
+	NRF24_linux_spi_message(lx, &xfer, 1);
+}
+
+static void NRF24_linux_spi_xfer_vec(nrf_linux *lx, const nrf_spi_segment *segments,
+	const size_t count)
+{
+	struct spi_ioc_transfer xfers[NRF_LINUX_MAX_XFERS];
+	size_t sent = 0;
+
+	while (sent < count) {
+		const size_t chunk = ((count - sent) < NRF_LINUX_MAX_XFERS) ?
+			(count - sent) : NRF_LINUX_MAX_XFERS;
+
+		memset(xfers, 0, chunk * sizeof xfers[0]);
+
+		for (size_t idx = 0; idx < chunk; idx++) {
+			xfers[idx].tx_buf = (uintptr_t) segments[sent + idx].in;
+			xfers[idx].rx_buf = (uintptr_t) segments[sent + idx].out;
+			xfers[idx].len = (uint32_t) segments[sent + idx].xfer_size;
+			/* Each command is a transaction of its own, release the
+			 * chip select before the next one */
+			xfers[idx].cs_change = (idx + 1) < chunk;
+		}
+
+		NRF24_linux_spi_message(lx, xfers, chunk);
+		sent += chunk;
+	}
+}
+
+static void NRF24_linux_spi_xfer_sg(nrf_linux *lx, const uint8_t cmd, uint8_t *status,
+	const uint8_t *in, uint8_t *out, const size_t xfer_size)
+{
+	struct spi_ioc_transfer xfers[2];
+
+	/* The command and the payload are chained under the same chip select,
+	 * without a NULL tx_buf zeros are clocked out as dummy bytes */
+	memset(xfers, 0, sizeof xfers);
+	xfers[0].tx_buf = (uintptr_t) &cmd;
+	xfers[0].rx_buf = (uintptr_t) status;
+	xfers[0].len = 1;
+	xfers[1].tx_buf = (uintptr_t) in;
+	xfers[1].rx_buf = (uintptr_t) out;
+	xfers[1].len = (uint32_t) xfer_size;
+
+	NRF24_linux_spi_message(lx, xfers, (0 != xfer_size) ? 2 : 1);
+}
+
+static void NRF24_linux_write_ce(nrf_linux *lx, const nrf_gpio state)
+{
+	if ((0 > lx->ce_fd) || (state == lx->ce_level)) {
+		return;
+	}
+
+	struct gpio_v2_line_values values = {
+		.bits = (GPIO_SET == state) ? 1U : 0U,
+		.mask = 1U,
+	};
+
+	if (!NRF24_linux_ioctl(lx, lx->ce_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values)) {
+		lx->ce_level = state;
+	}
+}
+
+static nrf_gpio NRF24_linux_read_irq(nrf_linux *lx)
+{
+	return lx->irq_level;
+}
+
+static int NRF24_linux_request_line(nrf_linux *lx, const int chip_fd, const int line,
+	const uint64_t flags, const char *consumer)
+{
+	struct gpio_v2_line_request request;
+
+	memset(&request, 0, sizeof request);
+	request.offsets[0] = (uint32_t) line;
+	request.num_lines = 1;
+	request.config.flags = flags;
+	strncpy(request.consumer, consumer, sizeof request.consumer - 1);
+
+	if (NRF24_linux_ioctl(lx, chip_fd, GPIO_V2_GET_LINE_IOCTL, &request)) {
+		return -1;
+	}
+
+	return request.fd;
+}
+
+static uint64_t NRF24_linux_now_ns(void)
+{
+	struct timespec now;
+
+	/* Served by the vDSO, no syscall */
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+static void NRF24_linux_sleep_ns(const uint64_t ns)
+{
+	struct timespec left = {
+		.tv_sec = (time_t) (ns / 1000000000U),
+		.tv_nsec = (long) (ns % 1000000000U),
+	};
+
+	while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, 0, &left, &left)) {
+	}
+}
+
+static void NRF24_linux_delay_ms(uint32_t ms)
+{
+	NRF24_linux_sleep_ns((uint64_t) ms * 1000000U);
+}
+
+static void NRF24_linux_delay_us(uint32_t us)
+{
+	if (NRF_LINUX_SPIN_US <= us) {
+		NRF24_linux_sleep_ns((uint64_t) us * 1000U);
+		return;
+	}
+
+	/* CE pulse and settling times, waking up from a sleep takes longer */
+	const uint64_t end = NRF24_linux_now_ns() + ((uint64_t) us * 1000U);
+
+	while (NRF24_linux_now_ns() < end) {
+	}
+}
+
+static uint32_t NRF24_linux_time_us(void)
+{
+	return (uint32_t) (NRF24_linux_now_ns() / 1000U);
+}
+
+#endif /* __linux__ */
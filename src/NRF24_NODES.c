@@ -0,0 +1,111 @@
+/**
+* @file     NRF24_NODES.c
+* @version  0.1
+*
+* @brief    Table of node addresses for a transmitter talking to several
+* receivers.
+*/
+
+#include <string.h>
+
+#include "NRF24_NODES.h"
+#include "NRF24_BATCH.h"
+
+enum {
+	/* TX_ADDR and RX_ADDR_P0 writes */
+	NRF_NODE_SELECT_SEGMENTS	= 2,
+	NRF_NODE_SELECT_BUFFER_SIZE	= NRF_NODE_SELECT_SEGMENTS * (NRF_PIPE_ADDR_WIDTH_5BYTES + 1),
+};
+
+/**
+ * @brief Number of address bytes to be written to go from the address of
+ * the selected node to @p addr.
+ */
+static size_t NRF24_node_bytes_to_write(const nrf_node_table *table, const uint8_t *addr);
+
+void NRF24_node_table_init(nrf_node_table *table, nrf_node *nodes, const size_t max_nodes,
+	const nrf_pipe_addr_width addr_width, const uint8_t auto_ack)
+{
+	NRF24_ASSERT(table);
+	NRF24_ASSERT(nodes);
+	NRF24_ASSERT((NRF_PIPE_ADDR_WIDTH_3BYTES <= addr_width) &&
+		(NRF_PIPE_ADDR_WIDTH_5BYTES >= addr_width));
+
+	table->nodes = nodes;
+	table->max_nodes = max_nodes;
+	table->count = 0;
+	table->addr_width = (uint8_t) addr_width;
+	table->auto_ack = auto_ack;
+	table->selected = NRF_NODE_NONE;
+}
+
+int NRF24_node_add(nrf_node_table *table, const uint8_t *addr, size_t *node)
+{
+	NRF24_ASSERT(table);
+	NRF24_ASSERT(addr);
+	NRF24_ASSERT(node);
+
+	if (table->max_nodes <= table->count) {
+		return 1;
+	}
+
+	memset(table->nodes[table->count].addr, 0, sizeof table->nodes[table->count].addr);
+	memcpy(table->nodes[table->count].addr, addr, table->addr_width);
+	*node = table->count++;
+
+	return 0;
+}
+
+void NRF24_node_select(nrf_radio *radio, nrf_node_table *table, const size_t node)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(table);
+	NRF24_ASSERT(table->count > node);
+
+	if (table->selected == node) {
+		return;
+	}
+
+	const uint8_t *addr = table->nodes[node].addr;
+	const size_t size = NRF24_node_bytes_to_write(table, addr);
+
+	if (0 != size) {
+		uint8_t in[NRF_NODE_SELECT_BUFFER_SIZE];
+		uint8_t out[NRF_NODE_SELECT_BUFFER_SIZE];
+		nrf_spi_segment segments[NRF_NODE_SELECT_SEGMENTS];
+		nrf_batch batch;
+
+		NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+		NRF24_batch_write_reg(&batch, NRF_REG_TX_ADDR, addr, size);
+		if (table->auto_ack) {
+			NRF24_batch_write_reg(&batch, NRF_REG_RX_ADDR_P0, addr, size);
+		}
+		NRF24_batch_submit(radio, &batch);
+	}
+
+	table->selected = node;
+}
+
+void NRF24_node_table_invalidate(nrf_node_table *table)
+{
+	NRF24_ASSERT(table);
+
+	table->selected = NRF_NODE_NONE;
+}
+
+static size_t NRF24_node_bytes_to_write(const nrf_node_table *table, const uint8_t *addr)
+{
+	if (NRF_NODE_NONE == table->selected) {
+		return table->addr_width;
+	}
+
+	const uint8_t *current = table->nodes[table->selected].addr;
+	size_t size = table->addr_width;
+
+	/* Up to the most significant byte that changes */
+	while ((0 < size) && (current[size - 1] == addr[size - 1])) {
+		size--;
+	}
+
+	return size;
+}
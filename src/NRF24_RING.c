@@ -0,0 +1,109 @@
+/**
+* @file     NRF24_RING.c
+* @version  0.1
+*
+* @brief    Lock-free single producer single consumer packet queues.
+*/
+
+#include "NRF24_RING.h"
+
+void NRF24_ring_init(nrf_ring *ring, nrf_packet *slots, const size_t capacity)
+{
+	NRF24_ASSERT(ring);
+	NRF24_ASSERT(slots);
+	/* Power of two, so the index wrap around doesn't break the modulo */
+	NRF24_ASSERT((0 != capacity) && (0 == (capacity & (capacity - 1))));
+
+	ring->slots = slots;
+	ring->capacity = capacity;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+size_t NRF24_ring_count(const nrf_ring *ring)
+{
+	NRF24_ASSERT(ring);
+
+	const size_t tail = NRF_RING_LOAD_ACQUIRE(&ring->tail);
+	const size_t head = NRF_RING_LOAD_ACQUIRE(&ring->head);
+
+	return head - tail;
+}
+
+nrf_packet *NRF24_ring_reserve(nrf_ring *ring)
+{
+	NRF24_ASSERT(ring);
+
+	/* Only the producer writes head */
+	const size_t head = ring->head;
+	const size_t tail = NRF_RING_LOAD_ACQUIRE(&ring->tail);
+
+	if (ring->capacity == head - tail) {
+		return NULL;
+	}
+
+	return &ring->slots[head & (ring->capacity - 1)];
+}
+
+void NRF24_ring_commit(nrf_ring *ring)
+{
+	NRF24_ASSERT(ring);
+
+	/* The slot content is visible before the new head */
+	NRF_RING_STORE_RELEASE(&ring->head, ring->head + 1);
+}
+
+nrf_packet *NRF24_ring_peek(nrf_ring *ring)
+{
+	NRF24_ASSERT(ring);
+
+	/* Only the consumer writes tail */
+	const size_t tail = ring->tail;
+	const size_t head = NRF_RING_LOAD_ACQUIRE(&ring->head);
+
+	if (head == tail) {
+		return NULL;
+	}
+
+	return &ring->slots[tail & (ring->capacity - 1)];
+}
+
+void NRF24_ring_release(nrf_ring *ring)
+{
+	NRF24_ASSERT(ring);
+
+	/* The slot is read before the producer can reuse it */
+	NRF_RING_STORE_RELEASE(&ring->tail, ring->tail + 1);
+}
+
+int NRF24_ring_push(nrf_ring *ring, const nrf_packet *packet)
+{
+	NRF24_ASSERT(packet);
+
+	nrf_packet *slot = NRF24_ring_reserve(ring);
+
+	if (NULL == slot) {
+		return 1;
+	}
+
+	*slot = *packet;
+	NRF24_ring_commit(ring);
+
+	return 0;
+}
+
+int NRF24_ring_pop(nrf_ring *ring, nrf_packet *packet)
+{
+	NRF24_ASSERT(packet);
+
+	nrf_packet *slot = NRF24_ring_peek(ring);
+
+	if (NULL == slot) {
+		return 1;
+	}
+
+	*packet = *slot;
+	NRF24_ring_release(ring);
+
+	return 0;
+}
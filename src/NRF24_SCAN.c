@@ -0,0 +1,115 @@
+/**
+* @file     NRF24_SCAN.c
+* @version  0.1
+*
+* @brief    Channel occupancy scanner based on the Received Power Detector.
+*/
+
+#include <string.h>
+
+#include "NRF24_SCAN.h"
+#include "NRF24_BATCH.h"
+#include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+
+enum {
+	/* R_REGISTER RPD and W_REGISTER RF_CH */
+	NRF_SCAN_SEGMENTS	= 2,
+	NRF_SCAN_BUFFER_SIZE	= NRF_SCAN_SEGMENTS * 2,
+	NRF_SCAN_MAX_COUNT	= 0xFF,
+};
+
+/**
+ * @brief Halve the counts, done before they can overflow.
+ */
+static void NRF24_scan_age(nrf_scan *scan);
+
+void NRF24_scan_init(nrf_scan *scan)
+{
+	NRF24_ASSERT(scan);
+
+	memset(scan->hits, 0, sizeof scan->hits);
+	scan->sweeps = 0;
+}
+
+void NRF24_scan_sweep(nrf_radio *radio, nrf_scan *scan)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(scan);
+
+	const uint8_t channel = NRF24_read_reg_cached(radio, NRF_REG_RF_CH);
+	uint8_t in[NRF_SCAN_BUFFER_SIZE];
+	uint8_t out[NRF_SCAN_BUFFER_SIZE];
+	nrf_spi_segment segments[NRF_SCAN_SEGMENTS];
+	nrf_batch batch;
+	uint8_t next = 0;
+
+	if (NRF_SCAN_MAX_COUNT == scan->sweeps) {
+		NRF24_scan_age(scan);
+	}
+
+	NRF24_hal_set_ce(radio, GPIO_CLEAR);
+	NRF24_write_reg(radio, NRF_REG_RF_CH, &next, 1);
+
+	NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+
+	for (uint8_t ch = 0; ch < NRF_SCAN_CHANNELS; ch++) {
+		next = (NRF_MAX_RF_CHANNEL == ch) ? channel : (uint8_t) (ch + 1);
+
+		NRF24_hal_set_ce(radio, GPIO_SET);
+		NRF24_hal_delay_us(radio, NRF_SCAN_DWELL_US);
+
+		/* Still tuned to ch until the next CE rising edge */
+		NRF24_batch_reset(&batch);
+		NRF24_batch_read_reg(&batch, NRF_REG_RPD, 1);
+		NRF24_batch_write_reg(&batch, NRF_REG_RF_CH, &next, 1);
+		NRF24_batch_submit(radio, &batch);
+
+		NRF24_hal_set_ce(radio, GPIO_CLEAR);
+
+		if (NRF24_batch_data(&batch, 0)[0] & (1U << NRF_RPD_BIT_RPD)) {
+			scan->hits[ch]++;
+		}
+	}
+
+	scan->sweeps++;
+}
+
+size_t NRF24_scan_quietest(const nrf_scan *scan, uint8_t *channels, const size_t max_channels)
+{
+	NRF24_ASSERT(scan);
+	NRF24_ASSERT(channels);
+
+	size_t count = 0;
+
+	/* Insertion into the sorted list of the quietest channels found so far */
+	for (uint8_t ch = 0; ch < NRF_SCAN_CHANNELS; ch++) {
+		size_t pos = count;
+
+		while ((0 < pos) && (scan->hits[channels[pos - 1]] > scan->hits[ch])) {
+			pos--;
+		}
+
+		if (max_channels <= pos) {
+			continue;
+		}
+
+		if (max_channels > count) {
+			count++;
+		}
+
+		memmove(&channels[pos + 1], &channels[pos], count - pos - 1);
+		channels[pos] = ch;
+	}
+
+	return count;
+}
+
+static void NRF24_scan_age(nrf_scan *scan)
+{
+	for (size_t ch = 0; ch < NRF_SCAN_CHANNELS; ch++) {
+		scan->hits[ch] >>= 1;
+	}
+
+	scan->sweeps >>= 1;
+}
@@ -0,0 +1,33 @@
+/**
+* @file     NRF24_STATS.c
+* @version  0.1
+*
+* @brief    Runtime counters, define NRF24_ENABLE_STATS to use them.
+*/
+
+#include "NRF24_STATS.h"
+
+#if defined(NRF24_ENABLE_STATS)
+
+#include <string.h>
+
+void NRF24_stats_snapshot(nrf_radio *radio, nrf_stats *snapshot, const uint8_t reset)
+{
+	NRF24_ASSERT(radio);
+	NRF24_ASSERT(snapshot);
+
+	*snapshot = radio->stats;
+
+	if (reset) {
+		NRF24_stats_reset(radio);
+	}
+}
+
+void NRF24_stats_reset(nrf_radio *radio)
+{
+	NRF24_ASSERT(radio);
+
+	memset(&radio->stats, 0, sizeof radio->stats);
+}
+
+#endif /* NRF24_ENABLE_STATS */
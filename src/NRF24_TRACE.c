@@ -0,0 +1,290 @@
+/**
+* @file     NRF24_TRACE.c
+* @version  0.1
+*
+* @brief    Bus trace recorded in a lock-free ring, define NRF24_ENABLE_TRACE
+* to use it (the decoder is always available).
+*/
+
+#include "NRF24_TRACE.h"
+#include "NRF24_HAL.h"
+#include "NRF24_RING.h"
+
+enum {
+	NRF_TRACE_U32_SIZE	= 4,
+	/* Sent in place of the bytes the library didn't provide */
+	NRF_TRACE_DUMMY_MOSI	= NRF_CMD_NOP,
+	NRF_TRACE_DUMMY_MISO	= 0x00,
+};
+
+static uint32_t NRF24_trace_get_u32(const uint8_t *src);
+
+#if defined(NRF24_ENABLE_TRACE)
+
+static void NRF24_trace_put_u32(uint8_t *dst, const uint32_t value);
+
+/**
+ * @brief Fill the type and data size of the record header.
+ *
+ * @return Pointer to the record data.
+ */
+static uint8_t *NRF24_trace_header(uint8_t *record, const nrf_trace_type type,
+	const size_t data_size);
+
+/**
+ * @brief Timestamp the record and append it, preceded by a NRF_TRACE_LOST
+ * record when records were dropped.
+ */
+static void NRF24_trace_commit(nrf_radio *radio, uint8_t *record);
+
+/**
+ * @brief Copy @p size bytes into the ring.
+ *
+ * @return 0 on success, 1 if there's no room.
+ */
+static int NRF24_trace_write(nrf_trace *trace, const uint8_t *record, const size_t size);
+
+void NRF24_trace_init(nrf_trace *trace, uint8_t *buffer, const size_t capacity)
+{
+	NRF24_ASSERT(trace);
+	NRF24_ASSERT(buffer);
+	/* Power of two, so the index wrap around doesn't break the modulo */
+	NRF24_ASSERT((0 != capacity) && (0 == (capacity & (capacity - 1))));
+	NRF24_ASSERT(NRF_TRACE_RECORD_MAX_SIZE <= capacity);
+
+	trace->buffer = buffer;
+	trace->capacity = capacity;
+	trace->head = 0;
+	trace->tail = 0;
+	trace->lost = 0;
+}
+
+void NRF24_trace_attach(nrf_radio *radio, nrf_trace *trace)
+{
+	NRF24_ASSERT(radio);
+
+	radio->trace = trace;
+}
+
+size_t NRF24_trace_read(nrf_trace *trace, uint8_t *data, const size_t max_size)
+{
+	NRF24_ASSERT(trace);
+	NRF24_ASSERT(data);
+
+	const size_t mask = trace->capacity - 1;
+	const size_t head = NRF_RING_LOAD_ACQUIRE(&trace->head);
+	/* Only the consumer writes tail */
+	size_t tail = trace->tail;
+	size_t copied = 0;
+
+	while (head != tail) {
+		const size_t size = NRF_TRACE_HEADER_SIZE + trace->buffer[(tail + 1) & mask];
+
+		if (max_size < (copied + size)) {
+			break;
+		}
+
+		for (size_t idx = 0; idx < size; idx++) {
+			data[copied + idx] = trace->buffer[(tail + idx) & mask];
+		}
+
+		copied += size;
+		tail += size;
+	}
+
+	/* The records are copied before the producer can reuse the room */
+	NRF_RING_STORE_RELEASE(&trace->tail, tail);
+
+	return copied;
+}
+
+void NRF24_trace_spi(nrf_radio *radio, const void *in, const void *out, const size_t size)
+{
+	const uint8_t *mosi = (const uint8_t *) in;
+	const uint8_t *miso = (const uint8_t *) out;
+	uint8_t record[NRF_TRACE_RECORD_MAX_SIZE];
+
+	if ((NRF_PAYLOAD_SIZE_MAX + 1) < size) {
+		radio->trace->lost++;
+		return;
+	}
+
+	uint8_t *data = NRF24_trace_header(record, NRF_TRACE_SPI, 2 * size);
+
+	for (size_t idx = 0; idx < size; idx++) {
+		data[idx] = (NULL != mosi) ? mosi[idx] : (uint8_t) NRF_TRACE_DUMMY_MOSI;
+		data[size + idx] = (NULL != miso) ? miso[idx] : (uint8_t) NRF_TRACE_DUMMY_MISO;
+	}
+
+	NRF24_trace_commit(radio, record);
+}
+
+void NRF24_trace_spi_sg(nrf_radio *radio, const uint8_t cmd, const uint8_t status,
+	const uint8_t *in, const uint8_t *out, const size_t size)
+{
+	uint8_t record[NRF_TRACE_RECORD_MAX_SIZE];
+
+	if (NRF_PAYLOAD_SIZE_MAX < size) {
+		radio->trace->lost++;
+		return;
+	}
+
+	/* Same record as a single buffer transaction */
+	uint8_t *data = NRF24_trace_header(record, NRF_TRACE_SPI, 2 * (size + 1));
+
+	data[0] = cmd;
+	data[size + 1] = status;
+
+	for (size_t idx = 0; idx < size; idx++) {
+		data[idx + 1] = (NULL != in) ? in[idx] : (uint8_t) NRF_TRACE_DUMMY_MOSI;
+		data[size + 2 + idx] = (NULL != out) ? out[idx] : (uint8_t) NRF_TRACE_DUMMY_MISO;
+	}
+
+	NRF24_trace_commit(radio, record);
+}
+
+void NRF24_trace_ce(nrf_radio *radio, const nrf_gpio state)
+{
+	uint8_t record[NRF_TRACE_HEADER_SIZE + 1];
+
+	NRF24_trace_header(record, NRF_TRACE_CE, 1)[0] = (uint8_t) state;
+	NRF24_trace_commit(radio, record);
+}
+
+void NRF24_trace_delay_us(nrf_radio *radio, const uint32_t us)
+{
+	uint8_t record[NRF_TRACE_HEADER_SIZE + NRF_TRACE_U32_SIZE];
+
+	NRF24_trace_put_u32(NRF24_trace_header(record, NRF_TRACE_DELAY_US, NRF_TRACE_U32_SIZE), us);
+	NRF24_trace_commit(radio, record);
+}
+
+#endif /* NRF24_ENABLE_TRACE */
+
+size_t NRF24_trace_decode(const uint8_t *data, const size_t size, nrf_trace_record *record)
+{
+	NRF24_ASSERT(data);
+	NRF24_ASSERT(record);
+
+	if (NRF_TRACE_HEADER_SIZE > size) {
+		return 0;
+	}
+
+	const size_t data_size = data[1];
+	const uint8_t *payload = &data[NRF_TRACE_HEADER_SIZE];
+
+	if ((NRF_TRACE_HEADER_SIZE + data_size) > size) {
+		return 0;
+	}
+
+	record->type = (nrf_trace_type) data[0];
+	record->timestamp = NRF24_trace_get_u32(&data[2]);
+	record->mosi = NULL;
+	record->miso = NULL;
+
+	switch (record->type) {
+	case NRF_TRACE_SPI:
+		if ((0 == data_size) || (data_size & 1U)) {
+			return 0;
+		}
+
+		record->value = (uint32_t) (data_size / 2);
+		record->mosi = payload;
+		record->miso = &payload[data_size / 2];
+		break;
+	case NRF_TRACE_CE:
+		if (1 != data_size) {
+			return 0;
+		}
+
+		record->value = payload[0];
+		break;
+	case NRF_TRACE_DELAY_US:
+	case NRF_TRACE_LOST:
+		if (NRF_TRACE_U32_SIZE != data_size) {
+			return 0;
+		}
+
+		record->value = NRF24_trace_get_u32(payload);
+		break;
+	default:
+		return 0;
+	}
+
+	return NRF_TRACE_HEADER_SIZE + data_size;
+}
+
+#if defined(NRF24_ENABLE_TRACE)
+
+static uint8_t *NRF24_trace_header(uint8_t *record, const nrf_trace_type type,
+	const size_t data_size)
+{
+	record[0] = (uint8_t) type;
+	record[1] = (uint8_t) data_size;
+
+	return &record[NRF_TRACE_HEADER_SIZE];
+}
+
+static void NRF24_trace_commit(nrf_radio *radio, uint8_t *record)
+{
+	nrf_trace *trace = radio->trace;
+	const uint32_t timestamp = (NULL != radio->time_us_cb) ? NRF24_hal_time_us(radio) : 0;
+
+	NRF24_trace_put_u32(&record[2], timestamp);
+
+	if (0 != trace->lost) {
+		uint8_t lost[NRF_TRACE_HEADER_SIZE + NRF_TRACE_U32_SIZE];
+
+		NRF24_trace_put_u32(NRF24_trace_header(lost, NRF_TRACE_LOST, NRF_TRACE_U32_SIZE),
+			trace->lost);
+		NRF24_trace_put_u32(&lost[2], timestamp);
+
+		if (NRF24_trace_write(trace, lost, sizeof lost)) {
+			trace->lost++;
+			return;
+		}
+
+		trace->lost = 0;
+	}
+
+	if (NRF24_trace_write(trace, record, NRF_TRACE_HEADER_SIZE + record[1])) {
+		trace->lost++;
+	}
+}
+
+static int NRF24_trace_write(nrf_trace *trace, const uint8_t *record, const size_t size)
+{
+	const size_t mask = trace->capacity - 1;
+	/* Only the producer writes head */
+	const size_t head = trace->head;
+	const size_t tail = NRF_RING_LOAD_ACQUIRE(&trace->tail);
+
+	if ((trace->capacity - (head - tail)) < size) {
+		return 1;
+	}
+
+	for (size_t idx = 0; idx < size; idx++) {
+		trace->buffer[(head + idx) & mask] = record[idx];
+	}
+
+	/* The record is visible before the new head */
+	NRF_RING_STORE_RELEASE(&trace->head, head + size);
+
+	return 0;
+}
+
+static void NRF24_trace_put_u32(uint8_t *dst, const uint32_t value)
+{
+	dst[0] = (uint8_t) value;
+	dst[1] = (uint8_t) (value >> 8);
+	dst[2] = (uint8_t) (value >> 16);
+	dst[3] = (uint8_t) (value >> 24);
+}
+
+#endif /* NRF24_ENABLE_TRACE */
+
+static uint32_t NRF24_trace_get_u32(const uint8_t *src)
+{
+	return (uint32_t) src[0] | ((uint32_t) src[1] << 8) |
+		((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+}
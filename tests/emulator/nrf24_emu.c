@@ -0,0 +1,648 @@
+/**
+* @file     nrf24_emu.c
+* @version  0.1
+*
+* @brief    Register level nRF24L01+ emulator.
+*/
+
+#include <string.h>
+
+#include "nrf24_emu.h"
+
+enum {
+	NRF_EMU_CMD_REG_MASK	= 0xE0,
+	NRF_EMU_REG_ADDR_MASK	= 0x1F,
+	NRF_EMU_ACK_PIPE_MASK	= 0x07,
+	NRF_EMU_FLAGS_MASK	= 0x70,
+	NRF_EMU_PIPE_EMPTY	= 0x07,
+	/* Preamble and packet control field (in bits) */
+	NRF_EMU_PCF_BITS	= 9,
+};
+
+/* Delivery results */
+enum {
+	NRF_EMU_NOT_RECEIVED	= -1,
+	NRF_EMU_ACKED		= 0,
+	NRF_EMU_NOT_ACKED	= 1,
+};
+
+static nrf_emu *nrf_emu_current;
+
+static uint8_t nrf_emu_addr_width(const nrf_emu *emu);
+static uint8_t nrf_emu_fifo_status(const nrf_emu *emu);
+static uint8_t nrf_emu_read_reg_byte(const nrf_emu *emu, uint8_t reg, size_t idx);
+static void nrf_emu_write_reg(nrf_emu *emu, uint8_t reg, const uint8_t *data, size_t size);
+static int nrf_emu_fifo_push(nrf_emu_fifo *fifo, uint8_t pipe, uint8_t no_ack,
+	const uint8_t *data, size_t len);
+static void nrf_emu_fifo_pop(nrf_emu_fifo *fifo);
+static void nrf_emu_step(nrf_emu *emu);
+static int nrf_emu_can_transmit(const nrf_emu *emu);
+static void nrf_emu_transmit(nrf_emu *emu);
+/* @return One of the delivery results */
+static int nrf_emu_deliver(nrf_emu *emu, const nrf_emu_packet *packet);
+static int nrf_emu_match_pipe(const nrf_emu *emu, const uint8_t *addr, uint8_t width);
+static uint32_t nrf_emu_air_time_us(const nrf_emu *emu, uint8_t payload_len);
+
+void nrf_emu_init(nrf_emu *emu)
+{
+	static const uint8_t reset_regs[NRF_EMU_REG_COUNT] = {
+		[NRF_REG_CONFIG]	= 0x08,
+		[NRF_REG_EN_AA]		= 0x3F,
+		[NRF_REG_EN_RXADDR]	= 0x03,
+		[NRF_REG_SETUP_AW]	= 0x03,
+		[NRF_REG_SETUP_RETR]	= 0x03,
+		[NRF_REG_RF_CH]		= 0x02,
+		[NRF_REG_RF_SETUP]	= 0x0E,
+		[NRF_REG_RX_ADDR_P2]	= 0xC3,
+		[NRF_REG_RX_ADDR_P3]	= 0xC4,
+		[NRF_REG_RX_ADDR_P4]	= 0xC5,
+		[NRF_REG_RX_ADDR_P5]	= 0xC6,
+	};
+
+	memset(emu, 0, sizeof *emu);
+	memcpy(emu->regs, reset_regs, sizeof emu->regs);
+	memset(emu->rx_addr_p0, 0xE7, sizeof emu->rx_addr_p0);
+	memset(emu->rx_addr_p1, 0xC2, sizeof emu->rx_addr_p1);
+	memset(emu->tx_addr, 0xE7, sizeof emu->tx_addr);
+}
+
+void nrf_emu_link(nrf_emu *a, nrf_emu *b)
+{
+	a->peer = b;
+	b->peer = a;
+}
+
+void nrf_emu_select(nrf_emu *emu)
+{
+	nrf_emu_current = emu;
+}
+
+void nrf_emu_reset_counters(nrf_emu *emu)
+{
+	memset(&emu->counters, 0, sizeof emu->counters);
+}
+
+void nrf_emu_drop_next(nrf_emu *emu, unsigned long attempts)
+{
+	emu->drop_next = attempts;
+}
+
+void nrf_emu_set_carrier(nrf_emu *emu, uint8_t channel, uint8_t present)
+{
+	if (NRF_MAX_RF_CHANNEL < channel) {
+		return;
+	}
+
+	if (present) {
+		emu->carrier[channel / 8] |= (uint8_t) (1U << (channel % 8));
+	} else {
+		emu->carrier[channel / 8] &= (uint8_t) ~(1U << (channel % 8));
+	}
+}
+
+int nrf_emu_inject_rx(nrf_emu *emu, uint8_t pipe, const uint8_t *data, uint8_t len)
+{
+	if (nrf_emu_fifo_push(&emu->rx, pipe, 0, data, len)) {
+		return 1;
+	}
+
+	emu->regs[NRF_REG_STATUS] |= NRF_STATUS_RX_DR_MASK;
+	emu->counters.packets_received++;
+
+	return 0;
+}
+
+int nrf_emu_pop_tx(nrf_emu *emu, nrf_emu_packet *packet)
+{
+	if (0 == emu->tx.count) {
+		return 1;
+	}
+
+	*packet = emu->tx.slots[0];
+	nrf_emu_fifo_pop(&emu->tx);
+
+	return 0;
+}
+
+void nrf_emu_advance(nrf_emu *emu, uint32_t us)
+{
+	emu->now_ns += (uint64_t) us * 1000U;
+
+	/* With CE high the radio keeps sending while there are payloads */
+	while (nrf_emu_can_transmit(emu)) {
+		nrf_emu_step(emu);
+	}
+}
+
+uint8_t nrf_emu_status(const nrf_emu *emu)
+{
+	uint8_t status = emu->regs[NRF_REG_STATUS] & NRF_EMU_FLAGS_MASK;
+	uint8_t pipe = emu->rx.count ? emu->rx.slots[0].pipe : NRF_EMU_PIPE_EMPTY;
+
+	status |= (uint8_t) (pipe << NRF_STATUS_PIPES_SHIFT);
+
+	if (NRF_EMU_FIFO_DEPTH == emu->tx.count) {
+		status |= NRF_STATUS_TX_FULL_MASK;
+	}
+
+	return status;
+}
+
+void nrf_emu_xfer(nrf_emu *emu, const uint8_t *in, uint8_t *out, size_t xfer_size)
+{
+	uint8_t scratch[1 + NRF_PAYLOAD_SIZE_MAX];
+
+	if (0 == xfer_size) {
+		return;
+	}
+
+	emu->counters.spi_transactions++;
+	emu->counters.spi_bytes += xfer_size;
+	emu->now_ns += (uint64_t) xfer_size * NRF_EMU_SPI_BYTE_NS;
+
+	if (NULL == out) {
+		out = scratch;
+		if (sizeof scratch < xfer_size) {
+			xfer_size = sizeof scratch;
+		}
+	}
+
+	const uint8_t cmd = in[0];
+	const uint8_t *data = &in[1];
+	const size_t data_size = xfer_size - 1;
+
+	out[0] = nrf_emu_status(emu);
+	memset(&out[1], 0, data_size);
+
+	if (NRF_CMD_R_REGISTER == (cmd & NRF_EMU_CMD_REG_MASK)) {
+		for (size_t idx = 0; idx < data_size; idx++) {
+			out[idx + 1] = nrf_emu_read_reg_byte(emu, cmd & NRF_EMU_REG_ADDR_MASK, idx);
+		}
+	} else if (NRF_CMD_W_REGISTER == (cmd & NRF_EMU_CMD_REG_MASK)) {
+		nrf_emu_write_reg(emu, cmd & NRF_EMU_REG_ADDR_MASK, data, data_size);
+	} else if (NRF_CMD_W_ACK_PAYLOAD == (cmd & ~NRF_EMU_ACK_PIPE_MASK)) {
+		if (emu->regs[NRF_REG_FEATURE] & NRF_ENABLE_PAYLOAD_WITH_ACK) {
+			nrf_emu_fifo_push(&emu->ack, cmd & NRF_EMU_ACK_PIPE_MASK, 0, data, data_size);
+		}
+	} else {
+		switch (cmd) {
+		case NRF_CMD_R_RX_PAYLOAD:
+			if (emu->rx.count) {
+				const nrf_emu_packet *packet = &emu->rx.slots[0];
+				for (size_t idx = 0; (idx < data_size) && (idx < packet->len); idx++) {
+					out[idx + 1] = packet->data[idx];
+				}
+				nrf_emu_fifo_pop(&emu->rx);
+			}
+			break;
+		case NRF_CMD_R_RX_PL_WID:
+			if (data_size) {
+				out[1] = emu->rx.count ? emu->rx.slots[0].len : 0;
+			}
+			break;
+		case NRF_CMD_W_TX_PAYLOAD:
+			emu->tx_reuse = 0;
+			nrf_emu_fifo_push(&emu->tx, 0, 0, data, data_size);
+			break;
+		case NRF_CMD_W_TX_PAYLOAD_NO_ACK:
+			if (emu->regs[NRF_REG_FEATURE] & NRF_ENABLE_W_TX_PAYLOAD_CMD) {
+				emu->tx_reuse = 0;
+				nrf_emu_fifo_push(&emu->tx, 0, 1, data, data_size);
+			}
+			break;
+		case NRF_CMD_FLUSH_TX:
+			emu->tx.count = 0;
+			emu->tx_reuse = 0;
+			break;
+		case NRF_CMD_FLUSH_RX:
+			emu->rx.count = 0;
+			break;
+		case NRF_CMD_REUSE_TX_PL:
+			emu->tx_reuse = 1;
+			break;
+		default:
+			/* NOP and unknown commands only return STATUS */
+			break;
+		}
+	}
+
+	nrf_emu_step(emu);
+}
+
+/* Library callbacks */
+
+void nrf_emu_spi_xfer(const uint8_t *in, uint8_t *out, const size_t xfer_size)
+{
+	nrf_emu_xfer(nrf_emu_current, in, out, xfer_size);
+}
+
+void nrf_emu_spi_xfer_vec(const nrf_spi_segment *segments, const size_t count)
+{
+	for (size_t idx = 0; idx < count; idx++) {
+		nrf_emu_xfer(nrf_emu_current, segments[idx].in, segments[idx].out,
+			segments[idx].xfer_size);
+	}
+}
+
+void nrf_emu_spi_xfer_sg(const uint8_t cmd, uint8_t *status,
+	const uint8_t *in, uint8_t *out, const size_t xfer_size)
+{
+	uint8_t xfer_in[1 + NRF_PAYLOAD_SIZE_MAX];
+	uint8_t xfer_out[1 + NRF_PAYLOAD_SIZE_MAX];
+	const size_t size = (NRF_PAYLOAD_SIZE_MAX < xfer_size) ? NRF_PAYLOAD_SIZE_MAX : xfer_size;
+
+	xfer_in[0] = cmd;
+	for (size_t idx = 0; idx < size; idx++) {
+		xfer_in[idx + 1] = (NULL != in) ? in[idx] : (uint8_t) NRF_CMD_NOP;
+	}
+
+	nrf_emu_xfer(nrf_emu_current, xfer_in, xfer_out, size + 1);
+
+	*status = xfer_out[0];
+	if (NULL != out) {
+		memcpy(out, &xfer_out[1], size);
+	}
+}
+
+void nrf_emu_write_ce(nrf_gpio state)
+{
+	nrf_emu *emu = nrf_emu_current;
+	const uint8_t ce = (GPIO_SET == state);
+
+	if (ce != emu->ce) {
+		emu->counters.ce_toggles++;
+	}
+
+	if (ce && !emu->ce) {
+		emu->rx_channel = emu->regs[NRF_REG_RF_CH];
+		emu->rx_start_ns = emu->now_ns;
+	}
+
+	/* A CE rising edge sends a packet right away, so even a short pulse
+	 * sends one */
+	emu->ce = ce;
+	nrf_emu_step(emu);
+}
+
+nrf_gpio nrf_emu_read_irq(void)
+{
+	nrf_emu *emu = nrf_emu_current;
+	/* The CONFIG mask bits are in the same position as the STATUS flags */
+	const uint8_t active = emu->regs[NRF_REG_STATUS] & ~emu->regs[NRF_REG_CONFIG] &
+		NRF_EMU_FLAGS_MASK;
+
+	emu->counters.irq_reads++;
+
+	/* Active low */
+	return active ? GPIO_CLEAR : GPIO_SET;
+}
+
+void nrf_emu_delay_ms(uint32_t ms)
+{
+	nrf_emu_delay_us(ms * 1000U);
+}
+
+void nrf_emu_delay_us(uint32_t us)
+{
+	nrf_emu *emu = nrf_emu_current;
+
+	emu->counters.delay_calls++;
+	emu->counters.delay_us += us;
+
+	nrf_emu_advance(emu, us);
+}
+
+uint32_t nrf_emu_time_us(void)
+{
+	return (uint32_t) (nrf_emu_current->now_ns / 1000U);
+}
+
+/* Static functions */
+
+static uint8_t nrf_emu_addr_width(const nrf_emu *emu)
+{
+	const uint8_t aw = emu->regs[NRF_REG_SETUP_AW] & 0x03;
+
+	/* 00b is illegal, behave as 3 bytes */
+	return (uint8_t) (aw ? aw + 2 : 3);
+}
+
+static uint8_t nrf_emu_fifo_status(const nrf_emu *emu)
+{
+	uint8_t fifo_status = 0;
+
+	if (emu->tx_reuse) {
+		fifo_status |= NRF_FIFO_STATUS_TX_REUSE;
+	}
+
+	if (NRF_EMU_FIFO_DEPTH == emu->tx.count) {
+		fifo_status |= NRF_FIFO_STATUS_TX_FULL;
+	}
+
+	if (0 == emu->tx.count) {
+		fifo_status |= NRF_FIFO_STATUS_TX_EMPTY;
+	}
+
+	if (NRF_EMU_FIFO_DEPTH == emu->rx.count) {
+		fifo_status |= NRF_FIFO_STATUS_RX_FULL;
+	}
+
+	if (0 == emu->rx.count) {
+		fifo_status |= NRF_FIFO_STATUS_RX_EMPTY;
+	}
+
+	return fifo_status;
+}
+
+static uint8_t nrf_emu_read_reg_byte(const nrf_emu *emu, uint8_t reg, size_t idx)
+{
+	switch (reg) {
+	case NRF_REG_STATUS:
+		return nrf_emu_status(emu);
+	case NRF_REG_FIFO_STATUS:
+		return nrf_emu_fifo_status(emu);
+	case NRF_REG_RPD: {
+		/* RF_CH writes take effect on the next CE rising edge */
+		const uint8_t ch = emu->rx_channel;
+		const uint8_t listening = emu->ce &&
+			(emu->regs[NRF_REG_CONFIG] & NRF_CONFIG_PWR_UP) &&
+			(emu->regs[NRF_REG_CONFIG] & NRF_CONFIG_RECEIVER) &&
+			(emu->now_ns - emu->rx_start_ns >=
+				(uint64_t) (NRF_PLL_SETTLE_DELAY_US + NRF_RPD_DELAY_US) * 1000U);
+		return (uint8_t) (listening && (emu->carrier[ch / 8] & (1U << (ch % 8))));
+	}
+	case NRF_REG_RX_ADDR_P0:
+		return (idx < NRF_EMU_ADDR_MAX) ? emu->rx_addr_p0[idx] : 0;
+	case NRF_REG_RX_ADDR_P1:
+		return (idx < NRF_EMU_ADDR_MAX) ? emu->rx_addr_p1[idx] : 0;
+	case NRF_REG_TX_ADDR:
+		return (idx < NRF_EMU_ADDR_MAX) ? emu->tx_addr[idx] : 0;
+	default:
+		if ((NRF_EMU_REG_COUNT <= reg) || (0 != idx)) {
+			return 0;
+		}
+		return emu->regs[reg];
+	}
+}
+
+static void nrf_emu_write_reg(nrf_emu *emu, uint8_t reg, const uint8_t *data, size_t size)
+{
+	uint8_t *addr = NULL;
+
+	if (0 == size) {
+		return;
+	}
+
+	switch (reg) {
+	case NRF_REG_STATUS:
+		/* Write 1 to clear the flags */
+		emu->regs[NRF_REG_STATUS] &= (uint8_t) ~(data[0] & NRF_EMU_FLAGS_MASK);
+		return;
+	case NRF_REG_OBSERVE_TX:
+	case NRF_REG_RPD:
+	case NRF_REG_FIFO_STATUS:
+		/* Read only */
+		return;
+	case NRF_REG_RF_CH:
+		/* Writing RF_CH resets the lost packets count */
+		emu->regs[NRF_REG_OBSERVE_TX] &= NRF_OBSERVE_TX_ARC_CNT_MASK;
+		emu->regs[NRF_REG_RF_CH] = data[0] & 0x7F;
+		return;
+	case NRF_REG_RX_ADDR_P0:
+		addr = emu->rx_addr_p0;
+		break;
+	case NRF_REG_RX_ADDR_P1:
+		addr = emu->rx_addr_p1;
+		break;
+	case NRF_REG_TX_ADDR:
+		addr = emu->tx_addr;
+		break;
+	default:
+		if (NRF_EMU_REG_COUNT > reg) {
+			emu->regs[reg] = data[0];
+		}
+		return;
+	}
+
+	for (size_t idx = 0; (idx < size) && (idx < NRF_EMU_ADDR_MAX); idx++) {
+		addr[idx] = data[idx];
+	}
+}
+
+static int nrf_emu_fifo_push(nrf_emu_fifo *fifo, uint8_t pipe, uint8_t no_ack,
+	const uint8_t *data, size_t len)
+{
+	if (NRF_EMU_FIFO_DEPTH == fifo->count) {
+		return 1;
+	}
+
+	if (NRF_PAYLOAD_SIZE_MAX < len) {
+		len = NRF_PAYLOAD_SIZE_MAX;
+	}
+
+	nrf_emu_packet *packet = &fifo->slots[fifo->count++];
+
+	packet->pipe = pipe;
+	packet->no_ack = no_ack;
+	packet->len = (uint8_t) len;
+	memcpy(packet->data, data, len);
+
+	return 0;
+}
+
+static void nrf_emu_fifo_pop(nrf_emu_fifo *fifo)
+{
+	if (0 == fifo->count) {
+		return;
+	}
+
+	fifo->count--;
+	memmove(&fifo->slots[0], &fifo->slots[1], fifo->count * sizeof fifo->slots[0]);
+}
+
+/* Send one packet if the radio is transmitting */
+static void nrf_emu_step(nrf_emu *emu)
+{
+	if (nrf_emu_can_transmit(emu)) {
+		nrf_emu_transmit(emu);
+	}
+}
+
+static int nrf_emu_can_transmit(const nrf_emu *emu)
+{
+	const uint8_t config = emu->regs[NRF_REG_CONFIG];
+
+	return (config & NRF_CONFIG_PWR_UP) &&
+		!(config & NRF_CONFIG_RECEIVER) &&
+		emu->ce &&
+		emu->tx.count &&
+		/* MAX_RT must be cleared to continue */
+		!(emu->regs[NRF_REG_STATUS] & NRF_STATUS_MAX_RT_MASK);
+}
+
+static void nrf_emu_transmit(nrf_emu *emu)
+{
+	const nrf_emu_packet *packet = &emu->tx.slots[0];
+	const uint8_t auto_ack = !packet->no_ack &&
+		(emu->regs[NRF_REG_EN_AA] & NRF_ENABLE_AUTO_ACK_PIPE0);
+	const uint8_t arc = emu->regs[NRF_REG_SETUP_RETR] & 0x0F;
+	const uint8_t ard = emu->regs[NRF_REG_SETUP_RETR] >> NRF_SETUP_RETR_BIT_ARD;
+	uint8_t plos = emu->regs[NRF_REG_OBSERVE_TX] >> NRF_OBSERVE_TX_BIT_PLOS_CNT;
+	int rx_state = NRF_EMU_NOT_RECEIVED;
+	uint8_t attempt;
+
+	/* PLL settling */
+	emu->now_ns += (uint64_t) NRF_PLL_SETTLE_DELAY_US * 1000U;
+
+	for (attempt = 0; attempt <= arc; attempt++) {
+		int lost = 0;
+
+		emu->now_ns += (uint64_t) nrf_emu_air_time_us(emu, packet->len) * 1000U;
+		emu->counters.packets_sent++;
+
+		if (emu->drop_next) {
+			emu->drop_next--;
+			lost = 1;
+		} else if (NRF_EMU_NOT_RECEIVED == rx_state) {
+			/* Retransmissions of a received packet are discarded by the
+			 * receiver, but ACKed */
+			rx_state = nrf_emu_deliver(emu, packet);
+		}
+
+		if (!auto_ack || (!lost && (NRF_EMU_ACKED == rx_state))) {
+			break;
+		}
+
+		/* Wait for the ACK before retransmitting */
+		emu->now_ns += (uint64_t) (ard + 1) * 250U * 1000U;
+	}
+
+	if (attempt > arc) {
+		if (0x0F > plos) {
+			plos++;
+		}
+
+		emu->regs[NRF_REG_OBSERVE_TX] = (uint8_t) ((plos << NRF_OBSERVE_TX_BIT_PLOS_CNT) | arc);
+		emu->regs[NRF_REG_STATUS] |= NRF_STATUS_MAX_RT_MASK;
+		/* The payload stays on the TX FIFO */
+		return;
+	}
+
+	emu->regs[NRF_REG_OBSERVE_TX] = (uint8_t) ((plos << NRF_OBSERVE_TX_BIT_PLOS_CNT) | attempt);
+	emu->regs[NRF_REG_STATUS] |= NRF_STATUS_TX_DS_MASK;
+	emu->counters.packets_acked++;
+
+	/* ACK payload from the peer */
+	if (auto_ack && (NULL != emu->peer) && emu->peer->ack.count &&
+		(emu->regs[NRF_REG_FEATURE] & NRF_ENABLE_PAYLOAD_WITH_ACK)) {
+		nrf_emu_packet ack = emu->peer->ack.slots[0];
+		nrf_emu_fifo_pop(&emu->peer->ack);
+
+		if (0 == nrf_emu_fifo_push(&emu->rx, NRF_PIPE0, 0, ack.data, ack.len)) {
+			emu->regs[NRF_REG_STATUS] |= NRF_STATUS_RX_DR_MASK;
+			emu->counters.packets_received++;
+		}
+	}
+
+	if (!emu->tx_reuse) {
+		nrf_emu_fifo_pop(&emu->tx);
+	}
+}
+
+static int nrf_emu_deliver(nrf_emu *emu, const nrf_emu_packet *packet)
+{
+	nrf_emu *peer = emu->peer;
+
+	if (NULL == peer) {
+		/* Nobody listening: ACK everything */
+		return NRF_EMU_ACKED;
+	}
+
+	const uint8_t config = peer->regs[NRF_REG_CONFIG];
+	const uint8_t width = nrf_emu_addr_width(emu);
+
+	if (!(config & NRF_CONFIG_PWR_UP) || !(config & NRF_CONFIG_RECEIVER) || !peer->ce ||
+		/* RF_CH writes take effect on the next CE rising edge */
+		(peer->rx_channel != emu->regs[NRF_REG_RF_CH]) ||
+		(nrf_emu_addr_width(peer) != width)) {
+		peer->counters.packets_dropped++;
+		return NRF_EMU_NOT_RECEIVED;
+	}
+
+	const int pipe = nrf_emu_match_pipe(peer, emu->tx_addr, width);
+
+	if ((0 > pipe) || nrf_emu_fifo_push(&peer->rx, (uint8_t) pipe, 0, packet->data, packet->len)) {
+		peer->counters.packets_dropped++;
+		return NRF_EMU_NOT_RECEIVED;
+	}
+
+	/* Static payload length */
+	if (!(peer->regs[NRF_REG_DYNPD] & (1U << pipe))) {
+		peer->rx.slots[peer->rx.count - 1].len = peer->regs[NRF_REG_RX_PW_P0 + pipe] & NRF_RX_PW_MASK;
+	}
+
+	peer->regs[NRF_REG_STATUS] |= NRF_STATUS_RX_DR_MASK;
+	peer->counters.packets_received++;
+
+	/* No ACK from a pipe with auto ACK disabled */
+	if (!(peer->regs[NRF_REG_EN_AA] & (1U << pipe))) {
+		return NRF_EMU_NOT_ACKED;
+	}
+
+	/* The ACK is sent back to TX_ADDR, the transmitter gets it on pipe 0 */
+	if (memcmp(emu->rx_addr_p0, emu->tx_addr, width)) {
+		return NRF_EMU_NOT_ACKED;
+	}
+
+	return NRF_EMU_ACKED;
+}
+
+static int nrf_emu_match_pipe(const nrf_emu *emu, const uint8_t *addr, uint8_t width)
+{
+	const uint8_t en_rxaddr = emu->regs[NRF_REG_EN_RXADDR];
+
+	if ((en_rxaddr & NRF_ENABLE_PIPE0) && !memcmp(emu->rx_addr_p0, addr, width)) {
+		return NRF_PIPE0;
+	}
+
+	/* Pipes 2 to 5 share the bytes of pipe 1 but the LSB */
+	if (memcmp(&emu->rx_addr_p1[1], &addr[1], width - 1U)) {
+		return -1;
+	}
+
+	if ((en_rxaddr & NRF_ENABLE_PIPE1) && (emu->rx_addr_p1[0] == addr[0])) {
+		return NRF_PIPE1;
+	}
+
+	for (uint8_t pipe = NRF_PIPE2; pipe <= NRF_PIPE5; pipe++) {
+		if ((en_rxaddr & (1U << pipe)) &&
+			(emu->regs[NRF_REG_RX_ADDR_P0 + pipe] == addr[0])) {
+			return pipe;
+		}
+	}
+
+	return -1;
+}
+
+static uint32_t nrf_emu_air_time_us(const nrf_emu *emu, uint8_t payload_len)
+{
+	const uint8_t rf_setup = emu->regs[NRF_REG_RF_SETUP];
+	const uint8_t config = emu->regs[NRF_REG_CONFIG];
+	uint32_t crc = 0;
+	uint32_t kbps = 1000;
+
+	if (rf_setup & NRF_RF_SETUP_RF_DR_250) {
+		kbps = 250;
+	} else if (rf_setup & NRF_RF_SETUP_RF_DR_2000) {
+		kbps = 2000;
+	}
+
+	if (config & NRF_CONFIG_ENABLE_CRC) {
+		crc = (config & NRF_CONFIG_2_BYTE_CRC) ? 2 : 1;
+	}
+
+	const uint32_t bits = 8U * (1U + nrf_emu_addr_width(emu) + payload_len + crc) +
+		NRF_EMU_PCF_BITS;
+
+	return (bits * 1000U + kbps - 1U) / kbps;
+}
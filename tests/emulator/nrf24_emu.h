@@ -0,0 +1,168 @@
+/**
+* @file     nrf24_emu.h
+* @version  0.1
+*
+* @brief    Register level nRF24L01+ emulator, plugs into the library as the
+* user callbacks so it can be used as a SPI backend on a host machine.
+*
+* It models the register file, the command decoder, the 3-deep TX, RX and
+* ACK payload FIFOs, the STATUS/IRQ flags, dynamic payload widths, ACK
+* payloads and auto retransmissions. Two emulators can be linked so the
+* packets sent by one of them are received by the other one, an emulator
+* without a peer ACKs every packet (unless told to drop them).
+*
+* Time is emulated: it only advances with the SPI bytes clocked, the delays
+* requested by the library and the time on air of the packets, so the
+* results are deterministic.
+*
+* The library callbacks don't have a context, so they work on the emulator
+* selected with nrf_emu_select.
+*/
+
+#ifndef NRF24_EMU_H
+#define NRF24_EMU_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+
+enum {
+	NRF_EMU_FIFO_DEPTH	= 3,
+	NRF_EMU_REG_COUNT	= NRF_REG_FEATURE + 1,
+	NRF_EMU_ADDR_MAX	= 5,
+	/* SPI clock of 8MHz */
+	NRF_EMU_SPI_BYTE_NS	= 1000,
+};
+
+typedef struct {
+	uint8_t	pipe;
+	uint8_t	len;
+	uint8_t	no_ack;
+	uint8_t	data[NRF_PAYLOAD_SIZE_MAX];
+} nrf_emu_packet;
+
+typedef struct {
+	nrf_emu_packet	slots[NRF_EMU_FIFO_DEPTH];
+	uint8_t		count;
+} nrf_emu_fifo;
+
+/* Everything the driver did to the emulated radio */
+typedef struct {
+	unsigned long	spi_transactions;
+	unsigned long	spi_bytes;
+	unsigned long	ce_toggles;
+	unsigned long	irq_reads;
+	unsigned long	delay_calls;
+	unsigned long	delay_us;
+	unsigned long	packets_sent;
+	unsigned long	packets_acked;
+	unsigned long	packets_received;
+	unsigned long	packets_dropped;
+} nrf_emu_counters;
+
+typedef struct nrf_emu nrf_emu;
+
+struct nrf_emu {
+	uint8_t			regs[NRF_EMU_REG_COUNT];
+	uint8_t			rx_addr_p0[NRF_EMU_ADDR_MAX];
+	uint8_t			rx_addr_p1[NRF_EMU_ADDR_MAX];
+	uint8_t			tx_addr[NRF_EMU_ADDR_MAX];
+	nrf_emu_fifo		tx;
+	nrf_emu_fifo		rx;
+	nrf_emu_fifo		ack;
+	uint8_t			ce;
+	uint8_t			tx_reuse;
+	/* Channels with a carrier, read through RPD */
+	uint8_t			carrier[(NRF_MAX_RF_CHANNEL + 8) / 8];
+	/* Channel tuned and time of the last CE rising edge, RPD is valid
+	 * once the receiver settled on it */
+	uint8_t			rx_channel;
+	uint64_t		rx_start_ns;
+	/* Number of next transmission attempts lost on air */
+	unsigned long		drop_next;
+	nrf_emu			*peer;
+	uint64_t		now_ns;
+	nrf_emu_counters	counters;
+};
+
+/**
+ * @brief Reset the emulator, registers get their power on values.
+ */
+void nrf_emu_init(nrf_emu *emu);
+
+/**
+ * @brief Packets sent by @p a are received by @p b and vice versa.
+ */
+void nrf_emu_link(nrf_emu *a, nrf_emu *b);
+
+/**
+ * @brief Emulator used by the callbacks.
+ */
+void nrf_emu_select(nrf_emu *emu);
+
+/**
+ * @brief Reset the counters.
+ */
+void nrf_emu_reset_counters(nrf_emu *emu);
+
+/**
+ * @brief Lose the next @p attempts transmission attempts (packets or ACKs).
+ */
+void nrf_emu_drop_next(nrf_emu *emu, unsigned long attempts);
+
+/**
+ * @brief Set or clear a carrier on @p channel, detected with RPD.
+ */
+void nrf_emu_set_carrier(nrf_emu *emu, uint8_t channel, uint8_t present);
+
+/**
+ * @brief Place a packet in the RX FIFO as if it was received on @p pipe.
+ *
+ * @return 0 on success, 1 if the RX FIFO is full.
+ */
+int nrf_emu_inject_rx(nrf_emu *emu, uint8_t pipe, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Pop the oldest packet from the TX FIFO without sending it.
+ *
+ * @return 0 on success, 1 if the TX FIFO is empty.
+ */
+int nrf_emu_pop_tx(nrf_emu *emu, nrf_emu_packet *packet);
+
+/**
+ * @brief Advance the emulated time, packets pending are sent.
+ */
+void nrf_emu_advance(nrf_emu *emu, uint32_t us);
+
+/**
+ * @brief Current value of the STATUS register.
+ */
+uint8_t nrf_emu_status(const nrf_emu *emu);
+
+/**
+ * @brief Perform a SPI transaction on @p emu.
+ */
+void nrf_emu_xfer(nrf_emu *emu, const uint8_t *in, uint8_t *out, size_t xfer_size);
+
+/* Library callbacks working on the selected emulator */
+void nrf_emu_spi_xfer(const uint8_t *in, uint8_t *out, const size_t xfer_size);
+void nrf_emu_spi_xfer_vec(const nrf_spi_segment *segments, const size_t count);
+void nrf_emu_spi_xfer_sg(const uint8_t cmd, uint8_t *status,
+	const uint8_t *in, uint8_t *out, const size_t xfer_size);
+void nrf_emu_write_ce(nrf_gpio state);
+nrf_gpio nrf_emu_read_irq(void);
+void nrf_emu_delay_ms(uint32_t ms);
+void nrf_emu_delay_us(uint32_t us);
+uint32_t nrf_emu_time_us(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_EMU_H */
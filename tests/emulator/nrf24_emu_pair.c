@@ -0,0 +1,35 @@
+/**
+* @file     nrf24_emu_pair.c
+* @version  0.1
+*
+* @brief    Two linked emulators brought up through the library.
+*/
+
+#include "NRF24_INTERFACE.h"
+
+#include "nrf24_emu_pair.h"
+
+static void nrf_emu_pair_radio_init(nrf_radio *radio, uint8_t config);
+
+void nrf_emu_pair_init(nrf_emu *ptx_emu, nrf_emu *prx_emu, nrf_radio *ptx, nrf_radio *prx)
+{
+	nrf_emu_init(ptx_emu);
+	nrf_emu_init(prx_emu);
+	nrf_emu_link(ptx_emu, prx_emu);
+
+	nrf_emu_select(ptx_emu);
+	nrf_emu_pair_radio_init(ptx, NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP);
+
+	nrf_emu_select(prx_emu);
+	nrf_emu_pair_radio_init(prx, NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP |
+		NRF_CONFIG_RECEIVER);
+	NRF24_set_payload_size(prx, NRF_PLD_SIZE_PIPE0, 4);
+	NRF24_start_listening(prx);
+}
+
+static void nrf_emu_pair_radio_init(nrf_radio *radio, uint8_t config)
+{
+	NRF24_init(radio, nrf_emu_spi_xfer, nrf_emu_write_ce, nrf_emu_read_irq,
+		nrf_emu_delay_ms, nrf_emu_delay_us);
+	NRF24_write_reg(radio, NRF_REG_CONFIG, &config, 1);
+}
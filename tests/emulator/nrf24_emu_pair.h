@@ -0,0 +1,32 @@
+/**
+* @file     nrf24_emu_pair.h
+* @version  0.1
+*
+* @brief    Two linked emulators brought up through the library, the set up
+* shared by the tests driving a transmitter and a receiver.
+*/
+
+#ifndef NRF24_EMU_PAIR_H
+#define NRF24_EMU_PAIR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "NRF24.h"
+#include "nrf24_emu.h"
+
+/**
+ * @brief Reset and link @p ptx_emu and @p prx_emu, and init @p ptx and
+ * @p prx on them with the emulator callbacks.
+ *
+ * Both radios are powered up with CRC enabled, @p prx is a receiver
+ * listening for 4 byte payloads on pipe 0. @p prx_emu is left selected.
+ */
+void nrf_emu_pair_init(nrf_emu *ptx_emu, nrf_emu *prx_emu, nrf_radio *ptx, nrf_radio *prx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NRF24_EMU_PAIR_H */
@@ -10,6 +10,10 @@ extern "C"
 
 #include "NRF24.h"
 #include "NRF24_HAL.h"
+#include "NRF24_INTERFACE.h"
+#include "NRF24_COMMANDS.h"
+#include "NRF24_ASYNC.h"
+#include "NRF24_RING.h"
 
 #include "user_callbacks.h"
 }
@@ -24,7 +28,11 @@ TEST_GROUP(NRF24)
 	radio.write_ce_cb = NULL;
 	radio.read_irq_cb = NULL;
 	radio.delay_ms_cb = NULL;
+	radio.delay_us_cb = NULL;
 	radio.spi_xfer_data_cb = NULL;
+	radio.spi_xfer_vec_cb = NULL;
+	radio.spi_xfer_sg_cb = NULL;
+	radio.time_us_cb = NULL;
     }
 
     void teardown(void)
@@ -45,11 +53,19 @@ TEST_GROUP(NRF24)
             .withOutputParameterReturning("out", (unsigned char *) &dummy, 1)
             .withParameter("xfer_size", 1);
     }
+
+    /* The buffers must be valid until the expected call is made */
+    void expectSpiXfer(const uint8_t *in, const uint8_t *out, size_t xfer_size) {
+        mock().expectOneCall("mock_spi_xfer")
+            .withMemoryBufferParameter("in", in, xfer_size)
+            .withOutputParameterReturning("out", out, xfer_size)
+            .withParameter("xfer_size", (unsigned int) xfer_size);
+    }
 };
 
 TEST(NRF24, GivenNoUserCallbacksThenInitFail)
 {
-    int success = NRF24_init(&radio, NULL, NULL, NULL, NULL);
+    int success = NRF24_init(&radio, NULL, NULL, NULL, NULL, NULL);
     
     CHECK_EQUAL(1, success);
 }
@@ -59,7 +75,8 @@ TEST(NRF24, GivenUserCallbacksThenInitSuccess)
     int success = NRF24_init(&radio, mock_spi_xfer,
         mock_ce_write,
         NULL,
-        mock_delay_cb);
+        mock_delay_cb,
+        NULL);
     
     CHECK_EQUAL(0, success);
 }
@@ -72,7 +89,8 @@ TEST(NRF24, callCeWrite)
     int success = NRF24_init(&radio, mock_spi_xfer,
         mock_ce_write,
         NULL,
-        mock_delay_cb);
+        mock_delay_cb,
+        NULL);
     
     (void) success;
 
@@ -90,7 +108,8 @@ TEST(NRF24, readIrqSignal)
     int success = NRF24_init(&radio, mock_spi_xfer,
         mock_ce_write,
         mock_irq_read,
-        mock_delay_cb);
+        mock_delay_cb,
+        NULL);
     
     (void) success;
 
@@ -104,7 +123,7 @@ TEST(NRF24, readIrqSignal)
 
 TEST(NRF24, detectAndClearIrqFlags)
 {
-    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, mock_irq_read, mock_delay_cb);
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, mock_irq_read, mock_delay_cb, NULL);
 
     uint8_t rx_interrupt_flag = NRF_RX_DR_IRQ | 0x0E;
 
@@ -117,14 +136,11 @@ TEST(NRF24, detectAndClearIrqFlags)
     
     CHECK_EQUAL(NRF_RX_DR_IRQ, flag);
 
-    /* Expect a call to NRF24_get_status */
-    simulateStatus(rx_interrupt_flag);
-
     /* Expect an update to NRF_REG_STATUS register, the interrupt flag is
-     * cleared by writing a 1 to that flag. */
+     * cleared by writing a 1 to that flag and 0 to the others. */
     const uint8_t status_reg[] = {
         NRF_CMD_W_REGISTER | NRF_REG_STATUS,
-        NRF_RX_DR_IRQ | 0x0E
+        NRF_RX_DR_IRQ
     };
     uint8_t dummy[] = {0xFF, 0xFF};
 
@@ -138,3 +154,358 @@ TEST(NRF24, detectAndClearIrqFlags)
     mock().checkExpectations();
     mock().clear();
 }
+
+TEST(NRF24, minRetransmitDelayFollowsTheDatasheet)
+{
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_250_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_2000, 15));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_500_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_2000, 16));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_250_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_1000, 5));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_500_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_1000, 6));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_500_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_250, 0));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_750_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_250, 1));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_750_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_250, 8));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_1000_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_250, 9));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_1500_US, NRF24_min_retransmit_delay(NRF_RF_SETUP_RF_DR_250, 32));
+}
+
+TEST(NRF24, transmitPulseUsesTheMicrosecondsDelay)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb,
+        mock_delay_us_cb);
+
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_SET);
+    mock().expectOneCall("mock_delay_us_cb").withParameter("us", NRF_CE_PULSE_WIDTH_US);
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_CLEAR);
+
+    NRF24_transmit_pulse(&radio);
+}
+
+TEST(NRF24, withoutMicrosecondsDelayTheDelayIsRoundedUpToMilliseconds)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_SET);
+    mock().expectOneCall("mock_delay_cb").withParameter("ms", 1);
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_CLEAR);
+
+    NRF24_transmit_pulse(&radio);
+}
+
+TEST(NRF24, setChannelWithoutVectoredSpiIsThreeTransactions)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t write_channel[] = {NRF_CMD_W_REGISTER | NRF_REG_RF_CH, 76};
+    const uint8_t flush_rx[] = {NRF_CMD_FLUSH_RX};
+    const uint8_t flush_tx[] = {NRF_CMD_FLUSH_TX};
+    const uint8_t status[] = {0x0E, 0x0E};
+
+    expectSpiXfer(write_channel, status, sizeof write_channel);
+    expectSpiXfer(flush_rx, status, sizeof flush_rx);
+    expectSpiXfer(flush_tx, status, sizeof flush_tx);
+
+    NRF24_set_channel(&radio, 76);
+}
+
+TEST(NRF24, setChannelWithVectoredSpiIsOneSubmission)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+    NRF24_set_spi_xfer_vec_cb(&radio, mock_spi_xfer_vec);
+
+    const uint8_t write_channel[] = {NRF_CMD_W_REGISTER | NRF_REG_RF_CH, NRF_MAX_RF_CHANNEL};
+    const uint8_t flush_rx[] = {NRF_CMD_FLUSH_RX};
+    const uint8_t flush_tx[] = {NRF_CMD_FLUSH_TX};
+    const uint8_t status[] = {0x0E, 0x0E};
+
+    mock().expectOneCall("mock_spi_xfer_vec").withParameter("count", 3);
+    expectSpiXfer(write_channel, status, sizeof write_channel);
+    expectSpiXfer(flush_rx, status, sizeof flush_rx);
+    expectSpiXfer(flush_tx, status, sizeof flush_tx);
+
+    /* The channel is limited to NRF_MAX_RF_CHANNEL */
+    NRF24_set_channel(&radio, 200);
+}
+
+TEST(NRF24, txPayloadWithoutScatterGatherSpiIsCopied)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t payload[] = {0xCA, 0xFE, 0xBE, 0xEF};
+    const uint8_t write_payload[] = {NRF_CMD_W_TX_PAYLOAD, 0xCA, 0xFE, 0xBE, 0xEF};
+    const uint8_t status[sizeof write_payload] = {0x0E};
+
+    expectSpiXfer(write_payload, status, sizeof write_payload);
+
+    NRF24_put_in_tx_fifo(&radio, payload, sizeof payload);
+}
+
+TEST(NRF24, rxPayloadWithScatterGatherSpiIsReadIntoTheUserBuffer)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+    NRF24_set_spi_xfer_sg_cb(&radio, mock_spi_xfer_sg);
+
+    const uint8_t status = 0x40;
+    const uint8_t received[] = {0xCA, 0xFE, 0xBE, 0xEF};
+    uint8_t payload[4] = {0};
+
+    mock().expectOneCall("mock_spi_xfer_sg")
+        .withParameter("cmd", NRF_CMD_R_RX_PAYLOAD)
+        .withOutputParameterReturning("status", &status, 1)
+        .withOutputParameterReturning("out", received, sizeof received)
+        .withParameter("xfer_size", 4);
+
+    CHECK_EQUAL(status, NRF24_cmd_read_rx_payload(&radio, payload, sizeof payload));
+    MEMCMP_EQUAL(received, payload, sizeof payload);
+}
+
+TEST(NRF24, transmitStreamRefillsTheTxFifoOnTxDs)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t payload[] = {0xCA, 0xFE};
+    const uint8_t nop[] = {NRF_CMD_NOP};
+    const uint8_t write_payload[] = {NRF_CMD_W_TX_PAYLOAD, 0xCA, 0xFE};
+    const uint8_t clear_tx_ds[] = {NRF_CMD_W_REGISTER | NRF_REG_STATUS, NRF_STATUS_TX_DS_MASK};
+    const uint8_t read_fifo_status[] = {NRF_CMD_R_REGISTER | NRF_REG_FIFO_STATUS, NRF_CMD_NOP};
+    const uint8_t idle[] = {0x0E, 0x0E, 0x0E};
+    const uint8_t sent[] = {0x2E};
+    const uint8_t fifo_status[] = {0x0E, 0x11};
+    size_t queued = 0;
+
+    expectSpiXfer(nop, idle, sizeof nop);
+    expectSpiXfer(write_payload, idle, sizeof write_payload);
+    expectSpiXfer(nop, idle, sizeof nop);
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_SET);
+    expectSpiXfer(nop, sent, sizeof nop);
+    expectSpiXfer(clear_tx_ds, idle, sizeof clear_tx_ds);
+    expectSpiXfer(read_fifo_status, fifo_status, sizeof read_fifo_status);
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_CLEAR);
+
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_transmit_stream(&radio, payload, sizeof payload, 1, &queued));
+    CHECK_EQUAL(1, queued);
+}
+
+TEST(NRF24, receiveAllTakesThePipeFromTheStatusAndClearsRxDrOnce)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t nop[] = {NRF_CMD_NOP};
+    const uint8_t read_dynpd[] = {NRF_CMD_R_REGISTER | NRF_REG_DYNPD, NRF_CMD_NOP};
+    const uint8_t read_rx_pw_p1[] = {NRF_CMD_R_REGISTER | NRF_REG_RX_PW_P1, NRF_CMD_NOP};
+    const uint8_t read_payload[] = {NRF_CMD_R_RX_PAYLOAD, NRF_CMD_NOP, NRF_CMD_NOP};
+    const uint8_t clear_rx_dr[] = {NRF_CMD_W_REGISTER | NRF_REG_STATUS, NRF_STATUS_RX_DR_MASK};
+    const uint8_t dynpd[] = {0x42, 0x00};
+    const uint8_t pipe1[] = {0x42};
+    const uint8_t rx_pw[] = {0x42, 2};
+    const uint8_t payload[] = {0x42, 0xCA, 0xFE};
+    const uint8_t rx_dr_empty[] = {0x4E, 0x4E};
+    nrf_packet packets[3];
+
+    expectSpiXfer(read_dynpd, dynpd, sizeof read_dynpd);
+    expectSpiXfer(nop, pipe1, sizeof nop);
+    expectSpiXfer(read_rx_pw_p1, rx_pw, sizeof read_rx_pw_p1);
+    expectSpiXfer(read_payload, payload, sizeof read_payload);
+    expectSpiXfer(nop, rx_dr_empty, sizeof nop);
+    expectSpiXfer(clear_rx_dr, rx_dr_empty, sizeof clear_rx_dr);
+
+    CHECK_EQUAL(1, NRF24_receive_all(&radio, packets, NRF_ARRAY_SIZE(packets)));
+    CHECK_EQUAL(NRF_PIPE1, packets[0].pipe);
+    CHECK_EQUAL(2, packets[0].payload_size);
+    MEMCMP_EQUAL(&payload[1], packets[0].payload, 2);
+}
+
+static void irqHandler(nrf_radio *radio, uint8_t status, void *context)
+{
+    (void) radio;
+    *(uint8_t *) context = status;
+}
+
+TEST(NRF24, pollInterruptSkipsTheSpiWhileTheIrqSignalIsHigh)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, mock_irq_read, mock_delay_cb, NULL);
+
+    mock().expectOneCall("mock_irq_read").andReturnValue(GPIO_SET);
+
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_poll_interrupt(&radio));
+}
+
+TEST(NRF24, pollInterruptClearsTheFlagsSetAndCallsTheHandlers)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, mock_irq_read, mock_delay_cb, NULL);
+
+    const uint8_t nop[] = {NRF_CMD_NOP};
+    const uint8_t status[] = {NRF_RX_DR_IRQ | NRF_MAX_RT_IRQ | 0x02, 0x00};
+    const uint8_t clear_flags[] = {NRF_CMD_W_REGISTER | NRF_REG_STATUS,
+        NRF_RX_DR_IRQ | NRF_MAX_RT_IRQ};
+    uint8_t rx_dr_status = 0;
+    uint8_t tx_ds_status = 0;
+
+    NRF24_set_irq_handler(&radio, NRF_RX_DR_IRQ, irqHandler, &rx_dr_status);
+    NRF24_set_irq_handler(&radio, NRF_TX_DS_IRQ, irqHandler, &tx_ds_status);
+
+    mock().expectOneCall("mock_irq_read").andReturnValue(GPIO_CLEAR);
+    expectSpiXfer(nop, status, sizeof nop);
+    expectSpiXfer(clear_flags, status, sizeof clear_flags);
+
+    CHECK_EQUAL(NRF_RX_DR_IRQ | NRF_MAX_RT_IRQ, NRF24_poll_interrupt(&radio));
+    CHECK_EQUAL(status[0], rx_dr_status);
+    CHECK_EQUAL(0, tx_ds_status);
+}
+
+TEST(NRF24, ringKeepsThePacketsInOrderAcrossTheWrapAround)
+{
+    nrf_packet slots[2];
+    nrf_ring ring;
+    nrf_packet packet = {NRF_PIPE0, 1, {0}};
+
+    NRF24_ring_init(&ring, slots, NRF_ARRAY_SIZE(slots));
+    CHECK_EQUAL(1, NRF24_ring_pop(&ring, &packet));
+
+    for (uint8_t idx = 0; idx < 5; idx++) {
+        packet.payload[0] = idx;
+        CHECK_EQUAL(0, NRF24_ring_push(&ring, &packet));
+        packet.payload[0] = idx + 100;
+        CHECK_EQUAL(0, NRF24_ring_push(&ring, &packet));
+        /* Full */
+        CHECK_EQUAL(1, NRF24_ring_push(&ring, &packet));
+        CHECK_EQUAL(2, NRF24_ring_count(&ring));
+
+        CHECK_EQUAL(0, NRF24_ring_pop(&ring, &packet));
+        CHECK_EQUAL(idx, packet.payload[0]);
+        CHECK_EQUAL(0, NRF24_ring_pop(&ring, &packet));
+        CHECK_EQUAL(idx + 100, packet.payload[0]);
+        CHECK_EQUAL(0, NRF24_ring_count(&ring));
+    }
+}
+
+TEST(NRF24, pollInterruptMovesTheTxRingIntoTheTxFifo)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, mock_irq_read, mock_delay_cb, NULL);
+
+    nrf_packet slots[4];
+    nrf_ring tx_ring;
+    const nrf_packet packet = {NRF_PIPE0, 2, {0xCA, 0xFE}};
+    const uint8_t nop[] = {NRF_CMD_NOP};
+    const uint8_t write_payload[] = {NRF_CMD_W_TX_PAYLOAD, 0xCA, 0xFE};
+    const uint8_t idle[] = {0x0E, 0x0E, 0x0E};
+    const uint8_t tx_full[] = {0x0F};
+
+    NRF24_ring_init(&tx_ring, slots, NRF_ARRAY_SIZE(slots));
+    NRF24_set_rings(&radio, NULL, &tx_ring);
+    NRF24_ring_push(&tx_ring, &packet);
+    NRF24_ring_push(&tx_ring, &packet);
+
+    /* The IRQ signal is not checked while there are packets to send */
+    expectSpiXfer(nop, idle, sizeof nop);
+    expectSpiXfer(write_payload, idle, sizeof write_payload);
+    expectSpiXfer(nop, tx_full, sizeof nop);
+
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_poll_interrupt(&radio));
+    CHECK_EQUAL(1, NRF24_ring_count(&tx_ring));
+}
+
+#if defined(NRF24_ENABLE_ASYNC)
+static void asyncDone(nrf_radio *radio, uint8_t status, void *context)
+{
+    (void) radio;
+    *(uint8_t *) context = status;
+}
+
+TEST(NRF24, asyncRxPayloadIsReadBetweenCeToggles)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+    NRF24_set_spi_xfer_async_cb(&radio, mock_spi_xfer_async);
+
+    const uint8_t read_payload[] = {NRF_CMD_R_RX_PAYLOAD, NRF_CMD_NOP, NRF_CMD_NOP};
+    const uint8_t received[] = {0x40, 0xCA, 0xFE};
+    uint8_t payload[2] = {0};
+    uint8_t done_status = 0;
+
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_CLEAR);
+    mock().expectOneCall("mock_spi_xfer_async")
+        .withMemoryBufferParameter("in", read_payload, sizeof read_payload)
+        .withOutputParameterReturning("out", received, sizeof received)
+        .withParameter("xfer_size", 3);
+
+    CHECK_EQUAL(0, NRF24_async_get_rx_payload(&radio, payload, sizeof payload,
+        asyncDone, &done_status));
+    CHECK_TRUE(NRF24_async_is_busy(&radio));
+
+    /* Only one operation at a time */
+    CHECK_EQUAL(1, NRF24_async_clear_irq_flag(&radio, NRF_RX_DR_IRQ, NULL, NULL));
+
+    mock().checkExpectations();
+
+    /* The DMA is done */
+    mock().expectOneCall("mock_ce_write").withParameter("state", GPIO_SET);
+
+    NRF24_async_xfer_complete(&radio);
+
+    CHECK_FALSE(NRF24_async_is_busy(&radio));
+    CHECK_EQUAL(0x40, done_status);
+    MEMCMP_EQUAL(&received[1], payload, sizeof payload);
+}
+
+TEST(NRF24, asyncClearIrqFlagIsASingleWrite)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+    NRF24_set_spi_xfer_async_cb(&radio, mock_spi_xfer_async);
+
+    const uint8_t write_status[] = {NRF_CMD_W_REGISTER | NRF_REG_STATUS, NRF_TX_DS_IRQ};
+    const uint8_t status[] = {NRF_RX_DR_IRQ | NRF_TX_DS_IRQ | 0x02, 0x00};
+    uint8_t done_status = 0;
+
+    mock().expectOneCall("mock_spi_xfer_async")
+        .withMemoryBufferParameter("in", write_status, sizeof write_status)
+        .withOutputParameterReturning("out", status, sizeof status)
+        .withParameter("xfer_size", 2);
+
+    NRF24_async_clear_irq_flag(&radio, NRF_TX_DS_IRQ, asyncDone, &done_status);
+    CHECK_TRUE(NRF24_async_is_busy(&radio));
+
+    NRF24_async_xfer_complete(&radio);
+    CHECK_FALSE(NRF24_async_is_busy(&radio));
+    CHECK_EQUAL(status[0], done_status);
+}
+#endif
+
+#if defined(NRF24_ENABLE_REG_CACHE)
+TEST(NRF24, setBitOnCachedRegisterIsASingleWrite)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t write_config[] = {NRF_CMD_W_REGISTER | NRF_REG_CONFIG, NRF_CONFIG_ENABLE_CRC};
+    const uint8_t set_pwr_up[] = {NRF_CMD_W_REGISTER | NRF_REG_CONFIG,
+        NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP};
+    const uint8_t status[] = {0x0E, 0x00};
+
+    expectSpiXfer(write_config, status, sizeof write_config);
+    expectSpiXfer(set_pwr_up, status, sizeof set_pwr_up);
+
+    uint8_t config = NRF_CONFIG_ENABLE_CRC;
+    NRF24_write_reg(&radio, NRF_REG_CONFIG, &config, 1);
+    NRF24_set_bit(&radio, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP);
+}
+
+TEST(NRF24, getChannelIsAnsweredFromTheCache)
+{
+    NRF24_init(&radio, mock_spi_xfer, mock_ce_write, NULL, mock_delay_cb, NULL);
+
+    const uint8_t read_channel[] = {NRF_CMD_R_REGISTER | NRF_REG_RF_CH, NRF_CMD_NOP};
+    const uint8_t channel[] = {0x0E, 76};
+
+    /* Only the first read goes to the radio */
+    expectSpiXfer(read_channel, channel, sizeof read_channel);
+
+    CHECK_EQUAL(76, NRF24_get_channel(&radio));
+    CHECK_EQUAL(76, NRF24_get_channel(&radio));
+
+    mock().checkExpectations();
+
+    /* After invalidating the cache the register is read again */
+    expectSpiXfer(read_channel, channel, sizeof read_channel);
+
+    NRF24_reg_cache_invalidate(&radio);
+    CHECK_EQUAL(76, NRF24_get_channel(&radio));
+}
+#endif
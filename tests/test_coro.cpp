@@ -0,0 +1,190 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+
+#include "NRF24.h"
+#include "NRF24_ASYNC.h"
+#include "NRF24_INTERFACE.h"
+
+#include "nrf24_emu.h"
+}
+
+#if defined(NRF24_ENABLE_ASYNC) && (__cplusplus >= 202002L)
+
+#include "NRF24_CORO.hpp"
+
+enum {
+    CORO_PTX,
+    CORO_PRX,
+    CORO_RADIOS,
+    CORO_PACKETS = 3,
+};
+
+/* The callbacks have no context, one set per emulator */
+static nrf_emu emus[CORO_RADIOS];
+/* Async transfer done, waiting for NRF24_async_xfer_complete */
+static bool xfer_pending[CORO_RADIOS];
+
+template <int N>
+struct EmuCallbacks {
+    static void spi_xfer(const uint8_t *in, uint8_t *out, const size_t xfer_size)
+    {
+        nrf_emu_select(&emus[N]);
+        nrf_emu_spi_xfer(in, out, xfer_size);
+    }
+
+    static void spi_xfer_async(const uint8_t *in, uint8_t *out, const size_t xfer_size)
+    {
+        spi_xfer(in, out, xfer_size);
+        xfer_pending[N] = true;
+    }
+
+    static void write_ce(nrf_gpio state)
+    {
+        nrf_emu_select(&emus[N]);
+        nrf_emu_write_ce(state);
+    }
+
+    static nrf_gpio read_irq(void)
+    {
+        nrf_emu_select(&emus[N]);
+        return nrf_emu_read_irq();
+    }
+
+    static void delay_ms(uint32_t ms)
+    {
+        nrf_emu_select(&emus[N]);
+        nrf_emu_delay_ms(ms);
+    }
+
+    static void delay_us(uint32_t us)
+    {
+        nrf_emu_select(&emus[N]);
+        nrf_emu_delay_us(us);
+    }
+
+    static void init(nrf_radio *radio, uint8_t config)
+    {
+        NRF24_init(radio, spi_xfer, write_ce, read_irq, delay_ms, delay_us);
+        NRF24_set_spi_xfer_async_cb(radio, spi_xfer_async);
+        NRF24_write_reg(radio, NRF_REG_CONFIG, &config, 1);
+    }
+};
+
+static nrf24::Task<> sendPackets(nrf24::CoRadio &radio, nrf_irq *results, bool *done)
+{
+    for (uint8_t idx = 0; idx < CORO_PACKETS; idx++) {
+        const uint8_t payload[4] = {idx, 0x11, 0x22, 0x33};
+
+        results[idx] = co_await radio.send(payload);
+    }
+
+    *done = true;
+}
+
+static nrf24::Task<> receivePackets(nrf24::CoRadio &radio, uint8_t (*payloads)[4],
+    uint8_t *pipes, bool *done)
+{
+    for (size_t idx = 0; idx < CORO_PACKETS; idx++) {
+        pipes[idx] = co_await radio.receive(payloads[idx]);
+    }
+
+    *done = true;
+}
+
+/* Two radios, each one driven by a task, on a single executor */
+TEST_GROUP(NRF24_CORO)
+{
+    nrf_radio radios[CORO_RADIOS];
+    nrf24::Executor executor;
+
+    void setup(void)
+    {
+        nrf_emu_init(&emus[CORO_PTX]);
+        nrf_emu_init(&emus[CORO_PRX]);
+        nrf_emu_link(&emus[CORO_PTX], &emus[CORO_PRX]);
+        xfer_pending[CORO_PTX] = false;
+        xfer_pending[CORO_PRX] = false;
+
+        EmuCallbacks<CORO_PTX>::init(&radios[CORO_PTX],
+            NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP);
+        EmuCallbacks<CORO_PRX>::init(&radios[CORO_PRX],
+            NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER);
+        NRF24_set_payload_size(&radios[CORO_PRX], NRF_PLD_SIZE_PIPE0, 4);
+        NRF24_start_listening(&radios[CORO_PRX]);
+    }
+
+    /* The event loop: DMA completions and IRQ edges resume the tasks */
+    void runUntil(nrf24::CoRadio *co_radios[CORO_RADIOS], const bool *done)
+    {
+        for (size_t step = 0; (step < 200) && !*done; step++) {
+            executor.run();
+
+            for (size_t idx = 0; idx < CORO_RADIOS; idx++) {
+                if (xfer_pending[idx]) {
+                    xfer_pending[idx] = false;
+                    NRF24_async_xfer_complete(&radios[idx]);
+                } else if (GPIO_CLEAR == radios[idx].read_irq_cb()) {
+                    co_radios[idx]->notify_irq();
+                }
+            }
+        }
+    }
+};
+
+TEST(NRF24_CORO, sendAndReceiveRunConcurrentlyOnOneExecutor)
+{
+    nrf24::CoRadio ptx(&radios[CORO_PTX], executor);
+    nrf24::CoRadio prx(&radios[CORO_PRX], executor);
+    nrf24::CoRadio *co_radios[CORO_RADIOS] = {&ptx, &prx};
+    nrf_irq results[CORO_PACKETS] = {NRF_NONE_IRQ};
+    uint8_t payloads[CORO_PACKETS][4] = {{0}};
+    uint8_t pipes[CORO_PACKETS] = {0xFF, 0xFF, 0xFF};
+    bool sent = false;
+    bool received = false;
+
+    /* The receiver waits on the IRQ before anything is sent */
+    executor.spawn(receivePackets(prx, payloads, pipes, &received));
+    executor.run();
+    CHECK_FALSE(received);
+
+    executor.spawn(sendPackets(ptx, results, &sent));
+    runUntil(co_radios, &received);
+
+    CHECK_TRUE(sent);
+    CHECK_TRUE(received);
+    CHECK_TRUE(executor.idle());
+
+    for (uint8_t idx = 0; idx < CORO_PACKETS; idx++) {
+        const uint8_t expected[4] = {idx, 0x11, 0x22, 0x33};
+
+        CHECK_EQUAL(NRF_TX_DS_IRQ, results[idx]);
+        CHECK_EQUAL(0, pipes[idx]);
+        MEMCMP_EQUAL(expected, payloads[idx], sizeof expected);
+    }
+
+    /* Every flag was cleared */
+    CHECK_EQUAL(GPIO_SET, radios[CORO_PTX].read_irq_cb());
+    CHECK_EQUAL(GPIO_SET, radios[CORO_PRX].read_irq_cb());
+}
+
+TEST(NRF24_CORO, sendReturnsMaxRtWhenTheAcksAreLost)
+{
+    nrf24::CoRadio ptx(&radios[CORO_PTX], executor);
+    nrf24::CoRadio prx(&radios[CORO_PRX], executor);
+    nrf24::CoRadio *co_radios[CORO_RADIOS] = {&ptx, &prx};
+    nrf_irq results[CORO_PACKETS] = {NRF_NONE_IRQ};
+    bool sent = false;
+
+    nrf_emu_drop_next(&emus[CORO_PTX], 1000);
+    executor.spawn(sendPackets(ptx, results, &sent));
+    runUntil(co_radios, &sent);
+
+    CHECK_TRUE(sent);
+    CHECK_EQUAL(NRF_MAX_RT_IRQ, results[0]);
+    CHECK_EQUAL(NRF_MAX_RT_IRQ, results[CORO_PACKETS - 1]);
+}
+
+#endif
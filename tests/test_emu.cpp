@@ -0,0 +1,826 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+
+#include "NRF24.h"
+#include "NRF24_INTERFACE.h"
+#include "NRF24_CONFIG.h"
+#include "NRF24_NODES.h"
+#include "NRF24_LINK.h"
+#include "NRF24_SCAN.h"
+#include "NRF24_HOP.h"
+#include "NRF24_STATS.h"
+#include "NRF24_TRACE.h"
+
+#include "nrf24_emu.h"
+#include "nrf24_emu_pair.h"
+}
+
+/* Two linked emulated radios, the library talks to the selected one */
+TEST_GROUP(NRF24_EMU)
+{
+    nrf_emu ptx_emu;
+    nrf_emu prx_emu;
+    nrf_radio ptx;
+    nrf_radio prx;
+
+    void setup(void)
+    {
+        nrf_emu_pair_init(&ptx_emu, &prx_emu, &ptx, &prx);
+    }
+};
+
+TEST(NRF24_EMU, transmitStreamDeliversThePayloadsInOrder)
+{
+    const uint8_t payloads[3][4] = {
+        {0x00, 0x01, 0x02, 0x03},
+        {0x10, 0x11, 0x12, 0x13},
+        {0x20, 0x21, 0x22, 0x23},
+    };
+    nrf_packet packets[4];
+    size_t queued = 0;
+
+    nrf_emu_select(&ptx_emu);
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_transmit_stream(&ptx, &payloads[0][0],
+        sizeof payloads[0], 3, &queued));
+    CHECK_EQUAL(3, queued);
+    CHECK_EQUAL(3, ptx_emu.counters.packets_acked);
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(3, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+
+    for (size_t idx = 0; idx < 3; idx++) {
+        CHECK_EQUAL(NRF_PIPE0, packets[idx].pipe);
+        CHECK_EQUAL(4, packets[idx].payload_size);
+        MEMCMP_EQUAL(payloads[idx], packets[idx].payload, 4);
+    }
+
+    /* RX_DR was cleared */
+    CHECK_EQUAL(0, nrf_emu_status(&prx_emu) & NRF_STATUS_RX_DR_MASK);
+}
+
+TEST(NRF24_EMU, transmitStreamKeepsThePayloadsNotSentOnMaxRt)
+{
+    const uint8_t payloads[3][4] = {{0x00}, {0x01}, {0x02}};
+    nrf_packet packets[4];
+    size_t queued = 0;
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_drop_next(&ptx_emu, 4);
+
+    CHECK_EQUAL(NRF_MAX_RT_IRQ, NRF24_transmit_stream(&ptx, &payloads[0][0],
+        sizeof payloads[0], 2, &queued));
+    CHECK_EQUAL(2, queued);
+    CHECK_EQUAL(2, ptx_emu.tx.count);
+    CHECK_EQUAL(0, nrf_emu_status(&ptx_emu) & NRF_ALL_IRQ_MASK);
+    CHECK_EQUAL(0, prx_emu.counters.packets_received);
+
+    /* Carry on from where it stopped, the payloads left go first */
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_transmit_stream(&ptx, &payloads[queued][0],
+        sizeof payloads[0], 1, &queued));
+    CHECK_EQUAL(1, queued);
+    CHECK_EQUAL(0, ptx_emu.tx.count);
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(3, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+    for (size_t idx = 0; idx < 3; idx++) {
+        MEMCMP_EQUAL(payloads[idx], packets[idx].payload, 4);
+    }
+}
+
+TEST(NRF24_EMU, transmitStreamGivesUpWhenNothingIsSent)
+{
+    const uint8_t payload[4] = {0};
+    size_t queued = 0;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_power_state(&ptx, NRF_STATE_POWER_DOWN);
+
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_transmit_stream(&ptx, payload, sizeof payload, 1, &queued));
+    CHECK_EQUAL(1, queued);
+    CHECK_EQUAL(1, ptx_emu.tx.count);
+    CHECK_EQUAL(0, ptx_emu.ce);
+
+    /* With the timestamps it gives up after NRF_TX_TIMEOUT_US */
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    const uint32_t start = nrf_emu_time_us();
+
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_transmit_stream(&ptx, payload, sizeof payload, 1, &queued));
+    CHECK(NRF_TX_TIMEOUT_US <= nrf_emu_time_us() - start);
+    CHECK(2 * NRF_TX_TIMEOUT_US > nrf_emu_time_us() - start);
+    CHECK_EQUAL(2, ptx_emu.tx.count);
+}
+
+TEST(NRF24_EMU, ackPayloadIsReceivedByTheTransmitter)
+{
+    const uint8_t payload[] = {0xCA, 0xFE};
+    const uint8_t ack_payload[] = {0xBE, 0xEF, 0x01};
+    nrf_packet packets[3];
+
+    nrf_emu_select(&prx_emu);
+    NRF24_enable_dynamic_payload(&prx);
+    NRF24_enable_dynamic_payload_on_pipe(&prx, NRF_PIPE0);
+    NRF24_rx_write_payload(&prx, NRF_PIPE0, ack_payload, sizeof ack_payload);
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_enable_dynamic_payload(&ptx);
+    NRF24_enable_dynamic_payload_on_pipe(&ptx, NRF_PIPE0);
+    NRF24_transmit(&ptx, payload, sizeof payload);
+
+    CHECK_EQUAL(1, NRF24_receive_all(&ptx, packets, NRF_ARRAY_SIZE(packets)));
+    CHECK_EQUAL(sizeof ack_payload, packets[0].payload_size);
+    MEMCMP_EQUAL(ack_payload, packets[0].payload, sizeof ack_payload);
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(1, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+    CHECK_EQUAL(sizeof payload, packets[0].payload_size);
+    MEMCMP_EQUAL(payload, packets[0].payload, sizeof payload);
+}
+
+TEST(NRF24_EMU, pollInterruptDoesNoSpiWhileTheIrqSignalIsInactive)
+{
+    nrf_emu_select(&prx_emu);
+    nrf_emu_reset_counters(&prx_emu);
+
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_poll_interrupt(&prx));
+    CHECK_EQUAL(0, prx_emu.counters.spi_transactions);
+    CHECK_EQUAL(1, prx_emu.counters.irq_reads);
+}
+
+TEST(NRF24_EMU, configApplyWritesEveryRegisterOnce)
+{
+    const uint8_t address[] = {0x01, 0x02, 0x03, 0x04};
+    nrf_config config;
+    nrf_config read;
+
+    NRF24_config_defaults(&config);
+    config.config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP | NRF_CONFIG_RECEIVER;
+    config.setup_aw = NRF_SETUP_AW_4BYTES;
+    config.rf_ch = 76;
+    config.rf_setup = NRF_RF_SETUP_RF_DR_250 | NRF_RF_SETUP_RF_PWR_6;
+    memcpy(config.rx_addr_p1, address, sizeof address);
+    config.rx_pw[NRF_PIPE1] = 8;
+    config.dynpd = NRF_ENABLE_DYN_PAYLOAD_LEN_P0;
+    config.feature = NRF_ENABLE_DYN_PAYLOAD_LEN;
+
+    nrf_emu_select(&prx_emu);
+    nrf_emu_reset_counters(&prx_emu);
+    CHECK_EQUAL(NRF_CONFIG_MAX_SEGMENTS, NRF24_config_apply(&prx, &config, NULL));
+    CHECK_EQUAL(NRF_CONFIG_MAX_SEGMENTS, prx_emu.counters.spi_transactions);
+
+    CHECK_EQUAL(76, prx_emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(8, prx_emu.regs[NRF_REG_RX_PW_P1]);
+    MEMCMP_EQUAL(address, prx_emu.rx_addr_p1, sizeof address);
+
+    NRF24_config_read(&prx, &read);
+    config.rx_addr_p0[4] = 0;
+    config.rx_addr_p1[4] = 0;
+    config.tx_addr[4] = 0;
+    MEMCMP_EQUAL(&config, &read, sizeof config);
+}
+
+TEST(NRF24_EMU, configApplyOnlyWritesTheRegistersThatChanged)
+{
+    nrf_config config;
+    nrf_config next;
+
+    NRF24_config_defaults(&config);
+    config.config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_config_apply(&ptx, &config, NULL);
+
+    next = config;
+    next.rf_ch = 40;
+    next.tx_addr[0] = 0x55;
+
+    nrf_emu_reset_counters(&ptx_emu);
+    CHECK_EQUAL(2, NRF24_config_apply(&ptx, &next, &config));
+    CHECK_EQUAL(2, ptx_emu.counters.spi_transactions);
+    /* Already powered up */
+    CHECK_EQUAL(0, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(40, ptx_emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(0x55, ptx_emu.tx_addr[0]);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    CHECK_EQUAL(0, NRF24_config_apply(&ptx, &next, &next));
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+}
+
+TEST(NRF24_EMU, nodeSelectOnlyWritesTheAddressBytesThatChange)
+{
+    const uint8_t addrs[3][5] = {
+        {0x01, 0xB2, 0xB3, 0xB4, 0xB5},
+        {0x02, 0xB2, 0xB3, 0xB4, 0xB5},
+        {0x03, 0xB2, 0x00, 0xB4, 0xB5},
+    };
+    nrf_node nodes[3];
+    nrf_node_table table;
+    size_t ids[3];
+    size_t extra;
+
+    NRF24_node_table_init(&table, nodes, NRF_ARRAY_SIZE(nodes), NRF_PIPE_ADDR_WIDTH_5BYTES, 1);
+    for (size_t idx = 0; idx < NRF_ARRAY_SIZE(ids); idx++) {
+        CHECK_EQUAL(0, NRF24_node_add(&table, addrs[idx], &ids[idx]));
+    }
+    CHECK_EQUAL(1, NRF24_node_add(&table, addrs[0], &extra));
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_node_select(&ptx, &table, ids[0]);
+    CHECK_EQUAL(2, ptx_emu.counters.spi_transactions);
+    CHECK_EQUAL(12, ptx_emu.counters.spi_bytes);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_node_select(&ptx, &table, ids[0]);
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+
+    NRF24_node_select(&ptx, &table, ids[1]);
+    CHECK_EQUAL(2, ptx_emu.counters.spi_transactions);
+    CHECK_EQUAL(4, ptx_emu.counters.spi_bytes);
+    MEMCMP_EQUAL(addrs[1], ptx_emu.tx_addr, 5);
+    MEMCMP_EQUAL(addrs[1], ptx_emu.rx_addr_p0, 5);
+
+    NRF24_node_select(&ptx, &table, ids[2]);
+    CHECK_EQUAL(4, ptx_emu.counters.spi_transactions);
+    CHECK_EQUAL(12, ptx_emu.counters.spi_bytes);
+    MEMCMP_EQUAL(addrs[2], ptx_emu.tx_addr, 5);
+    MEMCMP_EQUAL(addrs[2], ptx_emu.rx_addr_p0, 5);
+}
+
+TEST(NRF24_EMU, nodeSelectRoutesThePacketsToTheSelectedNode)
+{
+    const uint8_t addr[5] = {0x11, 0x22, 0x33, 0x44, 0x55};
+    const uint8_t payload[4] = {0x0A, 0x0B, 0x0C, 0x0D};
+    nrf_node nodes[2];
+    nrf_node_table table;
+    nrf_packet packets[2];
+    size_t node;
+
+    nrf_emu_select(&prx_emu);
+    NRF24_set_rx_pipe_address(&prx, NRF_ADDR_PIPE1, addr, sizeof addr);
+    NRF24_set_payload_size(&prx, NRF_PLD_SIZE_PIPE1, 4);
+
+    /* Without RX_ADDR_P0 the packet is received but the ACKs are missed */
+    nrf_emu_select(&ptx_emu);
+    NRF24_node_table_init(&table, nodes, NRF_ARRAY_SIZE(nodes), NRF_PIPE_ADDR_WIDTH_5BYTES, 0);
+    NRF24_node_add(&table, addr, &node);
+    NRF24_node_select(&ptx, &table, node);
+    CHECK_EQUAL(NRF_MAX_RT_IRQ, NRF24_transmit_stream(&ptx, payload, sizeof payload, 1, NULL));
+    NRF24_flush_tx(&ptx);
+
+    NRF24_node_table_init(&table, nodes, NRF_ARRAY_SIZE(nodes), NRF_PIPE_ADDR_WIDTH_5BYTES, 1);
+    NRF24_node_add(&table, addr, &node);
+    NRF24_node_select(&ptx, &table, node);
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_transmit_stream(&ptx, payload, sizeof payload, 1, NULL));
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(2, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+    for (size_t idx = 0; idx < 2; idx++) {
+        CHECK_EQUAL(NRF_PIPE1, packets[idx].pipe);
+        MEMCMP_EQUAL(payload, packets[idx].payload, sizeof payload);
+    }
+}
+
+TEST(NRF24_EMU, linkTunerRaisesTheCountAndThenLowersTheDataRateOnLosses)
+{
+    const uint8_t payload[4] = {0};
+    nrf_link_tuner tuner;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_link_tuner_init(&tuner, NRF_RF_SETUP_RF_DR_2000, 0, 1);
+    NRF24_link_tuner_apply(&ptx, &tuner);
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_250_US | NRF_AUTO_RETRANSMIT_CNT_3,
+        ptx_emu.regs[NRF_REG_SETUP_RETR]);
+
+    nrf_emu_drop_next(&ptx_emu, 1000);
+
+    for (size_t idx = 0; idx < NRF_LINK_WINDOW; idx++) {
+        const nrf_irq result = NRF24_transmit_stream(&ptx, payload, sizeof payload, 1, NULL);
+
+        CHECK_EQUAL(NRF_MAX_RT_IRQ, result);
+        CHECK_EQUAL(NRF_LINK_WINDOW - 1 == idx, NRF24_link_tuner_update(&ptx, &tuner, result));
+    }
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_CNT_15,
+        ptx_emu.regs[NRF_REG_SETUP_RETR] & NRF_SETUP_RETR_ARC_MASK);
+    CHECK_EQUAL(NRF_RF_SETUP_RF_DR_2000, ptx_emu.regs[NRF_REG_RF_SETUP] & NRF_RF_SETUP_RF_DR_MASK);
+
+    /* The MAX_RT results don't need any SPI */
+    nrf_emu_reset_counters(&ptx_emu);
+    for (size_t idx = 0; idx < NRF_LINK_WINDOW - 1; idx++) {
+        NRF24_link_tuner_update(&ptx, &tuner, NRF_MAX_RT_IRQ);
+    }
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+
+    CHECK_EQUAL(1, NRF24_link_tuner_update(&ptx, &tuner, NRF_MAX_RT_IRQ));
+    CHECK_EQUAL(NRF_RF_SETUP_RF_DR_1000, ptx_emu.regs[NRF_REG_RF_SETUP] & NRF_RF_SETUP_RF_DR_MASK);
+    /* The PA level is kept */
+    CHECK_EQUAL(NRF_RF_SETUP_RF_PWR_0, ptx_emu.regs[NRF_REG_RF_SETUP] & NRF_RF_SETUP_RF_PWR_MASK);
+}
+
+TEST(NRF24_EMU, linkTunerKeepsTheDelayLongEnoughForTheAckPayloads)
+{
+    nrf_link_tuner tuner;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_link_tuner_init(&tuner, NRF_RF_SETUP_RF_DR_250, NRF_PAYLOAD_SIZE_MAX, 1);
+    NRF24_link_tuner_apply(&ptx, &tuner);
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_1500_US, NRF24_get_auto_retransmit_delay(&ptx));
+
+    /* Clean windows lower the delay and raise the data rate */
+    for (size_t idx = 0; idx < NRF_LINK_WINDOW * NRF_LINK_CLEAN_WINDOWS * 2; idx++) {
+        NRF24_link_tuner_update(&ptx, &tuner, NRF_TX_DS_IRQ);
+    }
+
+    CHECK_EQUAL(NRF_RF_SETUP_RF_DR_2000, NRF24_get_data_rate(&ptx));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_500_US, NRF24_get_auto_retransmit_delay(&ptx));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_CNT_3, NRF24_get_auto_retransmit_count(&ptx));
+}
+
+TEST(NRF24_EMU, scanCountsTheCarriersAndFindsTheQuietestChannels)
+{
+    const uint8_t busy[] = {0, 1, 10, 70, NRF_MAX_RF_CHANNEL};
+    nrf_scan scan;
+    uint8_t channels[3];
+
+    nrf_emu_select(&prx_emu);
+    for (size_t idx = 0; idx < sizeof busy; idx++) {
+        nrf_emu_set_carrier(&prx_emu, busy[idx], 1);
+    }
+
+    NRF24_scan_init(&scan);
+    NRF24_scan_sweep(&prx, &scan);
+    nrf_emu_set_carrier(&prx_emu, 70, 0);
+    nrf_emu_set_carrier(&prx_emu, 3, 1);
+    nrf_emu_reset_counters(&prx_emu);
+    NRF24_scan_sweep(&prx, &scan);
+
+    CHECK_EQUAL(2, scan.sweeps);
+    CHECK_EQUAL(2, scan.hits[0]);
+    CHECK_EQUAL(2, scan.hits[NRF_MAX_RF_CHANNEL]);
+    CHECK_EQUAL(1, scan.hits[70]);
+    CHECK_EQUAL(1, scan.hits[3]);
+    CHECK_EQUAL(0, scan.hits[2]);
+
+    CHECK_EQUAL(3, NRF24_scan_quietest(&scan, channels, NRF_ARRAY_SIZE(channels)));
+    CHECK_EQUAL(2, channels[0]);
+    CHECK_EQUAL(4, channels[1]);
+    CHECK_EQUAL(5, channels[2]);
+
+    /* RF_CH read (unless cached) and written, then one batch per channel
+     * and no FIFO flush */
+    CHECK_TRUE(2 + 2 * NRF_SCAN_CHANNELS >= prx_emu.counters.spi_transactions);
+    CHECK_EQUAL(NRF_SCAN_DWELL_US * NRF_SCAN_CHANNELS, prx_emu.counters.delay_us);
+    CHECK_EQUAL(2, prx_emu.regs[NRF_REG_RF_CH]);
+}
+
+TEST(NRF24_EMU, scanHalvesTheCountsBeforeTheyOverflow)
+{
+    nrf_scan scan;
+
+    nrf_emu_select(&prx_emu);
+    nrf_emu_set_carrier(&prx_emu, 40, 1);
+
+    NRF24_scan_init(&scan);
+    scan.sweeps = 255;
+    scan.hits[40] = 255;
+    scan.hits[41] = 9;
+    NRF24_scan_sweep(&prx, &scan);
+
+    CHECK_EQUAL(128, scan.sweeps);
+    CHECK_EQUAL(128, scan.hits[40]);
+    CHECK_EQUAL(4, scan.hits[41]);
+}
+
+TEST(NRF24_EMU, hopSequenceIsARepeatablePermutation)
+{
+    const uint8_t channels[] = {3, 17, 29, 40, 52, 64, 77, 81};
+    uint8_t first[NRF_ARRAY_SIZE(channels)];
+    uint8_t second[NRF_ARRAY_SIZE(channels)];
+    uint8_t other[NRF_ARRAY_SIZE(channels)];
+    unsigned sum = 0;
+
+    NRF24_hop_sequence(first, channels, NRF_ARRAY_SIZE(channels), 0xC0FFEE);
+    NRF24_hop_sequence(second, channels, NRF_ARRAY_SIZE(channels), 0xC0FFEE);
+    NRF24_hop_sequence(other, channels, NRF_ARRAY_SIZE(channels), 0xBEEF);
+
+    MEMCMP_EQUAL(first, second, sizeof first);
+    CHECK_TRUE(0 != memcmp(first, other, sizeof first));
+    CHECK_TRUE(0 != memcmp(first, channels, sizeof first));
+
+    for (size_t idx = 0; idx < sizeof first; idx++) {
+        sum += first[idx];
+    }
+
+    CHECK_EQUAL(3 + 17 + 29 + 40 + 52 + 64 + 77 + 81, sum);
+}
+
+TEST(NRF24_EMU, changeChannelOnlyFlushesTheFifosNotEmpty)
+{
+    const uint8_t payload[4] = {0};
+
+    nrf_emu_select(&prx_emu);
+    nrf_emu_reset_counters(&prx_emu);
+    NRF24_change_channel(&prx, 40);
+    CHECK_EQUAL(2, prx_emu.counters.spi_transactions);
+    CHECK_EQUAL(40, prx_emu.regs[NRF_REG_RF_CH]);
+
+    nrf_emu_inject_rx(&prx_emu, 0, payload, sizeof payload);
+    nrf_emu_reset_counters(&prx_emu);
+    NRF24_change_channel(&prx, 41);
+    CHECK_EQUAL(3, prx_emu.counters.spi_transactions);
+    CHECK_EQUAL(0, prx_emu.rx.count);
+    CHECK_EQUAL(41, prx_emu.regs[NRF_REG_RF_CH]);
+}
+
+TEST(NRF24_EMU, hopServiceFollowsTheSlotOfTheTimestamp)
+{
+    const uint8_t sequence[] = {5, 30, 55, 80};
+    nrf_hop hop;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    NRF24_hop_init(&hop, sequence, NRF_ARRAY_SIZE(sequence), 10000, 0);
+
+    CHECK_EQUAL(1, NRF24_hop_service(&ptx, &hop));
+    CHECK_EQUAL(5, ptx_emu.regs[NRF_REG_RF_CH]);
+
+    /* Same slot, nothing sent */
+    nrf_emu_reset_counters(&ptx_emu);
+    nrf_emu_advance(&ptx_emu, 5000);
+    CHECK_EQUAL(0, NRF24_hop_service(&ptx, &hop));
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+
+    /* Serviced late, the missed slot is skipped */
+    nrf_emu_advance(&ptx_emu, 20000);
+    CHECK_EQUAL(1, NRF24_hop_service(&ptx, &hop));
+    CHECK_EQUAL(55, ptx_emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(2, ptx_emu.counters.spi_transactions);
+
+    /* Wraps around the sequence */
+    nrf_emu_advance(&ptx_emu, 20000);
+    CHECK_EQUAL(1, NRF24_hop_service(&ptx, &hop));
+    CHECK_EQUAL(5, ptx_emu.regs[NRF_REG_RF_CH]);
+}
+
+TEST(NRF24_EMU, hoppingLinkDeliversOnTheNewChannel)
+{
+    const uint8_t sequence[] = {5, 30, 55, 80};
+    const uint8_t payload[4] = {0x01, 0x02, 0x03, 0x04};
+    nrf_packet packets[1];
+    nrf_hop ptx_hop;
+    nrf_hop prx_hop;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    NRF24_hop_init(&ptx_hop, sequence, NRF_ARRAY_SIZE(sequence), 10000, 0);
+    CHECK_EQUAL(1, NRF24_hop_service(&ptx, &ptx_hop));
+
+    nrf_emu_select(&prx_emu);
+    NRF24_set_time_us_cb(&prx, nrf_emu_time_us);
+    NRF24_hop_init(&prx_hop, sequence, NRF_ARRAY_SIZE(sequence), 10000, 0);
+    CHECK_EQUAL(1, NRF24_hop_service(&prx, &prx_hop));
+
+    /* The listening receiver pulses CE to tune to the next channel */
+    nrf_emu_advance(&prx_emu, 10000);
+    nrf_emu_reset_counters(&prx_emu);
+    CHECK_EQUAL(1, NRF24_hop_service(&prx, &prx_hop));
+    CHECK_EQUAL(30, prx_emu.rx_channel);
+    CHECK_EQUAL(1, prx_emu.ce);
+    CHECK_EQUAL(2, prx_emu.counters.ce_toggles);
+    CHECK_EQUAL(NRF_PLL_SETTLE_DELAY_US, prx_emu.counters.delay_us);
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_advance(&ptx_emu, 10000);
+    CHECK_EQUAL(1, NRF24_hop_service(&ptx, &ptx_hop));
+    CHECK_EQUAL(30, ptx_emu.regs[NRF_REG_RF_CH]);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_transmit(&ptx, payload, sizeof payload);
+    CHECK_EQUAL(1, ptx_emu.counters.packets_acked);
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(1, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+    MEMCMP_EQUAL(payload, packets[0].payload, sizeof payload);
+}
+
+TEST(NRF24_EMU, hopStopsWithoutSyncUntilResync)
+{
+    const uint8_t sequence[] = {5, 30, 55, 80};
+    nrf_hop hop;
+
+    nrf_emu_select(&prx_emu);
+    NRF24_set_time_us_cb(&prx, nrf_emu_time_us);
+    NRF24_hop_init(&hop, sequence, NRF_ARRAY_SIZE(sequence), 10000, 30000);
+
+    CHECK_EQUAL(1, NRF24_hop_service(&prx, &hop));
+    nrf_emu_advance(&prx_emu, 15000);
+    CHECK_EQUAL(1, NRF24_hop_service(&prx, &hop));
+    CHECK_EQUAL(30, prx_emu.regs[NRF_REG_RF_CH]);
+
+    /* Sync lost, waits on its channel */
+    nrf_emu_advance(&prx_emu, 20000);
+    CHECK_EQUAL(0, NRF24_hop_service(&prx, &hop));
+    CHECK_EQUAL(30, prx_emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(1, hop.searching);
+
+    /* A packet of slot 2 received */
+    NRF24_hop_resync(&hop, 2, nrf_emu_time_us());
+    CHECK_EQUAL(1, NRF24_hop_service(&prx, &hop));
+    CHECK_EQUAL(55, prx_emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(0, hop.searching);
+}
+
+TEST(NRF24_EMU, powerStateWaitsOnlyForTheTimeLeft)
+{
+    uint8_t config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+
+    NRF24_set_power_state(&ptx, NRF_STATE_POWER_DOWN);
+    CHECK_EQUAL(NRF_STATE_POWER_DOWN, NRF24_get_power_state(&ptx));
+    CHECK_EQUAL(0, ptx_emu.regs[NRF_REG_CONFIG] & NRF_CONFIG_PWR_UP);
+
+    /* Powered up 1ms ago */
+    NRF24_write_reg(&ptx, NRF_REG_CONFIG, &config, 1);
+    nrf_emu_advance(&ptx_emu, 1000);
+    nrf_emu_reset_counters(&ptx_emu);
+
+    NRF24_set_power_state(&ptx, NRF_STATE_STANDBY_I);
+    CHECK_EQUAL(NRF_STATE_STANDBY_I, NRF24_get_power_state(&ptx));
+    CHECK_EQUAL(NRF_POWER_UP_DELAY_US - 1000, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+
+    /* Already there */
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_set_power_state(&ptx, NRF_STATE_STANDBY_I);
+    CHECK_EQUAL(0, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(0, ptx_emu.counters.ce_toggles);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_set_power_state(&ptx, NRF_STATE_TX);
+    CHECK_EQUAL(NRF_STATE_STANDBY_II, NRF24_get_power_state(&ptx));
+    CHECK_EQUAL(1, ptx_emu.ce);
+    CHECK_EQUAL(NRF_PLL_SETTLE_DELAY_US, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+
+    /* Through standby-I, CE was high for longer than Thce */
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_set_power_state(&ptx, NRF_STATE_RX);
+    CHECK_EQUAL(NRF_STATE_RX, NRF24_get_power_state(&ptx));
+    CHECK_EQUAL(NRF_CONFIG_RECEIVER, ptx_emu.regs[NRF_REG_CONFIG] & NRF_CONFIG_RECEIVER);
+    CHECK_EQUAL(2, ptx_emu.counters.ce_toggles);
+    CHECK_EQUAL(NRF_PLL_SETTLE_DELAY_US, ptx_emu.counters.delay_us);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    CHECK_EQUAL(NRF_MODE_RX, NRF24_get_mode(&ptx));
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+}
+
+TEST(NRF24_EMU, withoutTimestampsTheWholeTimingsAreWaited)
+{
+    nrf_emu_select(&ptx_emu);
+    CHECK_EQUAL(NRF_STATE_UNKNOWN, NRF24_get_power_state(&ptx));
+
+    /* Powered up by the CONFIG written in setup */
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_start_listening(&ptx);
+    CHECK_EQUAL(NRF_POWER_UP_DELAY_US + NRF_PLL_SETTLE_DELAY_US, ptx_emu.counters.delay_us);
+
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_set_power_state(&ptx, NRF_STATE_TX);
+    NRF24_wakeup(&ptx);
+    CHECK_EQUAL(0, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(0, ptx_emu.counters.spi_transactions);
+}
+
+TEST(NRF24_EMU, splitPhaseTransmitNeverWaits)
+{
+    const uint8_t payload[4] = {0x01, 0x02, 0x03, 0x04};
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    NRF24_set_power_state(&ptx, NRF_STATE_POWER_DOWN);
+    nrf_emu_reset_counters(&ptx_emu);
+
+    uint32_t deadline = NRF24_wakeup_begin(&ptx);
+    CHECK_EQUAL(nrf_emu_time_us() + NRF_POWER_UP_DELAY_US, deadline);
+    CHECK_EQUAL(1, NRF24_service(&ptx, nrf_emu_time_us()));
+
+    /* The pulse starts once in standby-I */
+    CHECK_EQUAL(deadline, NRF24_transmit_begin(&ptx, payload, sizeof payload));
+    CHECK_EQUAL(0, ptx_emu.ce);
+
+    nrf_emu_advance(&ptx_emu, NRF_POWER_UP_DELAY_US);
+    const uint32_t now = nrf_emu_time_us();
+    CHECK_EQUAL(1, NRF24_service(&ptx, now));
+    CHECK_EQUAL(1, ptx_emu.ce);
+    deadline = NRF24_service_deadline(&ptx);
+    CHECK_EQUAL(now + NRF_CE_PULSE_WIDTH_US, deadline);
+
+    CHECK_EQUAL(1, NRF24_service(&ptx, deadline - 1));
+    CHECK_EQUAL(1, ptx_emu.ce);
+
+    nrf_emu_advance(&ptx_emu, NRF_CE_PULSE_WIDTH_US);
+    CHECK_EQUAL(0, NRF24_service(&ptx, nrf_emu_time_us()));
+    CHECK_EQUAL(0, ptx_emu.ce);
+    CHECK_EQUAL(NRF_STATE_STANDBY_I, NRF24_get_power_state(&ptx));
+    CHECK_EQUAL(1, ptx_emu.counters.packets_sent);
+    CHECK_EQUAL(0, ptx_emu.counters.delay_us);
+}
+
+TEST(NRF24_EMU, splitPhaseListeningEndsWithThePllSettled)
+{
+    nrf_emu_select(&prx_emu);
+    NRF24_set_time_us_cb(&prx, nrf_emu_time_us);
+    NRF24_stop_listening(&prx);
+    nrf_emu_reset_counters(&prx_emu);
+
+    const uint32_t deadline = NRF24_start_listening_begin(&prx);
+    CHECK_EQUAL(nrf_emu_time_us() + NRF_PLL_SETTLE_DELAY_US, deadline);
+    CHECK_EQUAL(1, prx_emu.ce);
+    CHECK_EQUAL(1, NRF24_service(&prx, deadline - 1));
+    CHECK_EQUAL(0, NRF24_service(&prx, deadline));
+    CHECK_EQUAL(NRF_STATE_RX, NRF24_get_power_state(&prx));
+    CHECK_EQUAL(0, prx_emu.counters.delay_us);
+
+    /* Nothing left */
+    CHECK_EQUAL(nrf_emu_time_us(), NRF24_service_deadline(&prx));
+}
+
+#if defined(NRF24_ENABLE_STATS)
+TEST(NRF24_EMU, statsMatchTheTrafficSeenByTheRadio)
+{
+    const uint8_t payloads[3][4] = {{0}};
+    nrf_packet packets[4];
+    nrf_stats stats;
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_stats_reset(&ptx);
+    NRF24_transmit_stream(&ptx, &payloads[0][0], sizeof payloads[0], 3, NULL);
+
+    NRF24_stats_snapshot(&ptx, &stats, 1);
+    CHECK_EQUAL(ptx_emu.counters.spi_transactions, stats.spi_transactions);
+    CHECK_EQUAL(ptx_emu.counters.spi_bytes, stats.spi_bytes);
+    CHECK_EQUAL(ptx_emu.counters.ce_toggles, stats.ce_edges);
+    CHECK_EQUAL(3, stats.packets_sent);
+    CHECK_TRUE(0 < stats.tx_ds);
+    CHECK_EQUAL(0, stats.max_rt);
+
+    /* Reset by the snapshot */
+    NRF24_stats_snapshot(&ptx, &stats, 0);
+    CHECK_EQUAL(0, stats.spi_transactions);
+
+    nrf_emu_select(&prx_emu);
+    NRF24_stats_reset(&prx);
+    NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets));
+
+    NRF24_stats_snapshot(&prx, &stats, 0);
+    CHECK_EQUAL(3, stats.packets_received);
+    CHECK_EQUAL(1, stats.rx_dr);
+}
+#endif
+
+#if defined(NRF24_ENABLE_TRACE)
+TEST(NRF24_EMU, traceRecordsTheTransmitSequence)
+{
+    const uint8_t payload[4] = {0xCA, 0xFE, 0xBE, 0xEF};
+    uint8_t buffer[256];
+    uint8_t dump[256];
+    nrf_trace trace;
+    nrf_trace_record record;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    NRF24_trace_init(&trace, buffer, sizeof buffer);
+    NRF24_trace_attach(&ptx, &trace);
+
+    NRF24_transmit(&ptx, payload, sizeof payload);
+    NRF24_trace_attach(&ptx, NULL);
+    NRF24_get_status(&ptx);
+
+    const size_t size = NRF24_trace_read(&trace, dump, sizeof dump);
+    size_t pos = NRF24_trace_decode(dump, size, &record);
+
+    CHECK_EQUAL(NRF_TRACE_SPI, record.type);
+    CHECK_EQUAL(sizeof payload + 1, record.value);
+    CHECK_EQUAL(NRF_CMD_W_TX_PAYLOAD, record.mosi[0]);
+    MEMCMP_EQUAL(payload, &record.mosi[1], sizeof payload);
+
+    const uint32_t written = record.timestamp;
+
+    pos += NRF24_trace_decode(&dump[pos], size - pos, &record);
+    CHECK_EQUAL(NRF_TRACE_CE, record.type);
+    CHECK_EQUAL(GPIO_SET, record.value);
+
+    pos += NRF24_trace_decode(&dump[pos], size - pos, &record);
+    CHECK_EQUAL(NRF_TRACE_DELAY_US, record.type);
+    CHECK_EQUAL(NRF_CE_PULSE_WIDTH_US, record.value);
+
+    pos += NRF24_trace_decode(&dump[pos], size - pos, &record);
+    CHECK_EQUAL(NRF_TRACE_CE, record.type);
+    CHECK_EQUAL(GPIO_CLEAR, record.value);
+    CHECK_TRUE((record.timestamp - written) >= NRF_CE_PULSE_WIDTH_US);
+
+    /* Nothing recorded once detached */
+    CHECK_EQUAL(size, pos);
+}
+
+TEST(NRF24_EMU, aFullTraceDropsRecordsAndReportsThem)
+{
+    /* A NOP record is 8 bytes, room for 16 of them */
+    uint8_t buffer[128];
+    uint8_t dump[256];
+    nrf_trace trace;
+    nrf_trace_record record;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_trace_init(&trace, buffer, sizeof buffer);
+    NRF24_trace_attach(&ptx, &trace);
+
+    for (size_t idx = 0; idx < 20; idx++) {
+        NRF24_get_status(&ptx);
+    }
+
+    CHECK_EQUAL(16 * 8, NRF24_trace_read(&trace, dump, sizeof dump));
+    CHECK_EQUAL(0, NRF24_trace_read(&trace, dump, sizeof dump));
+
+    NRF24_get_status(&ptx);
+
+    const size_t size = NRF24_trace_read(&trace, dump, sizeof dump);
+    const size_t pos = NRF24_trace_decode(dump, size, &record);
+
+    CHECK_EQUAL(NRF_TRACE_LOST, record.type);
+    CHECK_EQUAL(4, record.value);
+    CHECK_EQUAL(8, NRF24_trace_decode(&dump[pos], size - pos, &record));
+    CHECK_EQUAL(NRF_TRACE_SPI, record.type);
+    CHECK_EQUAL(NRF_CMD_NOP, record.mosi[0]);
+    CHECK_EQUAL(nrf_emu_status(&ptx_emu), record.miso[0]);
+}
+#endif
+
+#if defined(NRF24_ENABLE_STATUS_CACHE)
+TEST(NRF24_EMU, statusQueriesAreAnsweredFromTheLastTransaction)
+{
+    nrf_emu_select(&prx_emu);
+    NRF24_set_time_us_cb(&prx, nrf_emu_time_us);
+    NRF24_set_status_max_age(&prx, 500);
+
+    NRF24_get_fifo_status(&prx);
+    nrf_emu_reset_counters(&prx_emu);
+
+    CHECK_EQUAL(nrf_emu_status(&prx_emu), NRF24_get_status(&prx));
+    CHECK_EQUAL(0, NRF24_is_data_ready(&prx));
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_get_irq_flag(&prx));
+    CHECK_EQUAL(NRF_STATUS_PIPES_MASK >> NRF_STATUS_PIPES_SHIFT,
+        NRF24_get_data_pipe_with_payload(&prx));
+    CHECK_EQUAL(0, NRF24_is_tx_fifo_full(&prx));
+    CHECK_EQUAL(0, prx_emu.counters.spi_transactions);
+
+    /* A packet received after the last transaction is seen once it's stale */
+    nrf_emu_inject_rx(&prx_emu, NRF_PIPE1, (const uint8_t *) "ping", 4);
+    CHECK_EQUAL(0, NRF24_is_data_ready(&prx));
+
+    nrf_emu_advance(&prx_emu, 500);
+    CHECK_TRUE(NRF24_is_data_ready(&prx));
+    CHECK_EQUAL(NRF_PIPE1, NRF24_get_data_pipe_with_payload(&prx));
+    CHECK_EQUAL(1, prx_emu.counters.spi_transactions);
+
+    /* Clearing the flag keeps STATUS up to date */
+    NRF24_clear_irq_flag(&prx, NRF_RX_DR_IRQ);
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_get_irq_flag(&prx));
+    CHECK_EQUAL(2, prx_emu.counters.spi_transactions);
+}
+
+TEST(NRF24_EMU, payloadsAndCeDropTheKeptStatus)
+{
+    const uint8_t payload[4] = {0xCA, 0xFE, 0xBE, 0xEF};
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_set_time_us_cb(&ptx, nrf_emu_time_us);
+    NRF24_set_status_max_age(&ptx, 100000);
+
+    /* Filling the TX FIFO changes TX_FULL after STATUS is clocked out */
+    for (size_t idx = 0; idx < NRF_EMU_FIFO_DEPTH; idx++) {
+        NRF24_put_in_tx_fifo(&ptx, payload, sizeof payload);
+    }
+
+    CHECK_TRUE(NRF24_is_tx_fifo_full(&ptx));
+
+    NRF24_flush_tx(&ptx);
+    CHECK_FALSE(NRF24_is_tx_fifo_full(&ptx));
+
+    /* The CE pulse starts the transmission, TX_DS is read from the radio */
+    NRF24_transmit(&ptx, payload, sizeof payload);
+    nrf_emu_advance(&ptx_emu, 1000);
+    nrf_emu_reset_counters(&ptx_emu);
+
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_get_irq_flag(&ptx));
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_get_irq_flag(&ptx));
+    CHECK_EQUAL(1, ptx_emu.counters.spi_transactions);
+}
+#endif
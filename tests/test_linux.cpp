@@ -0,0 +1,223 @@
+#include "CppUTest/TestHarness.h"
+
+#if defined(__linux__)
+
+extern "C"
+{
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+
+#include "NRF24.h"
+#include "NRF24_BATCH.h"
+#include "NRF24_INTERFACE.h"
+#include "NRF24_LINUX.h"
+
+#include "nrf24_emu.h"
+}
+
+/* Stand-in for the chip: the spidev and CE ioctls run on an emulator and
+ * the IRQ edges are written to a pipe as GPIO line events */
+struct StandIn {
+    nrf_emu emu;
+    int spi_fd;
+    int ce_fd;
+    int irq_pipe[2];
+    nrf_gpio irq;
+    unsigned long ioctls;
+};
+
+static StandIn *standin;
+
+static void standInUpdateIrq(void)
+{
+    nrf_emu_select(&standin->emu);
+
+    const nrf_gpio irq = nrf_emu_read_irq();
+
+    if (irq != standin->irq) {
+        struct gpio_v2_line_event event;
+
+        memset(&event, 0, sizeof event);
+        event.id = (GPIO_CLEAR == irq) ? GPIO_V2_LINE_EVENT_FALLING_EDGE :
+            GPIO_V2_LINE_EVENT_RISING_EDGE;
+        CHECK_EQUAL((ssize_t) sizeof event, write(standin->irq_pipe[1], &event, sizeof event));
+        standin->irq = irq;
+    }
+}
+
+static void standInSpiMessage(const struct spi_ioc_transfer *xfers, const size_t count)
+{
+    uint8_t in[NRF_PAYLOAD_SIZE_MAX + 1];
+    uint8_t out[NRF_PAYLOAD_SIZE_MAX + 1];
+    size_t first = 0;
+    size_t len = 0;
+
+    /* The transfers up to a chip select change are one radio transaction */
+    for (size_t idx = 0; idx < count; idx++) {
+        const uint8_t *tx = reinterpret_cast<const uint8_t *>(xfers[idx].tx_buf);
+
+        for (size_t byte = 0; byte < xfers[idx].len; byte++) {
+            in[len++] = (NULL != tx) ? tx[byte] : 0;
+        }
+
+        if (!xfers[idx].cs_change && ((idx + 1) < count)) {
+            continue;
+        }
+
+        nrf_emu_xfer(&standin->emu, in, out, len);
+
+        for (size_t pos = 0; first <= idx; first++) {
+            uint8_t *rx = reinterpret_cast<uint8_t *>(xfers[first].rx_buf);
+
+            if (NULL != rx) {
+                memcpy(rx, &out[pos], xfers[first].len);
+            }
+
+            pos += xfers[first].len;
+        }
+
+        len = 0;
+    }
+}
+
+static int standInIoctl(int fd, unsigned long request, void *arg)
+{
+    standin->ioctls++;
+    nrf_emu_select(&standin->emu);
+
+    if ((fd == standin->spi_fd) && (SPI_IOC_MAGIC == _IOC_TYPE(request)) &&
+        (0 == _IOC_NR(request))) {
+        standInSpiMessage(static_cast<const struct spi_ioc_transfer *>(arg),
+            _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer));
+    } else if ((fd == standin->ce_fd) && (GPIO_V2_LINE_SET_VALUES_IOCTL == request)) {
+        const struct gpio_v2_line_values *values =
+            static_cast<const struct gpio_v2_line_values *>(arg);
+
+        nrf_emu_write_ce((values->bits & 1U) ? GPIO_SET : GPIO_CLEAR);
+    } else {
+        FAIL("Unexpected ioctl");
+    }
+
+    standInUpdateIrq();
+    return 0;
+}
+
+TEST_GROUP(NRF24_LINUX)
+{
+    StandIn chip;
+    nrf_linux lx;
+    nrf_radio radio;
+
+    void setup(void)
+    {
+        nrf_emu_init(&chip.emu);
+        chip.spi_fd = open("/dev/null", O_RDWR);
+        chip.ce_fd = open("/dev/null", O_RDWR);
+        CHECK_EQUAL(0, pipe(chip.irq_pipe));
+        fcntl(chip.irq_pipe[0], F_SETFL, O_NONBLOCK);
+        chip.irq = GPIO_SET;
+        standin = &chip;
+
+        NRF24_linux_init(&lx, chip.spi_fd, chip.ce_fd, chip.irq_pipe[0], 8000000);
+        NRF24_linux_set_ioctl_cb(&lx, standInIoctl);
+        CHECK_EQUAL(0, NRF24_linux_attach(&lx, &radio));
+
+        uint8_t config = NRF_CONFIG_ENABLE_CRC | NRF_CONFIG_PWR_UP;
+        NRF24_write_reg(&radio, NRF_REG_CONFIG, &config, 1);
+        nrf_emu_reset_counters(&chip.emu);
+        chip.ioctls = 0;
+    }
+
+    void teardown(void)
+    {
+        /* Closes the SPI, CE and IRQ descriptors */
+        NRF24_linux_close(&lx);
+        close(chip.irq_pipe[1]);
+    }
+};
+
+TEST(NRF24_LINUX, aBatchIsOneIoctl)
+{
+    NRF24_change_channel(&radio, 40);
+
+    CHECK_EQUAL(1, chip.ioctls);
+    CHECK_EQUAL(40, chip.emu.regs[NRF_REG_RF_CH]);
+    CHECK_EQUAL(2, chip.emu.counters.spi_transactions);
+    CHECK_EQUAL(0, lx.error);
+
+    uint8_t in[NRF_LINUX_MAX_XFERS + 1];
+    uint8_t out[NRF_LINUX_MAX_XFERS + 1];
+    nrf_spi_segment segments[NRF_LINUX_MAX_XFERS + 1];
+    nrf_batch batch;
+
+    /* Longer batches are split */
+    NRF24_batch_init(&batch, in, out, sizeof in, segments, NRF_ARRAY_SIZE(segments));
+    for (size_t idx = 0; idx < NRF_ARRAY_SIZE(segments); idx++) {
+        NRF24_batch_cmd(&batch, NRF_CMD_NOP);
+    }
+
+    chip.ioctls = 0;
+    NRF24_batch_submit(&radio, &batch);
+    CHECK_EQUAL(2, chip.ioctls);
+    CHECK_EQUAL(nrf_emu_status(&chip.emu), NRF24_batch_status(&batch, NRF_LINUX_MAX_XFERS));
+}
+
+TEST(NRF24_LINUX, theIrqDescriptorIsReadableOnceThePacketIsSent)
+{
+    const uint8_t payload[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+    struct pollfd pfd = {NRF24_linux_irq_fd(&lx), POLLIN, 0};
+
+    /* The payload with the command is one ioctl, then the CE pulse */
+    NRF24_transmit(&radio, payload, sizeof payload);
+    CHECK_EQUAL(3, chip.ioctls);
+
+    nrf_emu_advance(&chip.emu, 1000);
+    standInUpdateIrq();
+    CHECK_EQUAL(1, chip.emu.counters.packets_acked);
+
+    CHECK_EQUAL(1, poll(&pfd, 1, 0));
+    CHECK_EQUAL(1, NRF24_linux_handle_irq(&lx));
+    CHECK_EQUAL(NRF_TX_DS_IRQ, NRF24_poll_interrupt(&radio));
+
+    /* Cleared, the rising edge is on the pipe */
+    CHECK_EQUAL(0, NRF24_linux_handle_irq(&lx));
+    CHECK_EQUAL(NRF_NONE_IRQ, NRF24_poll_interrupt(&radio));
+    CHECK_EQUAL(0, poll(&pfd, 1, 0));
+}
+
+TEST(NRF24_LINUX, ceWritesKeepingTheLevelDontReachTheKernel)
+{
+    NRF24_stop_listening(&radio);
+    CHECK_EQUAL(0, chip.ioctls);
+
+    NRF24_start_listening(&radio);
+    NRF24_start_listening(&radio);
+    CHECK_EQUAL(GPIO_SET, chip.emu.ce);
+    CHECK_EQUAL(GPIO_SET, lx.ce_level);
+}
+
+TEST(NRF24_LINUX, slotsRunOut)
+{
+    nrf_linux others[NRF_LINUX_MAX_RADIOS];
+    nrf_radio radios[NRF_LINUX_MAX_RADIOS];
+
+    for (size_t idx = 0; idx < NRF_LINUX_MAX_RADIOS; idx++) {
+        NRF24_linux_init(&others[idx], open("/dev/null", O_RDWR), -1, -1, 8000000);
+    }
+
+    CHECK_EQUAL(0, NRF24_linux_attach(&others[0], &radios[0]));
+    CHECK_EQUAL(1, NRF24_linux_attach(&others[1], &radios[1]));
+    POINTERS_EQUAL(NULL, radios[0].read_irq_cb);
+
+    NRF24_linux_close(&others[0]);
+    CHECK_EQUAL(0, NRF24_linux_attach(&others[1], &radios[1]));
+
+    NRF24_linux_close(&others[1]);
+}
+
+#endif /* __linux__ */
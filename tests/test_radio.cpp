@@ -0,0 +1,203 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+
+#include "NRF24.h"
+#include "NRF24_INTERFACE.h"
+#include "NRF24_CONFIG.h"
+
+#include "nrf24_emu.h"
+#include "nrf24_emu_pair.h"
+}
+
+#include "NRF24.hpp"
+#include "NRF24_CONFIG.hpp"
+
+/* The emulator callbacks as policies */
+struct EmuSpi {
+    static void xfer(const uint8_t *in, uint8_t *out, size_t size)
+    {
+        nrf_emu_spi_xfer(in, out, size);
+    }
+};
+
+struct EmuCe {
+    static void write(nrf_gpio state)
+    {
+        nrf_emu_write_ce(state);
+    }
+};
+
+struct EmuIrq {
+    static nrf_gpio read(void)
+    {
+        return nrf_emu_read_irq();
+    }
+};
+
+struct EmuDelay {
+    static void ms(uint32_t ms)
+    {
+        nrf_emu_delay_ms(ms);
+    }
+
+    static void us(uint32_t us)
+    {
+        nrf_emu_delay_us(us);
+    }
+};
+
+typedef nrf24::Radio<EmuSpi, EmuCe, EmuIrq, EmuDelay> EmuRadio;
+
+static constexpr uint8_t config_addr[] = {0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+
+static constexpr nrf24::Config config = nrf24::Config()
+    .channel(76)
+    .rx_address(NRF_PIPE0, config_addr)
+    .tx_address(config_addr)
+    .pipe(NRF_PIPE0, 4)
+    .power_up();
+
+static constexpr nrf24::ConfigSequence config_full = nrf24::config_sequence(config);
+static constexpr nrf24::ConfigSequence config_diff = nrf24::config_sequence(config, nrf24::Config());
+
+/* Evaluated by the compiler */
+static_assert(NRF_CONFIG_MAX_SEGMENTS == config_full.writes, "All the registers written");
+static_assert(NRF_CONFIG_SEQUENCE_MAX_SIZE == config_full.size, "Worst case size");
+/* RF_CH, RX_ADDR_P0, TX_ADDR, RX_PW_P0 and CONFIG */
+static_assert(5 == config_diff.writes, "Only the registers changed");
+static_assert(76 == config.image().rf_ch, "Channel");
+static_assert(NRF_SETUP_AW_3BYTES ==
+    nrf24::Config().address_width(NRF_PIPE_ADDR_WIDTH_3BYTES).image().setup_aw, "3 bytes");
+/* Pipe 1 keeps its reset value, enabled with RX_PW 0 */
+static_assert(NRF_CONFIG_RECEIVER &
+    nrf24::Config().receiver().pipe(NRF_PIPE0, 4).image().config, "Receiver on pipe 0");
+
+/* The template and the C API driving linked emulated radios */
+TEST_GROUP(NRF24_RADIO)
+{
+    nrf_emu ptx_emu;
+    nrf_emu prx_emu;
+    nrf_radio ptx;
+    nrf_radio prx;
+    EmuRadio radio;
+
+    void setup(void)
+    {
+        nrf_emu_pair_init(&ptx_emu, &prx_emu, &ptx, &prx);
+    }
+};
+
+TEST(NRF24_RADIO, transmitSendsTheSameTrafficAsTheCApi)
+{
+    const uint8_t payload[4] = {0x10, 0x11, 0x12, 0x13};
+    nrf_emu_counters c_counters;
+    nrf_packet packets[2];
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_transmit(&ptx, payload, sizeof payload);
+    c_counters = ptx_emu.counters;
+
+    NRF24_clear_all_irqs(&ptx);
+    nrf_emu_reset_counters(&ptx_emu);
+    radio.transmit(payload, sizeof payload);
+
+    CHECK_EQUAL(c_counters.spi_transactions, ptx_emu.counters.spi_transactions);
+    CHECK_EQUAL(c_counters.spi_bytes, ptx_emu.counters.spi_bytes);
+    CHECK_EQUAL(c_counters.ce_toggles, ptx_emu.counters.ce_toggles);
+    CHECK_EQUAL(c_counters.delay_us, ptx_emu.counters.delay_us);
+    CHECK_EQUAL(NRF_TX_DS_IRQ, radio.get_irq_flag());
+
+    nrf_emu_select(&prx_emu);
+    CHECK_EQUAL(2, NRF24_receive_all(&prx, packets, NRF_ARRAY_SIZE(packets)));
+    MEMCMP_EQUAL(payload, packets[1].payload, sizeof payload);
+}
+
+TEST(NRF24_RADIO, registerSettersAreSeenByTheCApi)
+{
+    const uint8_t addr[5] = {0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+    uint8_t read_addr[5];
+
+    nrf_emu_select(&ptx_emu);
+    radio.set_channel(200);
+    radio.set_auto_retransmit(NRF_AUTO_RETRANSMIT_DELAY_750_US, NRF_AUTO_RETRANSMIT_CNT_5);
+    radio.set_data_rate(NRF_RF_SETUP_RF_DR_250);
+    radio.set_pa_level(NRF_RF_SETUP_RF_PWR_6);
+    radio.set_tx_address(addr, sizeof addr);
+    NRF24_reg_cache_invalidate(&ptx);
+
+    CHECK_EQUAL(NRF_MAX_RF_CHANNEL, NRF24_get_channel(&ptx));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_DELAY_750_US, NRF24_get_auto_retransmit_delay(&ptx));
+    CHECK_EQUAL(NRF_AUTO_RETRANSMIT_CNT_5, NRF24_get_auto_retransmit_count(&ptx));
+    CHECK_EQUAL(NRF_RF_SETUP_RF_DR_250, NRF24_get_data_rate(&ptx));
+    CHECK_EQUAL(NRF_RF_SETUP_RF_PWR_6, NRF24_get_pa_level(&ptx));
+
+    NRF24_get_tx_address(&ptx, read_addr, sizeof read_addr);
+    MEMCMP_EQUAL(addr, read_addr, sizeof addr);
+
+    radio.set_power_down_mode();
+    NRF24_reg_cache_invalidate(&ptx);
+    CHECK_EQUAL(0, NRF24_read_bit(&ptx, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP));
+    radio.wakeup();
+    NRF24_reg_cache_invalidate(&ptx);
+    CHECK_EQUAL(1, NRF24_read_bit(&ptx, NRF_REG_CONFIG, NRF_CONFIG_BIT_PWR_UP));
+}
+
+TEST(NRF24_RADIO, receivesThePayloadSentByTheCApi)
+{
+    const uint8_t payload[4] = {0x20, 0x21, 0x22, 0x23};
+    uint8_t received[4] = {0};
+    uint8_t width = 0;
+
+    nrf_emu_select(&ptx_emu);
+    NRF24_transmit(&ptx, payload, sizeof payload);
+
+    nrf_emu_select(&prx_emu);
+    CHECK_TRUE(radio.irq_asserted());
+    CHECK_TRUE(radio.is_data_ready());
+    radio.cmd_read_payload_width(&width);
+    CHECK_EQUAL(4, width);
+
+    radio.get_rx_payload(received, width);
+    MEMCMP_EQUAL(payload, received, sizeof payload);
+
+    radio.clear_irq_flag(NRF_RX_DR_IRQ);
+    CHECK_EQUAL(NRF_NONE_IRQ, radio.get_irq_flag());
+    CHECK_FALSE(radio.irq_asserted());
+}
+
+TEST(NRF24_RADIO, replayedSequenceMatchesTheImage)
+{
+    const nrf_config image = config.image();
+    nrf_config read;
+
+    nrf_emu_select(&ptx_emu);
+    nrf_emu_reset_counters(&ptx_emu);
+    NRF24_config_replay(&ptx, config_full.bytes);
+
+    CHECK_EQUAL(NRF_CONFIG_MAX_SEGMENTS, ptx_emu.counters.spi_transactions);
+    CHECK_EQUAL(NRF_CONFIG_MAX_XFER_BYTES, ptx_emu.counters.spi_bytes);
+    CHECK_EQUAL(NRF_POWER_UP_DELAY_US, ptx_emu.counters.delay_us);
+
+    NRF24_config_read(&ptx, &read);
+    MEMCMP_EQUAL(&image, &read, sizeof image);
+}
+
+TEST(NRF24_RADIO, sequenceFromTheResetValuesOnlyWritesTheChanges)
+{
+    const nrf_config image = config.image();
+    nrf_config read;
+    nrf_emu emu;
+
+    nrf_emu_init(&emu);
+    nrf_emu_select(&emu);
+    NRF24_config_replay(&ptx, config_diff.bytes);
+
+    CHECK_EQUAL(config_diff.writes, emu.counters.spi_transactions);
+
+    NRF24_config_read(&ptx, &read);
+    MEMCMP_EQUAL(&image, &read, sizeof image);
+}
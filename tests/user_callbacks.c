@@ -19,12 +19,54 @@ void mock_spi_xfer(const uint8_t *in, uint8_t *out, size_t xfer_size)
             ->withUnsignedIntParameters("xfer_size", (unsigned int) xfer_size);
 }
 
+/* Record the vectored call and then each one of the segments */
+void mock_spi_xfer_vec(const nrf_spi_segment *segments, const size_t count)
+{
+    mock_c()->actualCall(__func__)
+            ->withUnsignedIntParameters("count", (unsigned int) count);
+
+    for (size_t idx = 0; idx < count; idx++) {
+        mock_spi_xfer(segments[idx].in, segments[idx].out, segments[idx].xfer_size);
+    }
+}
+
+void mock_spi_xfer_sg(const uint8_t cmd, uint8_t *status, const uint8_t *in,
+    uint8_t *out, const size_t xfer_size)
+{
+    MockActualCall_c *call = mock_c()->actualCall(__func__)
+            ->withUnsignedIntParameters("cmd", cmd)
+            ->withOutputParameter("status", status)
+            ->withUnsignedIntParameters("xfer_size", (unsigned int) xfer_size);
+
+    if (NULL != in) {
+        call->withMemoryBufferParameter("in", in, xfer_size);
+    }
+
+    if (NULL != out) {
+        call->withOutputParameter("out", out);
+    }
+}
+
+void mock_spi_xfer_async(const uint8_t *in, uint8_t *out, const size_t xfer_size)
+{
+    mock_c()->actualCall(__func__)
+            ->withMemoryBufferParameter("in", in, xfer_size)
+            ->withOutputParameter("out", out)
+            ->withUnsignedIntParameters("xfer_size", (unsigned int) xfer_size);
+}
+
 void mock_delay_cb(uint32_t ms)
 {
     mock_c()->actualCall(__func__)
             ->withUnsignedIntParameters("ms", ms);
 }
 
+void mock_delay_us_cb(uint32_t us)
+{
+    mock_c()->actualCall(__func__)
+            ->withUnsignedIntParameters("us", us);
+}
+
 nrf_gpio mock_irq_read(void)
 {
     mock_c()->actualCall(__func__);
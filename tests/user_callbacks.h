@@ -9,7 +9,12 @@ extern "C" {
 
 void mock_ce_write(nrf_gpio state);
 void mock_spi_xfer(const uint8_t *in, uint8_t *out, size_t xfer_size);
+void mock_spi_xfer_vec(const nrf_spi_segment *segments, const size_t count);
+void mock_spi_xfer_sg(const uint8_t cmd, uint8_t *status, const uint8_t *in,
+    uint8_t *out, const size_t xfer_size);
+void mock_spi_xfer_async(const uint8_t *in, uint8_t *out, const size_t xfer_size);
 void mock_delay_cb(uint32_t ms);
+void mock_delay_us_cb(uint32_t us);
 nrf_gpio mock_irq_read(void);
 
 #ifdef __cplusplus
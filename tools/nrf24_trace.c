@@ -0,0 +1,392 @@
+/**
+* @file     nrf24_trace.c
+* @version  0.1
+*
+* @brief    Decode and replay the bus traces recorded with NRF24_TRACE.h.
+*
+* @code
+* nrf24_trace decode trace.bin
+* nrf24_trace replay trace.bin
+* @endcode
+*
+* decode prints one line per record with the command and register names.
+*
+* replay runs the trace on the emulator (see tests/emulator): the bytes sent
+* are clocked into it, CE is driven and the emulated time follows the delays
+* and the timestamps of the records, so the radio sees the same timing as in
+* the field. The STATUS byte and the data read by the read commands are
+* compared with the recorded ones, and the time, bus and packet throughput
+* are printed. The emulator starts from the power on reset values, a trace
+* started after the radio was configured shows mismatches until the
+* registers involved are written.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "NRF24.h"
+#include "NRF24_DEFS.h"
+#include "NRF24_TRACE.h"
+
+#include "nrf24_emu.h"
+
+enum {
+	/* W_REGISTER commands are 001A AAAA, R_REGISTER commands are 000A AAAA */
+	TRACE_CMD_REGISTER_MASK	= 0xE0,
+	TRACE_CMD_REG_ADDR_MASK	= 0x1F,
+	TRACE_CMD_PIPE_MASK	= 0x07,
+	/* Mismatches printed in full */
+	TRACE_MISMATCH_PRINT	= 10,
+};
+
+typedef struct {
+	unsigned long	records;
+	unsigned long	lost;
+	unsigned long	transactions;
+	unsigned long	bytes;
+	unsigned long	ce_edges;
+	unsigned long	delay_us;
+	unsigned long	tx_payloads;
+	unsigned long	rx_payloads;
+	unsigned long	mismatches;
+	uint32_t	first_timestamp;
+	uint32_t	last_timestamp;
+} trace_summary;
+
+static const char *const register_names[] = {
+	[NRF_REG_CONFIG]	= "CONFIG",
+	[NRF_REG_EN_AA]		= "EN_AA",
+	[NRF_REG_EN_RXADDR]	= "EN_RXADDR",
+	[NRF_REG_SETUP_AW]	= "SETUP_AW",
+	[NRF_REG_SETUP_RETR]	= "SETUP_RETR",
+	[NRF_REG_RF_CH]		= "RF_CH",
+	[NRF_REG_RF_SETUP]	= "RF_SETUP",
+	[NRF_REG_STATUS]	= "STATUS",
+	[NRF_REG_OBSERVE_TX]	= "OBSERVE_TX",
+	[NRF_REG_RPD]		= "RPD",
+	[NRF_REG_RX_ADDR_P0]	= "RX_ADDR_P0",
+	[NRF_REG_RX_ADDR_P1]	= "RX_ADDR_P1",
+	[NRF_REG_RX_ADDR_P2]	= "RX_ADDR_P2",
+	[NRF_REG_RX_ADDR_P3]	= "RX_ADDR_P3",
+	[NRF_REG_RX_ADDR_P4]	= "RX_ADDR_P4",
+	[NRF_REG_RX_ADDR_P5]	= "RX_ADDR_P5",
+	[NRF_REG_TX_ADDR]	= "TX_ADDR",
+	[NRF_REG_RX_PW_P0]	= "RX_PW_P0",
+	[NRF_REG_RX_PW_P1]	= "RX_PW_P1",
+	[NRF_REG_RX_PW_P2]	= "RX_PW_P2",
+	[NRF_REG_RX_PW_P3]	= "RX_PW_P3",
+	[NRF_REG_RX_PW_P4]	= "RX_PW_P4",
+	[NRF_REG_RX_PW_P5]	= "RX_PW_P5",
+	[NRF_REG_FIFO_STATUS]	= "FIFO_STATUS",
+	[NRF_REG_DYNPD]		= "DYNPD",
+	[NRF_REG_FEATURE]	= "FEATURE",
+};
+
+static uint8_t *load_trace(const char *path, size_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *data = NULL;
+	size_t capacity = 0;
+
+	*size = 0;
+
+	if (NULL == file) {
+		perror(path);
+		return NULL;
+	}
+
+	for (;;) {
+		if (*size == capacity) {
+			capacity = (0 == capacity) ? 4096 : (2 * capacity);
+			data = realloc(data, capacity);
+
+			if (NULL == data) {
+				fclose(file);
+				return NULL;
+			}
+		}
+
+		const size_t got = fread(&data[*size], 1, capacity - *size, file);
+
+		if (0 == got) {
+			break;
+		}
+
+		*size += got;
+	}
+
+	fclose(file);
+	return data;
+}
+
+static void command_name(const uint8_t cmd, char *name, const size_t name_size)
+{
+	const uint8_t reg = cmd & TRACE_CMD_REG_ADDR_MASK;
+	const char *reg_name = (reg < NRF_ARRAY_SIZE(register_names)) ? register_names[reg] : NULL;
+
+	if (NRF_CMD_W_ACK_PAYLOAD == (cmd & ~TRACE_CMD_PIPE_MASK)) {
+		snprintf(name, name_size, "W_ACK_PAYLOAD P%u", cmd & TRACE_CMD_PIPE_MASK);
+		return;
+	}
+
+	switch (cmd & TRACE_CMD_REGISTER_MASK) {
+	case NRF_CMD_R_REGISTER:
+	case NRF_CMD_W_REGISTER:
+		snprintf(name, name_size, "%s %s",
+			(NRF_CMD_W_REGISTER & cmd) ? "W_REGISTER" : "R_REGISTER",
+			(NULL != reg_name) ? reg_name : "?");
+		return;
+	default:
+		break;
+	}
+
+	switch (cmd) {
+	case NRF_CMD_R_RX_PAYLOAD:
+		snprintf(name, name_size, "R_RX_PAYLOAD");
+		break;
+	case NRF_CMD_W_TX_PAYLOAD:
+		snprintf(name, name_size, "W_TX_PAYLOAD");
+		break;
+	case NRF_CMD_FLUSH_TX:
+		snprintf(name, name_size, "FLUSH_TX");
+		break;
+	case NRF_CMD_FLUSH_RX:
+		snprintf(name, name_size, "FLUSH_RX");
+		break;
+	case NRF_CMD_REUSE_TX_PL:
+		snprintf(name, name_size, "REUSE_TX_PL");
+		break;
+	case NRF_CMD_R_RX_PL_WID:
+		snprintf(name, name_size, "R_RX_PL_WID");
+		break;
+	case NRF_CMD_W_TX_PAYLOAD_NO_ACK:
+		snprintf(name, name_size, "W_TX_PAYLOAD_NO_ACK");
+		break;
+	case NRF_CMD_NOP:
+		snprintf(name, name_size, "NOP");
+		break;
+	default:
+		snprintf(name, name_size, "0x%02X", cmd);
+		break;
+	}
+}
+
+/* The bytes clocked out after the STATUS carry data */
+static int command_reads(const uint8_t cmd)
+{
+	return (NRF_CMD_R_REGISTER == (cmd & TRACE_CMD_REGISTER_MASK)) ||
+		(NRF_CMD_R_RX_PAYLOAD == cmd) || (NRF_CMD_R_RX_PL_WID == cmd);
+}
+
+static void print_bytes(const char *label, const uint8_t *bytes, const size_t size)
+{
+	printf(" %s", label);
+
+	for (size_t idx = 0; idx < size; idx++) {
+		printf(" %02X", bytes[idx]);
+	}
+}
+
+static void print_record(const nrf_trace_record *record)
+{
+	char name[32];
+
+	printf("%10lu us  ", (unsigned long) record->timestamp);
+
+	switch (record->type) {
+	case NRF_TRACE_SPI:
+		command_name(record->mosi[0], name, sizeof name);
+		printf("SPI   %-24s status %02X", name, record->miso[0]);
+
+		if (1 < record->value) {
+			print_bytes(command_reads(record->mosi[0]) ? "read" : "write",
+				command_reads(record->mosi[0]) ? &record->miso[1] : &record->mosi[1],
+				record->value - 1);
+		}
+
+		printf("\n");
+		break;
+	case NRF_TRACE_CE:
+		printf("CE    %lu\n", (unsigned long) record->value);
+		break;
+	case NRF_TRACE_DELAY_US:
+		printf("DELAY %lu us\n", (unsigned long) record->value);
+		break;
+	case NRF_TRACE_LOST:
+		printf("LOST  %lu records\n", (unsigned long) record->value);
+		break;
+	}
+}
+
+static void account(trace_summary *summary, const nrf_trace_record *record, uint8_t *ce)
+{
+	if (0 == summary->records) {
+		summary->first_timestamp = record->timestamp;
+	}
+
+	summary->records++;
+	summary->last_timestamp = record->timestamp;
+
+	switch (record->type) {
+	case NRF_TRACE_SPI:
+		summary->transactions++;
+		summary->bytes += record->value;
+		summary->tx_payloads += (NRF_CMD_W_TX_PAYLOAD == record->mosi[0]) ||
+			(NRF_CMD_W_TX_PAYLOAD_NO_ACK == record->mosi[0]);
+		summary->rx_payloads += (NRF_CMD_R_RX_PAYLOAD == record->mosi[0]);
+		break;
+	case NRF_TRACE_CE:
+		summary->ce_edges += (record->value != *ce);
+		*ce = (uint8_t) record->value;
+		break;
+	case NRF_TRACE_DELAY_US:
+		summary->delay_us += record->value;
+		break;
+	case NRF_TRACE_LOST:
+		summary->lost += record->value;
+		break;
+	}
+}
+
+static void print_summary(const trace_summary *summary)
+{
+	const unsigned long traced_us = (unsigned long) (uint32_t)
+		(summary->last_timestamp - summary->first_timestamp);
+
+	printf("records %lu (lost %lu)\n", summary->records, summary->lost);
+	printf("spi %lu transactions %lu bytes, ce %lu edges, delays %lu us\n",
+		summary->transactions, summary->bytes, summary->ce_edges, summary->delay_us);
+	printf("payloads written %lu read %lu\n", summary->tx_payloads, summary->rx_payloads);
+
+	if (0 != traced_us) {
+		printf("traced %lu us, %.1f bytes/s, %.1f payloads/s\n", traced_us,
+			1e6 * (double) summary->bytes / (double) traced_us,
+			1e6 * (double) (summary->tx_payloads + summary->rx_payloads) / (double) traced_us);
+	}
+}
+
+static int decode(const uint8_t *data, const size_t size)
+{
+	trace_summary summary;
+	nrf_trace_record record;
+	uint8_t ce = GPIO_CLEAR;
+	size_t pos = 0;
+	size_t used;
+
+	memset(&summary, 0, sizeof summary);
+
+	while (0 != (used = NRF24_trace_decode(&data[pos], size - pos, &record))) {
+		print_record(&record);
+		account(&summary, &record, &ce);
+		pos += used;
+	}
+
+	print_summary(&summary);
+
+	if (pos != size) {
+		fprintf(stderr, "invalid record at offset %lu\n", (unsigned long) pos);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static int replay(const uint8_t *data, const size_t size)
+{
+	static nrf_emu emu;
+	trace_summary summary;
+	nrf_trace_record record;
+	uint8_t ce = GPIO_CLEAR;
+	/* Recorded time, from the timestamps, in the emulator time scale */
+	uint64_t traced_ns = 0;
+	size_t pos = 0;
+	size_t used;
+
+	memset(&summary, 0, sizeof summary);
+	nrf_emu_init(&emu);
+	nrf_emu_select(&emu);
+
+	while (0 != (used = NRF24_trace_decode(&data[pos], size - pos, &record))) {
+		if (0 != summary.records) {
+			traced_ns += (uint64_t) (uint32_t) (record.timestamp - summary.last_timestamp) * 1000U;
+		}
+
+		/* The driver was busy elsewhere, let the radio run meanwhile */
+		if (traced_ns > emu.now_ns) {
+			nrf_emu_advance(&emu, (uint32_t) ((traced_ns - emu.now_ns) / 1000U));
+		}
+
+		account(&summary, &record, &ce);
+		pos += used;
+
+		switch (record.type) {
+		case NRF_TRACE_SPI: {
+			uint8_t miso[NRF_PAYLOAD_SIZE_MAX + 1];
+			const size_t compared = command_reads(record.mosi[0]) ? record.value : 1;
+
+			nrf_emu_xfer(&emu, record.mosi, miso, record.value);
+
+			if (0 != memcmp(miso, record.miso, compared)) {
+				if (TRACE_MISMATCH_PRINT > summary.mismatches) {
+					print_record(&record);
+					print_bytes("  emulator", miso, compared);
+					printf("\n");
+				}
+
+				summary.mismatches++;
+			}
+			break;
+		}
+		case NRF_TRACE_CE:
+			nrf_emu_write_ce((nrf_gpio) record.value);
+			break;
+		case NRF_TRACE_DELAY_US:
+			nrf_emu_delay_us(record.value);
+			break;
+		case NRF_TRACE_LOST:
+			printf("%lu records lost, the replay diverges\n", (unsigned long) record.value);
+			break;
+		}
+	}
+
+	print_summary(&summary);
+	printf("replayed %lu us, radio sent %lu acked %lu received %lu, %lu mismatches\n",
+		(unsigned long) (emu.now_ns / 1000U), emu.counters.packets_sent,
+		emu.counters.packets_acked, emu.counters.packets_received, summary.mismatches);
+
+	if (0 != emu.now_ns) {
+		printf("replay throughput %.1f packets/s\n",
+			1e9 * (double) emu.counters.packets_acked / (double) emu.now_ns);
+	}
+
+	if (pos != size) {
+		fprintf(stderr, "invalid record at offset %lu\n", (unsigned long) pos);
+		return EXIT_FAILURE;
+	}
+
+	return (0 == summary.mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t size = 0;
+	uint8_t *data;
+	int result;
+
+	if ((3 != argc) || ((0 != strcmp("decode", argv[1])) && (0 != strcmp("replay", argv[1])))) {
+		fprintf(stderr, "usage: %s decode|replay TRACE\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	data = load_trace(argv[2], &size);
+
+	if (NULL == data) {
+		return EXIT_FAILURE;
+	}
+
+	result = (0 == strcmp("decode", argv[1])) ? decode(data, size) : replay(data, size);
+	free(data);
+
+	return result;
+}
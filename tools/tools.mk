@@ -0,0 +1,23 @@
+# Host tools, they don't need CppUTest.
+#
+#   make trace_tool
+#   tools/build/nrf24_trace decode trace.bin
+#   tools/build/nrf24_trace replay trace.bin
+
+TOOLS_CC ?= $(CC)
+TOOLS_CFLAGS ?= -std=gnu99 -O2 -Wall -Wextra
+TOOLS_BUILD_DIR ?= tools/build
+
+TRACE_TOOL_SRC = src/NRF24_TRACE.c tests/emulator/nrf24_emu.c tools/nrf24_trace.c
+TRACE_TOOL_BIN = $(TOOLS_BUILD_DIR)/nrf24_trace
+
+.PHONY: trace_tool tools_clean
+
+trace_tool: $(TRACE_TOOL_BIN)
+
+$(TRACE_TOOL_BIN): $(TRACE_TOOL_SRC) $(wildcard inc/*.h) tests/emulator/nrf24_emu.h
+	@mkdir -p $(TOOLS_BUILD_DIR)
+	$(TOOLS_CC) $(TOOLS_CFLAGS) -Iinc -Itests/emulator $(TRACE_TOOL_SRC) -o $@
+
+tools_clean:
+	rm -rf $(TOOLS_BUILD_DIR)